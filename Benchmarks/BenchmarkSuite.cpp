@@ -0,0 +1,121 @@
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        std::string escapeJson(const std::string& text)
+        {
+            std::string escaped;
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                    escaped += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20)
+                    escaped += c;
+            }
+            return escaped;
+        }
+    }
+
+    void BenchmarkSuite::add(std::string name, std::string description, const uint32_t runCount, Setup setup)
+    {
+        mScenarios.push_back({std::move(name), std::move(description), std::max(runCount, 1u), std::move(setup)});
+    }
+
+    std::vector<std::string> BenchmarkSuite::getNames() const
+    {
+        std::vector<std::string> names;
+        for (const Scenario& scenario : mScenarios)
+            names.push_back(scenario.name);
+        return names;
+    }
+
+    std::vector<BenchmarkSuite::Result> BenchmarkSuite::run(const Options& options) const
+    {
+        std::vector<Result> results;
+
+        for (const Scenario& scenario : mScenarios)
+        {
+            if (!options.filter.empty() && scenario.name.find(options.filter) == std::string::npos)
+                continue;
+
+            const Step step = scenario.setup();
+
+            for (uint32_t i = 0; i < options.warmupRuns; i++)
+                step(i % scenario.runCount);
+
+            std::vector<double> seconds(scenario.runCount);
+            for (uint32_t i = 0; i < scenario.runCount; i++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                step(i);
+                seconds[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            std::sort(seconds.begin(), seconds.end());
+
+            Result result;
+            result.name = scenario.name;
+            result.description = scenario.description;
+            result.runCount = scenario.runCount;
+            result.minSeconds = seconds.front();
+            result.medianSeconds = getPercentile(seconds, 0.5);
+            result.p99Seconds = getPercentile(seconds, 0.99);
+            result.maxSeconds = seconds.back();
+            for (const double s : seconds)
+                result.meanSeconds += s;
+            result.meanSeconds /= seconds.size();
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(3) << " min " << std::setw(10)
+                      << result.minSeconds * 1000.0 << " ms, median " << std::setw(10) << result.medianSeconds * 1000.0 << " ms, p99 " << std::setw(10)
+                      << result.p99Seconds * 1000.0 << " ms (" << result.runCount << " runs)" << std::endl;
+        }
+
+        return results;
+    }
+
+    double BenchmarkSuite::getPercentile(const std::vector<double>& sortedSeconds, const double p)
+    {
+        if (sortedSeconds.empty())
+            return 0.0;
+
+        // the median of an even count is the mean of the two middle samples, anything else is the nearest rank
+        if (p == 0.5 && sortedSeconds.size() % 2 == 0)
+            return 0.5 * (sortedSeconds[sortedSeconds.size() / 2 - 1] + sortedSeconds[sortedSeconds.size() / 2]);
+
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sortedSeconds.size())));
+        return sortedSeconds[std::clamp<size_t>(rank, 1, sortedSeconds.size()) - 1];
+    }
+
+    void BenchmarkSuite::writeJson(const std::filesystem::path& path, const Options& options, const std::vector<Result>& results)
+    {
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("can't write " + path.string());
+
+        file << std::setprecision(9);
+        file << "{\n  \"label\": \"" << escapeJson(options.label) << "\",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+             << ",\n  \"warmup_runs\": " << options.warmupRuns << ",\n  \"scenarios\": [";
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            file << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << escapeJson(result.name) << "\", \"description\": \"" << escapeJson(result.description)
+                 << "\", \"runs\": " << result.runCount << ", \"min_ms\": " << result.minSeconds * 1000.0 << ", \"median_ms\": " << result.medianSeconds * 1000.0
+                 << ", \"p99_ms\": " << result.p99Seconds * 1000.0 << ", \"mean_ms\": " << result.meanSeconds * 1000.0 << ", \"max_ms\": " << result.maxSeconds * 1000.0
+                 << "}";
+        }
+        file << "\n  ]\n}\n";
+    }
+}
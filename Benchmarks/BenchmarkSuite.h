@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * named, repeatable measurements of the cpu side of the samples, without a window or a gpu.
+     * a scenario prepares everything it needs (meshes, files, views) outside of the measurement and returns the step that
+     * is timed. every step gets the index of its run, so a scenario can walk a fixed camera path or a list of views and
+     * every run of every commit does exactly the same work. inputs come from fixed seeds, never from std::random_device.
+     * the results (min, median, p99 of the steps) are written as json, so they can be compared across commits.
+     */
+    class BenchmarkSuite
+    {
+    public:
+        // one timed step, run is in [0, runCount)
+        using Step = std::function<void(uint32_t run)>;
+        using Setup = std::function<Step()>;
+
+        struct Options
+        {
+            std::string filter;         // only scenarios whose name contains this, all of them if empty
+            uint32_t warmupRuns = 2;    // steps run before the measured ones, with run indices from 0, not measured
+            std::string label;          // written into the json as it is, e.g. a commit hash
+        };
+
+        struct Result
+        {
+            std::string name;
+            std::string description;
+            uint32_t runCount = 0;
+            double minSeconds = 0.0;
+            double medianSeconds = 0.0;
+            double p99Seconds = 0.0;
+            double meanSeconds = 0.0;
+            double maxSeconds = 0.0;
+        };
+
+        // name is "app/scenario", setup is only called if the scenario is run
+        void add(std::string name, std::string description, uint32_t runCount, Setup setup);
+
+        std::vector<std::string> getNames() const;
+
+        // runs every scenario that matches the filter, in the order they were added, and prints a line for each
+        std::vector<Result> run(const Options& options) const;
+
+        // throws std::runtime_error if the file can't be written
+        static void writeJson(const std::filesystem::path& path, const Options& options, const std::vector<Result>& results);
+
+        // nearest rank percentile of sorted samples, p in [0, 1]
+        static double getPercentile(const std::vector<double>& sortedSeconds, double p);
+
+    private:
+        struct Scenario
+        {
+            std::string name;
+            std::string description;
+            uint32_t runCount = 0;
+            Setup setup;
+        };
+
+        std::vector<Scenario> mScenarios;
+    };
+
+    // the scenarios of each sample
+    void addMandelbrotBenchmarks(BenchmarkSuite& suite);
+    void addModelLoaderBenchmarks(BenchmarkSuite& suite);
+    void addParametricSurfacesBenchmarks(BenchmarkSuite& suite);
+    void addMirrorRendererBenchmarks(BenchmarkSuite& suite);
+}
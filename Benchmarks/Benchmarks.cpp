@@ -0,0 +1,66 @@
+#include "BenchmarkSuite.h"
+
+#include <iostream>
+#include <stdexcept>
+
+// runs the cpu side of the samples headless, e.g. Benchmarks --out results.json --label $(git rev-parse --short HEAD)
+int main(int argc, char** argv)
+{
+    using Falcor::Tutorial::BenchmarkSuite;
+
+    BenchmarkSuite suite;
+    Falcor::Tutorial::addMandelbrotBenchmarks(suite);
+    Falcor::Tutorial::addModelLoaderBenchmarks(suite);
+    Falcor::Tutorial::addParametricSurfacesBenchmarks(suite);
+    Falcor::Tutorial::addMirrorRendererBenchmarks(suite);
+
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    BenchmarkSuite::Options options;
+    std::filesystem::path outputPath = "benchmarks.json";
+
+    try
+    {
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            const auto next = [&]() -> const std::string&
+            {
+                if (++i >= args.size())
+                    throw std::invalid_argument("missing value after " + args[i - 1]);
+                return args[i];
+            };
+
+            if (args[i] == "--out")
+                outputPath = next();
+            else if (args[i] == "--filter")
+                options.filter = next();
+            else if (args[i] == "--warmup")
+                options.warmupRuns = static_cast<uint32_t>(std::stoul(next()));
+            else if (args[i] == "--label")
+                options.label = next();
+            else if (args[i] == "--list")
+            {
+                for (const std::string& name : suite.getNames())
+                    std::cout << name << std::endl;
+                return 0;
+            }
+            else
+                throw std::invalid_argument("unknown argument " + args[i]);
+        }
+
+        const std::vector<BenchmarkSuite::Result> results = suite.run(options);
+        if (results.empty())
+        {
+            std::cerr << "no scenario matches " << options.filter << std::endl;
+            return 1;
+        }
+
+        BenchmarkSuite::writeJson(outputPath, options, results);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
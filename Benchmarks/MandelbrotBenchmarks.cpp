@@ -0,0 +1,137 @@
+#include "BenchmarkSuite.h"
+
+#include "MandelbrotColorizer.h"
+#include "MandelbrotCpuEngine.h"
+#include "MandelbrotDeepZoom.h"
+
+#include <cmath>
+#include <memory>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // seahorse valley, deep enough for the deep zoom path
+        const char* kCenterX = "-0.743643887037158704752191506114774";
+        const char* kCenterY = "0.131825904205311970493132056385139";
+
+        constexpr uint32_t kWidth = 640;
+        constexpr uint32_t kHeight = 360;
+
+        // the float path zooms from the whole set to 10^4, about as far as floats resolve a 640 pixel wide view
+        constexpr uint32_t kZoomPathFrames = 48;
+        constexpr double kZoomPathMaxExponent = 4.0;
+        constexpr int kZoomPathIterations = 1024;
+
+        // the deep zoom path goes from 10^4 to 10^24, the center above has digits for 10^30 and the budget still
+        // lets most pixels escape there, deeper views would be all black and only measure the series
+        constexpr uint32_t kDeepZoomWidth = 320;
+        constexpr uint32_t kDeepZoomHeight = 180;
+        constexpr uint32_t kDeepZoomFrames = 6;
+        constexpr int kDeepZoomIterations = 16384;
+
+        // the coloring of a 4k frame of the zoom path, the counts are computed once
+        constexpr uint32_t kColoringWidth = 3840;
+        constexpr uint32_t kColoringHeight = 2160;
+        constexpr uint32_t kColoringFrame = 32;
+        constexpr uint32_t kColoringRuns = 16;
+
+        MandelbrotCpuEngine::View getZoomPathView(const uint32_t frame)
+        {
+            MandelbrotCpuEngine::View view;
+            view.width = kWidth;
+            view.height = kHeight;
+            view.iterations = kZoomPathIterations;
+
+            // the shader's offset puts the view's corner at -2.5 - i, so the center is offset - 2.5 + 1.75 / zoom
+            const double zoom = std::pow(10.0, kZoomPathMaxExponent * frame / (kZoomPathFrames - 1));
+            view.zoom = static_cast<float>(zoom);
+            view.positionOffset = {
+                static_cast<float>(std::stod(kCenterX) + 2.5 - 1.75 / zoom),
+                static_cast<float>(std::stod(kCenterY) + 1.0 - 1.0 / zoom)
+            };
+            return view;
+        }
+
+        void addZoomPath(BenchmarkSuite& suite, const std::string& name, const std::string& description, const MandelbrotCpuEngine::InstructionSet instructionSet,
+                         const bool useInteriorChecks, const bool useRectangleSubdivision)
+        {
+            suite.add(
+                name, description, kZoomPathFrames,
+                [=]() -> BenchmarkSuite::Step
+                {
+                    auto pEngine = std::make_shared<MandelbrotCpuEngine>(instructionSet);
+                    auto pIterations = std::make_shared<std::vector<uint32_t>>();
+
+                    return [=](const uint32_t run)
+                    {
+                        MandelbrotCpuEngine::View view = getZoomPathView(run);
+                        view.useInteriorChecks = useInteriorChecks;
+                        view.useRectangleSubdivision = useRectangleSubdivision;
+                        pEngine->computeIterations(view, *pIterations);
+                    };
+                }
+            );
+        }
+
+        void addColoring(BenchmarkSuite& suite, const std::string& name, const std::string& description, const bool useHistogramEqualization)
+        {
+            suite.add(
+                name, description, kColoringRuns,
+                [=]() -> BenchmarkSuite::Step
+                {
+                    MandelbrotCpuEngine::View view = getZoomPathView(kColoringFrame);
+                    view.width = kColoringWidth;
+                    view.height = kColoringHeight;
+
+                    auto pIterations = std::make_shared<std::vector<uint32_t>>();
+                    auto pMagnitudes = std::make_shared<std::vector<float>>();
+                    MandelbrotCpuEngine().computeIterations(view, *pIterations, pMagnitudes.get());
+
+                    auto pColorizer = std::make_shared<MandelbrotColorizer>();
+                    auto pPalette = std::make_shared<MandelbrotPalette>();
+                    pPalette->useHistogramEqualization = useHistogramEqualization;
+                    auto pRgba = std::make_shared<std::vector<uint8_t>>();
+
+                    return [=](uint32_t) { pColorizer->colorize(*pPalette, *pIterations, *pMagnitudes, view.iterations, *pRgba); };
+                }
+            );
+        }
+    }
+
+    void addMandelbrotBenchmarks(BenchmarkSuite& suite)
+    {
+        const MandelbrotCpuEngine::InstructionSet best = MandelbrotCpuEngine::getBestInstructionSet();
+
+        addZoomPath(suite, "mandelbrot/zoom_path", "640x360 frames zooming into seahorse valley, best instruction set", best, true, false);
+        addZoomPath(suite, "mandelbrot/zoom_path_scalar", "the zoom path with the scalar loop", MandelbrotCpuEngine::InstructionSet::Scalar, true, false);
+        addZoomPath(suite, "mandelbrot/zoom_path_no_interior_checks", "the zoom path without skipping the cardioid, bulb and cycles", best, false, false);
+        addZoomPath(suite, "mandelbrot/zoom_path_subdivided", "the zoom path with rectangle subdivision and no interior checks", best, false, true);
+
+        addColoring(suite, "mandelbrot/coloring_4k", "smooth palette lookup of a 3840x2160 frame of the zoom path", false);
+        addColoring(suite, "mandelbrot/coloring_4k_equalized", "the 4k coloring with the histogram pass and the mapping through the distribution", true);
+
+        suite.add(
+            "mandelbrot/deep_zoom_path", "320x180 perturbation frames from 10^4 to 10^24 into seahorse valley", kDeepZoomFrames,
+            []() -> BenchmarkSuite::Step
+            {
+                auto pDeepZoom = std::make_shared<MandelbrotDeepZoom>();
+                auto pIterations = std::make_shared<std::vector<uint32_t>>();
+
+                return [=](const uint32_t run)
+                {
+                    MandelbrotDeepZoom::View view;
+                    view.width = kDeepZoomWidth;
+                    view.height = kDeepZoomHeight;
+                    view.iterations = kDeepZoomIterations;
+                    view.zoom = std::pow(10.0, 4.0 * (run + 1));
+
+                    const uint32_t fractionLimbCount = MandelbrotDeepZoom::getFractionLimbCount(view);
+                    view.centerX = FixedPoint::fromString(kCenterX, fractionLimbCount);
+                    view.centerY = FixedPoint::fromString(kCenterY, fractionLimbCount);
+                    pDeepZoom->computeIterations(view, *pIterations);
+                };
+            }
+        );
+    }
+}
@@ -0,0 +1,97 @@
+#include "BenchmarkSuite.h"
+
+#include "Mirror.h"
+#include "MirrorScene.h"
+
+#include <cmath>
+#include <memory>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // the observer walks a circle around the mirror and bobs up and down.
+        // a single frame is a few microseconds of matrix math, too little to time on its own, so every step walks the whole lap
+        constexpr uint32_t kPathFrames = 240;
+        constexpr uint32_t kPathRuns = 20;
+
+        float3 getObserverPosition(const uint32_t frame)
+        {
+            const float angle = 2.f * static_cast<float>(M_PI) * frame / kPathFrames;
+            return {15.f * std::sin(angle), 2.f * std::sin(3.f * angle), -15.f * std::cos(angle)};
+        }
+
+        // what MirrorRenderer::onFrameRender computes on the cpu, the draws aside
+        struct FrameState
+        {
+            Camera::SharedPtr pObserverCamera;
+            Camera::SharedPtr pMirrorCamera;
+            float3 mirrorNormal;
+            std::vector<Transform> transforms;  // the mirror, the floor, the shapes and the observer, like MirrorRenderer::mObjects
+
+            // keeps the results alive, so none of the work is optimized away
+            std::vector<rmcv::mat4> constants;
+        };
+    }
+
+    void addMirrorRendererBenchmarks(BenchmarkSuite& suite)
+    {
+        suite.add(
+            "mirrorrenderer/camera_path", "per frame cameras, reflection and object constants for both passes, 240 frames along a circle around the mirror", kPathRuns,
+            []() -> BenchmarkSuite::Step
+            {
+                auto pState = std::make_shared<FrameState>();
+
+                pState->pObserverCamera = Camera::create();
+                pState->pObserverCamera->setDepthRange(0.5f, 100);
+                pState->pObserverCamera->setFocalLength(30.f);
+                pState->pObserverCamera->setAspectRatio(1280.f / 720.f);
+
+                const Transform mirrorTransform = MirrorScene::getMirrorTransform();
+                pState->pMirrorCamera = Camera::create("mirror camera");
+                pState->pMirrorCamera->setDepthRange(.1f, 200.f);
+                pState->pMirrorCamera->setFocalLength(44.f);
+                pState->pMirrorCamera->setUpVector({0, 1, 0});
+                pState->pMirrorCamera->setPosition(mirrorTransform.getTranslation());
+                pState->mirrorNormal = RenderToTextureMirror::getSurfaceNormal(mirrorTransform);
+
+                pState->transforms.push_back(mirrorTransform);
+                pState->transforms.push_back(MirrorScene::getFloorTransform());
+                for (uint32_t i = 0; i < MirrorScene::kShapeCount; i++)
+                    pState->transforms.push_back(MirrorScene::getShapeTransform(i));
+                pState->transforms.push_back(MirrorScene::getObserverTransform());
+
+                return [pState](uint32_t)
+                {
+                    for (uint32_t frame = 0; frame < kPathFrames; frame++)
+                    {
+                        const float3 observerPosition = getObserverPosition(frame);
+                        pState->pObserverCamera->setPosition(observerPosition);
+                        pState->pObserverCamera->setTarget(float3(0, 0, 0));
+                        pState->transforms.back().setTranslation(observerPosition);
+
+                        pState->pMirrorCamera->setTarget(
+                            RenderToTextureMirror::getReflectionVector(pState->pMirrorCamera->getPosition(), observerPosition, pState->mirrorNormal)
+                        );
+
+                        // the mirror pass sees the observer, the main pass leaves it out
+                        pState->constants.clear();
+                        for (const bool isMirrorPass : {true, false})
+                        {
+                            const Camera::SharedPtr& pCamera = isMirrorPass ? pState->pMirrorCamera : pState->pObserverCamera;
+                            const size_t objectCount = pState->transforms.size() - (isMirrorPass ? 0 : 1);
+
+                            pState->constants.push_back(pCamera->getViewProjMatrix());
+                            for (size_t i = 0; i < objectCount; i++)
+                            {
+                                const rmcv::mat4 model = pState->transforms[i].getMatrix();
+                                pState->constants.push_back(model);
+                                pState->constants.push_back(transpose(inverse(model)));
+                            }
+                        }
+                    }
+                };
+            }
+        );
+    }
+}
@@ -0,0 +1,206 @@
+#include "BenchmarkSuite.h"
+
+#include "MeshLoader.h"
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexPacker.h"
+
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // the fixed mesh set: a torus with a bumpy surface, small enough to be a typical model and large enough to load slowly
+        struct MeshDesc
+        {
+            const char* name;
+            uint32_t segmentsU;     // around the ring
+            uint32_t segmentsV;     // around the tube
+        };
+
+        constexpr MeshDesc kMeshes[] = {{"torus_16k", 128, 64}, {"torus_262k", 512, 256}};
+
+        constexpr uint32_t kSeed = 1;
+
+        // a grid of (segmentsU + 1) x (segmentsV + 1) vertices, the seams have two vertices with different uvs like the built-in shapes
+        TriangleMesh::SharedPtr createBumpyTorus(const MeshDesc& desc)
+        {
+            std::mt19937 generator(kSeed);
+            std::uniform_real_distribution<float> bump(-0.02f, 0.02f);
+            std::vector<float> bumps(size_t(desc.segmentsU) * desc.segmentsV);
+            for (float& b : bumps)
+                b = bump(generator);
+
+            const float ringRadius = 1.f;
+            const float tubeRadius = 0.35f;
+            const auto& mesh = TriangleMesh::create();
+
+            for (uint32_t i = 0; i <= desc.segmentsU; i++)
+            {
+                const float u = static_cast<float>(i) / desc.segmentsU;
+                const float phi = u * 2.f * static_cast<float>(M_PI);
+
+                for (uint32_t j = 0; j <= desc.segmentsV; j++)
+                {
+                    const float v = static_cast<float>(j) / desc.segmentsV;
+                    const float theta = v * 2.f * static_cast<float>(M_PI);
+
+                    const float3 normal{std::cos(phi) * std::cos(theta), std::sin(theta), std::sin(phi) * std::cos(theta)};
+                    const float3 ringPoint{std::cos(phi) * ringRadius, 0.f, std::sin(phi) * ringRadius};
+                    const float r = tubeRadius + bumps[size_t(i % desc.segmentsU) * desc.segmentsV + j % desc.segmentsV];
+                    mesh->addVertex(ringPoint + normal * r, normal, {u, v});
+                }
+            }
+
+            const uint32_t rowLength = desc.segmentsV + 1;
+            for (uint32_t i = 0; i < desc.segmentsU; i++)
+            {
+                for (uint32_t j = 0; j < desc.segmentsV; j++)
+                {
+                    const uint32_t a = i * rowLength + j;
+                    const uint32_t b = a + rowLength;
+                    mesh->addTriangle(a, a + 1, b + 1);
+                    mesh->addTriangle(a, b + 1, b);
+                }
+            }
+
+            return mesh;
+        }
+
+        // writes the mesh as an obj with separate position, uv and normal indices, like exporters do
+        std::filesystem::path writeObjFile(const TriangleMesh::SharedPtr& pMesh, const std::string& name)
+        {
+            const std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTutorialBenchmarks";
+            std::filesystem::create_directories(directory);
+            const std::filesystem::path path = directory / (name + ".obj");
+
+            std::ofstream file(path);
+            if (!file)
+                throw std::runtime_error("can't write " + path.string());
+
+            for (const auto& vertex : pMesh->getVertices())
+                file << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+            for (const auto& vertex : pMesh->getVertices())
+                file << "vt " << vertex.texCoord.x << ' ' << vertex.texCoord.y << '\n';
+            for (const auto& vertex : pMesh->getVertices())
+                file << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+
+            const auto& indices = pMesh->getIndices();
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                file << 'f';
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t index = indices[i + corner] + 1;
+                    file << ' ' << index << '/' << index << '/' << index;
+                }
+                file << '\n';
+            }
+
+            // a cache left by an earlier run would turn the first parse into a cache hit
+            std::filesystem::remove(MeshCache::getCachePath(path));
+            return path;
+        }
+
+        void addParse(BenchmarkSuite& suite, const MeshDesc& desc, const char* modeName, const MeshLoader::ParseMode mode)
+        {
+            suite.add(
+                std::string("modelloader/parse_") + modeName + "/" + desc.name, std::string("loading the obj file of ") + desc.name + ", " + modeName + " parser", 5,
+                [desc, mode]() -> BenchmarkSuite::Step
+                {
+                    const std::filesystem::path path = writeObjFile(createBumpyTorus(desc), desc.name);
+                    return [path, mode](uint32_t) { MeshLoader::loadMeshFromObjFile(path, mode); };
+                }
+            );
+        }
+    }
+
+    void addModelLoaderBenchmarks(BenchmarkSuite& suite)
+    {
+        const MeshDesc& largeMesh = kMeshes[std::size(kMeshes) - 1];
+        addParse(suite, largeMesh, "stream", MeshLoader::ParseMode::Stream);
+        addParse(suite, largeMesh, "mapped", MeshLoader::ParseMode::Mapped);
+        addParse(suite, largeMesh, "parallel", MeshLoader::ParseMode::Parallel);
+
+        suite.add(
+            std::string("modelloader/cache_hit/") + largeMesh.name, "mapping the up to date binary cache of the obj file", 20,
+            [desc = largeMesh]() -> BenchmarkSuite::Step
+            {
+                const std::filesystem::path path = writeObjFile(createBumpyTorus(desc), desc.name);
+                MeshLoader::loadMeshThroughCache(path, MeshLoader::ParseMode::Mapped);
+                return [path](uint32_t) { MeshLoader::loadMeshThroughCache(path, MeshLoader::ParseMode::Mapped); };
+            }
+        );
+
+        for (const MeshDesc& desc : kMeshes)
+        {
+            const std::string suffix = std::string("/") + desc.name;
+
+            suite.add(
+                "modelloader/optimize" + suffix, "vertex cache and vertex fetch optimization, including copying the mesh", 5,
+                [desc]() -> BenchmarkSuite::Step
+                {
+                    const TriangleMesh::SharedPtr pMesh = createBumpyTorus(desc);
+                    return [pMesh](uint32_t)
+                    {
+                        TriangleMesh::VertexList vertices = pMesh->getVertices();
+                        TriangleMesh::IndexList indices = pMesh->getIndices();
+                        MeshOptimizer::optimize(vertices, indices, MeshOptimizer::Options());
+                    };
+                }
+            );
+
+            suite.add(
+                "modelloader/meshlets" + suffix, "splitting the mesh into meshlets of at most 64 vertices and 124 triangles", 10,
+                [desc]() -> BenchmarkSuite::Step
+                {
+                    const TriangleMesh::SharedPtr pMesh = createBumpyTorus(desc);
+                    return [pMesh](uint32_t)
+                    {
+                        const auto& vertices = pMesh->getVertices();
+                        const auto& indices = pMesh->getIndices();
+                        MeshletBuilder::build(vertices.data(), vertices.size(), indices.data(), indices.size());
+                    };
+                }
+            );
+
+            suite.add(
+                "modelloader/simplify" + suffix, "building the default lod chain", 3,
+                [desc]() -> BenchmarkSuite::Step
+                {
+                    const TriangleMesh::SharedPtr pMesh = createBumpyTorus(desc);
+                    return [pMesh](uint32_t)
+                    {
+                        const auto& vertices = pMesh->getVertices();
+                        const auto& indices = pMesh->getIndices();
+                        MeshSimplifier::buildLodChain(vertices.data(), vertices.size(), indices.data(), indices.size(), MeshSimplifier::Options());
+                    };
+                }
+            );
+
+            suite.add(
+                "modelloader/pack" + suffix, "packing into unorm16 positions, octahedral normals and half uvs", 20,
+                [desc]() -> BenchmarkSuite::Step
+                {
+                    const TriangleMesh::SharedPtr pMesh = createBumpyTorus(desc);
+                    return [pMesh](uint32_t)
+                    {
+                        VertexPacker::Options options;
+                        options.positionFormat = VertexPacker::PositionFormat::Unorm16;
+                        options.normalFormat = VertexPacker::NormalFormat::Octahedral;
+                        options.texCoordFormat = VertexPacker::TexCoordFormat::Half;
+
+                        const auto& vertices = pMesh->getVertices();
+                        const auto& indices = pMesh->getIndices();
+                        VertexPacker::pack(vertices.data(), vertices.size(), indices.data(), indices.size(), options);
+                    };
+                }
+            );
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include "BenchmarkSuite.h"
+
+#include "CpuPerlinNoise.h"
+#include "SurfaceMeshes.h"
+#include "SurfaceTessellator.h"
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace Falcor::Tutorial
+{
+    void addParametricSurfacesBenchmarks(BenchmarkSuite& suite)
+    {
+        // the cpu half of ParametircSurfaceRenderer::executeStressTest, the noise is generated on the gpu
+        suite.add(
+            "parametricsurfaces/stress_test_planes", "tessellating 32 planes of 100x100 points and joining them into one vertex and index list", 10,
+            []() -> BenchmarkSuite::Step
+            {
+                return [](uint32_t)
+                {
+                    std::vector<TriangleMesh::SharedPtr> models;
+                    for (int i = 0; i < 32; i++)
+                        models.push_back(SurfaceMeshes::createPlane(100));
+
+                    std::vector<SurfaceMeshes::Vertex> vertices;
+                    TriangleMesh::IndexList indices;
+                    SurfaceMeshes::joinModels(models, vertices, indices);
+                };
+            }
+        );
+
+        suite.add(
+            "parametricsurfaces/plane_1024", "tessellating one plane of 1024x1024 points", 5,
+            []() -> BenchmarkSuite::Step { return [](uint32_t) { SurfaceMeshes::createPlane(1024); }; }
+        );
+
+        // the arrays are reused between runs, so this measures evaluating the function and not the allocation
+        const std::pair<const char*, const char*> surfaces[] = {{"torus", "torus"}, {"klein_bottle", "klein bottle"}, {"superquadric", "superquadric"}};
+        for (const auto& [id, name] : surfaces)
+        {
+            suite.add(
+                std::string("parametricsurfaces/") + id + "_2048", std::string("tessellating a ") + name + " at 2048x2048 points on every core", 5,
+                [name]() -> BenchmarkSuite::Step
+                {
+                    auto pTessellator = std::make_shared<SurfaceTessellator>();
+                    auto pTessellation = std::make_shared<SurfaceTessellator::Tessellation>();
+                    const SurfaceTessellator::Function function = pTessellator->findSurface(name)->function;
+
+                    return [=](uint32_t) { pTessellator->tessellate(function, 2048, 2048, *pTessellation); };
+                }
+            );
+        }
+
+        // the renderer's 6 octaves with a seed in its range, once per instruction set on one core and on every core
+        const std::pair<const char*, CpuPerlinNoise::InstructionSet> instructionSets[] = {
+            {"scalar", CpuPerlinNoise::InstructionSet::Scalar}, {"avx2", CpuPerlinNoise::InstructionSet::AVX2}
+        };
+        for (const auto& [id, instructionSet] : instructionSets)
+        {
+            if (!CpuPerlinNoise::isSupported(instructionSet))
+                continue;
+
+            for (const bool isSingleThreaded : {true, false})
+            {
+                suite.add(
+                    std::string("parametricsurfaces/noise_2048_") + id + (isSingleThreaded ? "_single_thread" : ""),
+                    std::string("generating the shader's fBm at 2048x2048 texels with ") + id + (isSingleThreaded ? " on one core" : " on every core"), 5,
+                    [instructionSet = instructionSet, isSingleThreaded]() -> BenchmarkSuite::Step
+                    {
+                        auto pNoise = std::make_shared<CpuPerlinNoise>(instructionSet, isSingleThreaded ? 1u : std::thread::hardware_concurrency());
+                        auto pHeights = std::make_shared<std::vector<float>>();
+                        CpuPerlinNoise::Settings settings;
+                        settings.resolution = 2048;
+                        settings.seed = 4321.5f;
+
+                        return [=](uint32_t) { pNoise->generate(settings, *pHeights); };
+                    }
+                );
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define CPU_FEATURES_X86 0
+#endif
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        struct Features
+        {
+            bool hasAVX2 = false;
+            bool hasAVX512F = false;
+        };
+
+#if CPU_FEATURES_X86
+        void cpuid(const int leaf, const int subleaf, int registers[4])
+        {
+#if defined(_MSC_VER)
+            __cpuidex(registers, leaf, subleaf);
+#else
+            __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+        }
+
+        // which register states the os saves on a context switch
+        uint64_t getEnabledStates()
+        {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t low = 0;
+            uint32_t high = 0;
+            __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+            return (uint64_t(high) << 32) | low;
+#endif
+        }
+#endif
+
+        Features detectFeatures()
+        {
+            Features features;
+
+#if CPU_FEATURES_X86
+            int registers[4] = {};
+            cpuid(0, 0, registers);
+            if (registers[0] < 7)
+                return features;
+
+            // xgetbv needs xsave, and without avx the os doesn't save any of the wider registers
+            cpuid(1, 0, registers);
+            const bool hasXSave = (registers[2] & (1 << 27)) != 0;
+            const bool hasAVX = (registers[2] & (1 << 28)) != 0;
+            if (!hasXSave || !hasAVX)
+                return features;
+
+            const uint64_t states = getEnabledStates();
+            const bool hasYmmStates = (states & 0x6) == 0x6;
+            const bool hasZmmStates = (states & 0xE6) == 0xE6;
+
+            cpuid(7, 0, registers);
+            features.hasAVX2 = hasYmmStates && (registers[1] & (1 << 5)) != 0;
+            features.hasAVX512F = hasZmmStates && (registers[1] & (1 << 16)) != 0;
+#endif
+
+            return features;
+        }
+
+        const Features& getFeatures()
+        {
+            static const Features features = detectFeatures();
+            return features;
+        }
+    }
+
+    bool CpuFeatures::hasAVX2()
+    {
+        return getFeatures().hasAVX2;
+    }
+
+    bool CpuFeatures::hasAVX512F()
+    {
+        return getFeatures().hasAVX512F;
+    }
+}
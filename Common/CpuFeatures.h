@@ -0,0 +1,18 @@
+#pragma once
+
+namespace Falcor::Tutorial
+{
+    /*
+     * the vector instruction sets the cpu engines pick their loops from at runtime.
+     * an instruction set only counts if the os saves its registers on a context switch too, not just if the cpu has it.
+     * always false on anything but x86.
+     */
+    class CpuFeatures
+    {
+    public:
+        CpuFeatures() = delete;
+
+        static bool hasAVX2();
+        static bool hasAVX512F();
+    };
+}
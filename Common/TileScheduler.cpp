@@ -0,0 +1,142 @@
+#include "TileScheduler.h"
+
+#include <algorithm>
+
+namespace Falcor::Tutorial
+{
+    TileScheduler::TileScheduler(const uint32_t threadCount)
+        : mThreadCount(std::max(threadCount, 1u)), mpRanges(std::make_unique<TileRange[]>(mThreadCount))
+    {
+        mWorkers.reserve(mThreadCount - 1);
+        for (uint32_t i = 1; i < mThreadCount; i++)
+            mWorkers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    TileScheduler::~TileScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mIsShuttingDown = true;
+        }
+        mStartCondition.notify_all();
+
+        for (auto& worker : mWorkers)
+            worker.join();
+    }
+
+    void TileScheduler::run(const uint32_t tileCount, const Task& task)
+    {
+        if (tileCount == 0)
+            return;
+
+        // neighbouring tiles cost about the same, so every thread starts with a contiguous block
+        for (uint32_t i = 0; i < mThreadCount; i++)
+        {
+            const uint32_t begin = static_cast<uint32_t>(uint64_t(tileCount) * i / mThreadCount);
+            const uint32_t end = static_cast<uint32_t>(uint64_t(tileCount) * (i + 1) / mThreadCount);
+            mpRanges[i].range.store(pack(begin, end), std::memory_order_relaxed);
+        }
+
+        mStealCount.store(0, std::memory_order_relaxed);
+        mpTask = &task;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mBusyWorkerCount = mThreadCount - 1;
+            mGeneration++;
+        }
+        mStartCondition.notify_all();
+
+        processTiles(0);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCondition.wait(lock, [this]() { return mBusyWorkerCount == 0; });
+        mpTask = nullptr;
+    }
+
+    void TileScheduler::workerLoop(const uint32_t threadIndex)
+    {
+        uint64_t seenGeneration = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mStartCondition.wait(lock, [&]() { return mIsShuttingDown || mGeneration != seenGeneration; });
+                if (mIsShuttingDown)
+                    return;
+
+                seenGeneration = mGeneration;
+            }
+
+            processTiles(threadIndex);
+
+            bool isLast = false;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                isLast = --mBusyWorkerCount == 0;
+            }
+            if (isLast)
+                mDoneCondition.notify_one();
+        }
+    }
+
+    void TileScheduler::processTiles(const uint32_t threadIndex)
+    {
+        // no task creates new tiles, so once nothing can be stolen anywhere this thread is done
+        uint32_t tile = 0;
+        while (popTile(threadIndex, tile) || stealTile(threadIndex, tile))
+            (*mpTask)(tile, threadIndex);
+    }
+
+    bool TileScheduler::popTile(const uint32_t threadIndex, uint32_t& tile)
+    {
+        std::atomic<uint64_t>& range = mpRanges[threadIndex].range;
+        uint64_t current = range.load(std::memory_order_acquire);
+
+        while (true)
+        {
+            const uint32_t begin = static_cast<uint32_t>(current);
+            const uint32_t end = static_cast<uint32_t>(current >> 32);
+            if (begin >= end)
+                return false;
+
+            if (range.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel))
+            {
+                tile = begin;
+                return true;
+            }
+        }
+    }
+
+    bool TileScheduler::stealTile(const uint32_t threadIndex, uint32_t& tile)
+    {
+        // victims are visited starting next to the thief, so the thieves don't all go for the same range
+        for (uint32_t offset = 1; offset < mThreadCount; offset++)
+        {
+            std::atomic<uint64_t>& victimRange = mpRanges[(threadIndex + offset) % mThreadCount].range;
+            uint64_t current = victimRange.load(std::memory_order_acquire);
+
+            while (true)
+            {
+                const uint32_t begin = static_cast<uint32_t>(current);
+                const uint32_t end = static_cast<uint32_t>(current >> 32);
+                if (begin >= end)
+                    break;
+
+                // the back half, rounded up, so a single remaining tile can be stolen too
+                const uint32_t stolenBegin = end - (end - begin + 1) / 2;
+                if (!victimRange.compare_exchange_weak(current, pack(begin, stolenBegin), std::memory_order_acq_rel))
+                    continue;
+
+                // the own range is empty, other thieves skip it, so a plain store is enough
+                tile = stolenBegin;
+                mpRanges[threadIndex].range.store(pack(stolenBegin + 1, end), std::memory_order_release);
+                mStealCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
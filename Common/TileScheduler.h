@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * persistent thread pool that runs a task for every tile of a frame, with work stealing.
+     * every thread starts with a contiguous range of tiles and takes them from the front. a thread that ran out
+     * steals the back half of another thread's range, so expensive regions (the inside of the set) are spread out
+     * as soon as they turn out to be expensive. a range is a single 64 bit word, taking and stealing are one
+     * compare-exchange each, and every range is on its own cache line, so there is no shared counter to fight over.
+     */
+    class TileScheduler
+    {
+    public:
+        using Task = std::function<void(uint32_t tile, uint32_t threadIndex)>;
+
+        // the calling thread of run() counts as one of the threads
+        explicit TileScheduler(uint32_t threadCount = std::thread::hardware_concurrency());
+        ~TileScheduler();
+
+        TileScheduler(const TileScheduler&) = delete;
+        TileScheduler& operator=(const TileScheduler&) = delete;
+
+        uint32_t getThreadCount() const { return mThreadCount; }
+
+        // calls task for every tile in [0, tileCount), returns once all of them are done. not reentrant
+        void run(uint32_t tileCount, const Task& task);
+
+        // number of successful steals during the last run
+        uint32_t getStealCount() const { return mStealCount.load(std::memory_order_relaxed); }
+
+    private:
+        // [begin, end) packed into one word, begin in the low half
+        struct alignas(64) TileRange
+        {
+            std::atomic<uint64_t> range{0};
+        };
+
+        static uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t(end) << 32) | begin; }
+
+        void workerLoop(uint32_t threadIndex);
+        void processTiles(uint32_t threadIndex);
+        bool popTile(uint32_t threadIndex, uint32_t& tile);
+        bool stealTile(uint32_t threadIndex, uint32_t& tile);
+
+        uint32_t mThreadCount;
+        std::unique_ptr<TileRange[]> mpRanges;
+        std::vector<std::thread> mWorkers;
+
+        const Task* mpTask = nullptr;
+        std::atomic<uint32_t> mStealCount{0};
+
+        std::mutex mMutex;
+        std::condition_variable mStartCondition;
+        std::condition_variable mDoneCondition;
+        uint64_t mGeneration = 0;
+        uint32_t mBusyWorkerCount = 0;
+        bool mIsShuttingDown = false;
+    };
+}
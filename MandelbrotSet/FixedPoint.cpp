@@ -0,0 +1,258 @@
+#include "FixedPoint.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // bits below the pixel spacing, the rounding errors of a long orbit pile up in them
+        constexpr double kGuardBits = 64.0;
+    }
+
+    FixedPoint::FixedPoint(const uint32_t fractionLimbCount) : mLimbs(fractionLimbCount + 1, 0)
+    {
+    }
+
+    FixedPoint FixedPoint::fromDouble(const double value, const uint32_t fractionLimbCount)
+    {
+        FixedPoint result(fractionLimbCount);
+        double magnitude = std::abs(value);
+        if (!(magnitude < 4294967296.0))
+            throw std::invalid_argument("value out of range for a fixed point number");
+
+        result.mIsNegative = value < 0.0;
+
+        // scaling by powers of two is exact, so every step only moves bits from the double into the limbs
+        result.mLimbs.back() = static_cast<uint32_t>(magnitude);
+        magnitude -= std::floor(magnitude);
+        for (uint32_t i = fractionLimbCount; i-- > 0 && magnitude > 0.0;)
+        {
+            magnitude *= 4294967296.0;
+            result.mLimbs[i] = static_cast<uint32_t>(magnitude);
+            magnitude -= std::floor(magnitude);
+        }
+
+        if (result.isZero())
+            result.mIsNegative = false;
+        return result;
+    }
+
+    FixedPoint FixedPoint::fromString(const std::string& text, const uint32_t fractionLimbCount)
+    {
+        size_t position = 0;
+        bool isNegative = false;
+        if (position < text.size() && (text[position] == '-' || text[position] == '+'))
+            isNegative = text[position++] == '-';
+
+        const size_t integerBegin = position;
+        while (position < text.size() && std::isdigit(static_cast<unsigned char>(text[position])))
+            position++;
+        const size_t integerEnd = position;
+
+        size_t fractionBegin = position;
+        size_t fractionEnd = position;
+        if (position < text.size() && text[position] == '.')
+        {
+            fractionBegin = ++position;
+            while (position < text.size() && std::isdigit(static_cast<unsigned char>(text[position])))
+                position++;
+            fractionEnd = position;
+        }
+
+        if (position != text.size() || (integerBegin == integerEnd && fractionBegin == fractionEnd))
+            throw std::invalid_argument("not a decimal number: " + text);
+
+        FixedPoint result(fractionLimbCount);
+
+        uint64_t integerPart = 0;
+        for (size_t i = integerBegin; i < integerEnd; i++)
+        {
+            integerPart = integerPart * 10 + static_cast<uint64_t>(text[i] - '0');
+            if (integerPart > 0xFFFFFFFFull)
+                throw std::invalid_argument("value out of range for a fixed point number: " + text);
+        }
+
+        // the digits are added from the last one, every step is fraction = (fraction + digit) / 10, a long division from the top
+        for (size_t i = fractionEnd; i-- > fractionBegin;)
+        {
+            uint64_t remainder = static_cast<uint64_t>(text[i] - '0');
+            for (uint32_t limb = fractionLimbCount; limb-- > 0;)
+            {
+                const uint64_t current = (remainder << 32) | result.mLimbs[limb];
+                result.mLimbs[limb] = static_cast<uint32_t>(current / 10);
+                remainder = current % 10;
+            }
+        }
+
+        result.mLimbs.back() = static_cast<uint32_t>(integerPart);
+        result.mIsNegative = isNegative && !result.isZero();
+        return result;
+    }
+
+    uint32_t FixedPoint::getFractionLimbCount(const double spacing)
+    {
+        const double bits = std::max(-std::log2(spacing), 0.0) + kGuardBits;
+        return static_cast<uint32_t>(std::ceil(bits / 32.0));
+    }
+
+    FixedPoint FixedPoint::withPrecision(const uint32_t fractionLimbCount) const
+    {
+        FixedPoint result(fractionLimbCount);
+        const uint32_t currentCount = getFractionLimbCount();
+        if (mLimbs.empty())
+            return result;
+
+        // aligned at the integer limb, missing low limbs are zero, extra ones are cut off
+        for (uint32_t i = 0; i <= std::min(currentCount, fractionLimbCount); i++)
+            result.mLimbs[fractionLimbCount - i] = mLimbs[currentCount - i];
+
+        result.mIsNegative = mIsNegative && !result.isZero();
+        return result;
+    }
+
+    double FixedPoint::toDouble() const
+    {
+        const int fractionLimbCount = static_cast<int>(getFractionLimbCount());
+        double result = 0.0;
+        for (size_t i = 0; i < mLimbs.size(); i++)
+            result += std::ldexp(static_cast<double>(mLimbs[i]), 32 * (static_cast<int>(i) - fractionLimbCount));
+        return mIsNegative ? -result : result;
+    }
+
+    std::string FixedPoint::toString(const uint32_t fractionDigitCount) const
+    {
+        std::string result = mIsNegative ? "-" : "";
+        result += std::to_string(mLimbs.empty() ? 0 : mLimbs.back());
+        if (fractionDigitCount == 0 || mLimbs.size() < 2)
+            return result;
+
+        // every multiplication by 10 carries the next digit into the integer part
+        std::vector<uint32_t> fraction(mLimbs.begin(), mLimbs.end() - 1);
+        result += '.';
+        for (uint32_t digit = 0; digit < fractionDigitCount; digit++)
+        {
+            uint64_t carry = 0;
+            for (uint32_t& limb : fraction)
+            {
+                const uint64_t current = uint64_t(limb) * 10 + carry;
+                limb = static_cast<uint32_t>(current);
+                carry = current >> 32;
+            }
+            result += static_cast<char>('0' + carry);
+        }
+        return result;
+    }
+
+    FixedPoint FixedPoint::operator+(const FixedPoint& other) const
+    {
+        return addSigned(*this, other, other.mIsNegative);
+    }
+
+    FixedPoint FixedPoint::operator-(const FixedPoint& other) const
+    {
+        return addSigned(*this, other, !other.mIsNegative && !other.isZero());
+    }
+
+    FixedPoint FixedPoint::operator*(const FixedPoint& other) const
+    {
+        const uint32_t fractionLimbCount = std::max(getFractionLimbCount(), other.getFractionLimbCount());
+        const FixedPoint a = withPrecision(fractionLimbCount);
+        const FixedPoint b = other.withPrecision(fractionLimbCount);
+        const size_t limbCount = a.mLimbs.size();
+
+        // schoolbook product, the result is the product shifted down by the fraction limbs, the bits above the integer limb are dropped
+        std::vector<uint32_t> product(2 * limbCount, 0);
+        for (size_t i = 0; i < limbCount; i++)
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < limbCount; j++)
+            {
+                const uint64_t current = uint64_t(a.mLimbs[i]) * b.mLimbs[j] + product[i + j] + carry;
+                product[i + j] = static_cast<uint32_t>(current);
+                carry = current >> 32;
+            }
+            product[i + limbCount] = static_cast<uint32_t>(carry);
+        }
+
+        FixedPoint result(fractionLimbCount);
+        std::copy(product.begin() + fractionLimbCount, product.begin() + fractionLimbCount + limbCount, result.mLimbs.begin());
+        result.mIsNegative = (a.mIsNegative != b.mIsNegative) && !result.isZero();
+        return result;
+    }
+
+    FixedPoint FixedPoint::operator-() const
+    {
+        FixedPoint result = *this;
+        result.mIsNegative = !mIsNegative && !isZero();
+        return result;
+    }
+
+    bool FixedPoint::operator==(const FixedPoint& other) const
+    {
+        const uint32_t fractionLimbCount = std::max(getFractionLimbCount(), other.getFractionLimbCount());
+        const FixedPoint a = withPrecision(fractionLimbCount);
+        const FixedPoint b = other.withPrecision(fractionLimbCount);
+        return a.mIsNegative == b.mIsNegative && a.mLimbs == b.mLimbs;
+    }
+
+    bool FixedPoint::isZero() const
+    {
+        return std::all_of(mLimbs.begin(), mLimbs.end(), [](const uint32_t limb) { return limb == 0; });
+    }
+
+    int FixedPoint::compareMagnitudes(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+    {
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    FixedPoint FixedPoint::addSigned(const FixedPoint& a, const FixedPoint& b, const bool isBNegative)
+    {
+        const uint32_t fractionLimbCount = std::max(a.getFractionLimbCount(), b.getFractionLimbCount());
+        const FixedPoint wideA = a.withPrecision(fractionLimbCount);
+        const FixedPoint wideB = b.withPrecision(fractionLimbCount);
+        FixedPoint result(fractionLimbCount);
+
+        if (wideA.mIsNegative == isBNegative)
+        {
+            uint64_t carry = 0;
+            for (size_t i = 0; i < result.mLimbs.size(); i++)
+            {
+                const uint64_t current = uint64_t(wideA.mLimbs[i]) + wideB.mLimbs[i] + carry;
+                result.mLimbs[i] = static_cast<uint32_t>(current);
+                carry = current >> 32;
+            }
+            result.mIsNegative = wideA.mIsNegative;
+        }
+        else
+        {
+            // the smaller magnitude is subtracted from the larger one, which gives the sign
+            const bool isAGreater = compareMagnitudes(wideA.mLimbs, wideB.mLimbs) >= 0;
+            const std::vector<uint32_t>& larger = isAGreater ? wideA.mLimbs : wideB.mLimbs;
+            const std::vector<uint32_t>& smaller = isAGreater ? wideB.mLimbs : wideA.mLimbs;
+
+            int64_t borrow = 0;
+            for (size_t i = 0; i < result.mLimbs.size(); i++)
+            {
+                int64_t current = int64_t(larger[i]) - int64_t(smaller[i]) - borrow;
+                borrow = current < 0 ? 1 : 0;
+                if (current < 0)
+                    current += int64_t(1) << 32;
+                result.mLimbs[i] = static_cast<uint32_t>(current);
+            }
+            result.mIsNegative = isAGreater ? wideA.mIsNegative : isBNegative;
+        }
+
+        if (result.isZero())
+            result.mIsNegative = false;
+        return result;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * signed fixed point number with a 32 bit integer part and any number of 32 bit fraction limbs.
+     * only meant for points of the complex plane near the Mandelbrot set and their orbits, so the integer part never
+     * has to hold more than |z|^2 right before the escape. operands of different precision are widened to the larger one,
+     * results are truncated towards zero.
+     */
+    class FixedPoint
+    {
+    public:
+        FixedPoint() = default;
+        explicit FixedPoint(uint32_t fractionLimbCount);
+
+        // exact, the integer part of value has to fit into 32 bits
+        static FixedPoint fromDouble(double value, uint32_t fractionLimbCount);
+        // decimal notation like "-0.7436438870371587047521915", throws std::invalid_argument for anything else
+        static FixedPoint fromString(const std::string& text, uint32_t fractionLimbCount);
+
+        // fraction limbs needed to tell apart points that are spacing apart, with guard bits for the orbit
+        static uint32_t getFractionLimbCount(double spacing);
+
+        uint32_t getFractionLimbCount() const { return static_cast<uint32_t>(mLimbs.empty() ? 0 : mLimbs.size() - 1); }
+        FixedPoint withPrecision(uint32_t fractionLimbCount) const;
+
+        double toDouble() const;
+        std::string toString(uint32_t fractionDigitCount) const;
+
+        FixedPoint operator+(const FixedPoint& other) const;
+        FixedPoint operator-(const FixedPoint& other) const;
+        FixedPoint operator*(const FixedPoint& other) const;
+        FixedPoint operator-() const;
+
+        bool operator==(const FixedPoint& other) const;
+        bool operator!=(const FixedPoint& other) const { return !(*this == other); }
+
+    private:
+        bool isZero() const;
+        // -1, 0 or 1, signs are ignored
+        static int compareMagnitudes(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+        static FixedPoint addSigned(const FixedPoint& a, const FixedPoint& b, bool isBNegative);
+
+        bool mIsNegative = false;
+        // least significant fraction limb first, the last one is the integer part
+        std::vector<uint32_t> mLimbs;
+    };
+}
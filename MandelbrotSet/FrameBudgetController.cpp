@@ -0,0 +1,138 @@
+#include "FrameBudgetController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace Falcor::Tutorial
+{
+    FrameBudgetController::FrameBudgetController(const Settings& settings) : mSettings(settings)
+    {
+        start(mIterations);
+    }
+
+    void FrameBudgetController::start(const int iterations, const float resolutionScale)
+    {
+        mIterations = std::clamp(iterations, mSettings.minIterations, mSettings.maxIterations);
+        mResolutionScale = std::clamp(resolutionScale, mSettings.minResolutionScale, 1.f);
+        mLogIterations = std::log(static_cast<double>(mIterations));
+        mSmoothedFrameTime = 0.0;
+        mPreviousError = 0.0;
+        mPreviousPreviousError = 0.0;
+        mFramesSinceResolutionChange = 0;
+        mLog.clear();
+        mLogStart = 0;
+        mFrameCount = 0;
+    }
+
+    void FrameBudgetController::update(const double frameTime)
+    {
+        if (!(frameTime > 0.0))
+            return;
+
+        mSmoothedFrameTime = mSmoothedFrameTime > 0.0 ? mSmoothedFrameTime + mSettings.smoothing * (frameTime - mSmoothedFrameTime) : frameTime;
+        const Sample sample{mFrameCount++, frameTime, mSmoothedFrameTime, mIterations, mResolutionScale};
+        if (mLog.size() < kMaxLogSize)
+        {
+            mLog.push_back(sample);
+        }
+        else
+        {
+            mLog[mLogStart] = sample;
+            mLogStart = (mLogStart + 1) % kMaxLogSize;
+        }
+        mFramesSinceResolutionChange++;
+
+        // positive while there is time left, ln 2 means the frame could take twice as long
+        const double ratio = mSmoothedFrameTime / mSettings.targetFrameTime;
+        double error = -std::log(ratio);
+        if (std::abs(ratio - 1.0) <= mSettings.deadBand)
+            error = 0.0;
+
+        const double step = mSettings.proportionalGain * (error - mPreviousError) + mSettings.integralGain * error +
+                            mSettings.derivativeGain * (error - 2.0 * mPreviousError + mPreviousPreviousError);
+        mPreviousPreviousError = mPreviousError;
+        mPreviousError = error;
+
+        const double minLog = std::log(static_cast<double>(mSettings.minIterations));
+        const double maxLog = std::log(static_cast<double>(mSettings.maxIterations));
+        mLogIterations = std::clamp(mLogIterations + step, minLog, maxLog);
+        mIterations = std::clamp(static_cast<int>(std::lround(std::exp(mLogIterations))), mSettings.minIterations, mSettings.maxIterations);
+
+        if (mSettings.adjustResolution)
+            updateResolution();
+        else
+            mResolutionScale = 1.f;
+    }
+
+    std::vector<FrameBudgetController::Sample> FrameBudgetController::getLog() const
+    {
+        std::vector<Sample> log;
+        log.reserve(mLog.size());
+        log.insert(log.end(), mLog.begin() + mLogStart, mLog.end());
+        log.insert(log.end(), mLog.begin(), mLog.begin() + mLogStart);
+        return log;
+    }
+
+    void FrameBudgetController::updateResolution()
+    {
+        if (mFramesSinceResolutionChange < mSettings.resolutionCooldownFrames)
+            return;
+
+        // lower only when the iterations can't go any lower, higher only with twice the dead band of time left
+        const double ratio = mSmoothedFrameTime / mSettings.targetFrameTime;
+        const bool isAtMinIterations = mIterations <= mSettings.minIterations;
+        float scale = mResolutionScale;
+
+        if (isAtMinIterations && ratio > 1.0 + mSettings.deadBand)
+            scale = std::max(mResolutionScale * mSettings.resolutionStep, mSettings.minResolutionScale);
+        else if (ratio < 1.0 - 2.0 * mSettings.deadBand)
+            scale = std::min(mResolutionScale / mSettings.resolutionStep, 1.f);
+
+        if (scale != mResolutionScale)
+        {
+            mResolutionScale = scale;
+            mFramesSinceResolutionChange = 0;
+            // the old frame times were measured at the old resolution, the next one starts the smoothing over
+            mSmoothedFrameTime = 0.0;
+        }
+    }
+
+    void FrameBudgetController::writeCsv(const std::filesystem::path& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("can't write " + path.string());
+
+        file << "frame,frame_time_ms,smoothed_frame_time_ms,target_frame_time_ms,iterations,resolution_scale\n";
+        for (const Sample& sample : getLog())
+        {
+            file << sample.frame << ',' << sample.frameTime * 1000.0 << ',' << sample.smoothedFrameTime * 1000.0 << ','
+                 << mSettings.targetFrameTime * 1000.0 << ',' << sample.iterations << ',' << sample.resolutionScale << '\n';
+        }
+    }
+
+    void FrameBudgetController::writeJson(const std::filesystem::path& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("can't write " + path.string());
+
+        file << "{\n  \"settings\": {\"target_frame_time_ms\": " << mSettings.targetFrameTime * 1000.0 << ", \"proportional_gain\": " << mSettings.proportionalGain
+             << ", \"integral_gain\": " << mSettings.integralGain << ", \"derivative_gain\": " << mSettings.derivativeGain << ", \"dead_band\": " << mSettings.deadBand
+             << ", \"smoothing\": " << mSettings.smoothing << ", \"min_iterations\": " << mSettings.minIterations << ", \"max_iterations\": " << mSettings.maxIterations
+             << ", \"adjust_resolution\": " << (mSettings.adjustResolution ? "true" : "false") << ", \"min_resolution_scale\": " << mSettings.minResolutionScale
+             << "},\n  \"samples\": [";
+
+        const std::vector<Sample> log = getLog();
+        for (size_t i = 0; i < log.size(); i++)
+        {
+            const Sample& sample = log[i];
+            file << (i == 0 ? "\n" : ",\n") << "    {\"frame\": " << sample.frame << ", \"frame_time_ms\": " << sample.frameTime * 1000.0
+                 << ", \"smoothed_frame_time_ms\": " << sample.smoothedFrameTime * 1000.0 << ", \"iterations\": " << sample.iterations
+                 << ", \"resolution_scale\": " << sample.resolutionScale << "}";
+        }
+        file << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * feedback loop that keeps the frame time at a target by adjusting the iteration budget, and the render resolution
+     * once the iterations can't go any lower. the frame time is smoothed and compared to the target on a log scale,
+     * since it grows about linearly with the iterations, so the same gains work at 100 and at 50000 iterations.
+     * the budget moves with an incremental pid step: no integral that can wind up while the budget sits at a limit.
+     * within the dead band nothing changes, and the resolution has a wider band and a cooldown, so it doesn't flicker.
+     * the most recent frames go into a log that can be saved as csv or json to tune the settings for a machine.
+     */
+    class FrameBudgetController
+    {
+    public:
+        struct Settings
+        {
+            double targetFrameTime = 1.0 / 30.0;    // seconds
+            double proportionalGain = 0.1;
+            double integralGain = 0.2;
+            double derivativeGain = 0.02;
+            double deadBand = 0.1;                  // relative to the target
+            double smoothing = 0.25;                // weight of the newest frame time
+            int minIterations = 16;
+            int maxIterations = 65536;
+
+            bool adjustResolution = false;
+            float minResolutionScale = 0.25f;
+            float resolutionStep = 0.8f;
+            uint32_t resolutionCooldownFrames = 30;
+        };
+
+        struct Sample
+        {
+            uint64_t frame = 0;
+            double frameTime = 0.0;
+            double smoothedFrameTime = 0.0;
+            int iterations = 0;                     // the budget the frame was rendered with
+            float resolutionScale = 1.f;
+        };
+
+        // the log keeps this many frames, the oldest are overwritten, that's over half an hour at 30 fps
+        static constexpr size_t kMaxLogSize = 1 << 16;
+
+        FrameBudgetController() : FrameBudgetController(Settings()) {}
+        explicit FrameBudgetController(const Settings& settings);
+
+        Settings& getSettings() { return mSettings; }
+        const Settings& getSettings() const { return mSettings; }
+
+        // starts from the current budget and clears the log
+        void start(int iterations, float resolutionScale = 1.f);
+        // the time of the frame rendered with the current budget, moves the budget for the next frame
+        void update(double frameTime);
+
+        int getIterations() const { return mIterations; }
+        float getResolutionScale() const { return mResolutionScale; }
+        double getSmoothedFrameTime() const { return mSmoothedFrameTime; }
+        // the logged frames from the oldest
+        std::vector<Sample> getLog() const;
+
+        // throws std::runtime_error if the file can't be written
+        void writeCsv(const std::filesystem::path& path) const;
+        void writeJson(const std::filesystem::path& path) const;
+
+    private:
+        void updateResolution();
+
+        Settings mSettings;
+        int mIterations = 256;
+        float mResolutionScale = 1.f;
+
+        // the budget on a log scale, the pid moves this one
+        double mLogIterations = 0.0;
+        double mSmoothedFrameTime = 0.0;
+        double mPreviousError = 0.0;
+        double mPreviousPreviousError = 0.0;
+        uint32_t mFramesSinceResolutionChange = 0;
+
+        // ring buffer, once it's full mLogStart is the oldest sample
+        std::vector<Sample> mLog;
+        size_t mLogStart = 0;
+        uint64_t mFrameCount = 0;
+    };
+}
@@ -0,0 +1,87 @@
+#include "MandelbrotColorizer.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        uint32_t getChunkCount(const size_t pixelCount)
+        {
+            return static_cast<uint32_t>((pixelCount + MandelbrotColorizer::kChunkSize - 1) / MandelbrotColorizer::kChunkSize);
+        }
+    }
+
+    MandelbrotColorizer::MandelbrotColorizer(const uint32_t threadCount)
+        : mpScheduler(std::make_unique<TileScheduler>(threadCount)), mThreadHistograms(mpScheduler->getThreadCount())
+    {
+    }
+
+    void MandelbrotColorizer::computeHistogram(const std::vector<uint32_t>& iterations, const int maxIterations, std::vector<uint32_t>& histogram)
+    {
+        const size_t binCount = size_t(std::max(maxIterations, 0)) + 1;
+        for (std::vector<uint32_t>& threadHistogram : mThreadHistograms)
+            threadHistogram.assign(binCount, 0);
+
+        mpScheduler->run(getChunkCount(iterations.size()), [&](const uint32_t chunk, const uint32_t threadIndex)
+        {
+            uint32_t* pBins = mThreadHistograms[threadIndex].data();
+            const size_t begin = size_t(chunk) * kChunkSize;
+            const size_t end = std::min(begin + kChunkSize, iterations.size());
+            for (size_t i = begin; i < end; i++)
+            {
+                if (static_cast<int>(iterations[i]) < maxIterations)
+                    pBins[iterations[i]]++;
+            }
+        });
+
+        // a few thousand bins per thread, not worth spreading out
+        histogram.assign(binCount, 0);
+        for (const std::vector<uint32_t>& threadHistogram : mThreadHistograms)
+        {
+            for (size_t bin = 0; bin < binCount; bin++)
+                histogram[bin] += threadHistogram[bin];
+        }
+    }
+
+    MandelbrotColorizer::Statistics MandelbrotColorizer::colorize(
+        const MandelbrotPalette& palette,
+        const std::vector<uint32_t>& iterations,
+        const std::vector<float>& squaredMagnitudes,
+        const int maxIterations,
+        std::vector<uint8_t>& rgba
+    )
+    {
+        Statistics statistics;
+        statistics.threadCount = mpScheduler->getThreadCount();
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<float> noDistribution;
+        if (palette.useHistogramEqualization)
+        {
+            computeHistogram(iterations, maxIterations, mHistogram);
+            MandelbrotPalette::getCumulativeDistribution(mHistogram, mDistribution);
+
+            const auto end = std::chrono::steady_clock::now();
+            statistics.histogramSeconds = std::chrono::duration<double>(end - start).count();
+            start = end;
+        }
+        const std::vector<float>& distribution = palette.useHistogramEqualization ? mDistribution : noDistribution;
+
+        const float* pMagnitudes = squaredMagnitudes.size() == iterations.size() ? squaredMagnitudes.data() : nullptr;
+        rgba.resize(iterations.size() * 4);
+
+        mpScheduler->run(getChunkCount(iterations.size()), [&](const uint32_t chunk, uint32_t)
+        {
+            const size_t begin = size_t(chunk) * kChunkSize;
+            const size_t count = std::min<size_t>(kChunkSize, iterations.size() - begin);
+            palette.colorize(
+                iterations.data() + begin, pMagnitudes != nullptr ? pMagnitudes + begin : nullptr, count, maxIterations, rgba.data() + begin * 4, distribution
+            );
+        });
+
+        statistics.mappingSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+}
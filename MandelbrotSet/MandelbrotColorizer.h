@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MandelbrotPalette.h"
+#include "TileScheduler.h"
+
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * colors whole frames on the cpu, chunks of pixels are spread over the threads of a tile scheduler.
+     * with histogram equalization it takes two passes: every thread counts the escape times of its chunks into its own
+     * histogram, so no counter is shared, the histograms are summed up and turned into the cumulative distribution,
+     * and the second pass maps every pixel through it. MandelbrotHistogram does the same on the gpu.
+     */
+    class MandelbrotColorizer
+    {
+    public:
+        struct Statistics
+        {
+            double histogramSeconds = 0.0;      // 0 without histogram equalization
+            double mappingSeconds = 0.0;
+            uint32_t threadCount = 1;
+        };
+
+        // pixels per task, enough that a task costs far more than taking it
+        static constexpr uint32_t kChunkSize = 1 << 16;
+
+        explicit MandelbrotColorizer(uint32_t threadCount = std::thread::hardware_concurrency());
+
+        // MandelbrotPalette::colorize on every thread, with the distribution of these counts if the palette equalizes
+        Statistics colorize(
+            const MandelbrotPalette& palette,
+            const std::vector<uint32_t>& iterations,
+            const std::vector<float>& squaredMagnitudes,
+            int maxIterations,
+            std::vector<uint8_t>& rgba
+        );
+
+        // escaped pixels per count, bins [0, maxIterations], the last one stays empty since those points didn't escape
+        void computeHistogram(const std::vector<uint32_t>& iterations, int maxIterations, std::vector<uint32_t>& histogram);
+
+        // of the last frame colored with histogram equalization
+        const std::vector<float>& getCumulativeDistribution() const { return mDistribution; }
+
+    private:
+        std::unique_ptr<TileScheduler> mpScheduler;
+        std::vector<std::vector<uint32_t>> mThreadHistograms;
+        std::vector<uint32_t> mHistogram;
+        std::vector<float> mDistribution;
+    };
+}
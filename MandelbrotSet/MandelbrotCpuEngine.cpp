@@ -0,0 +1,584 @@
+#include "MandelbrotCpuEngine.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MANDELBROT_X86 1
+#include <immintrin.h>
+#else
+#define MANDELBROT_X86 0
+#endif
+
+// gcc and clang only emit avx instructions in functions that ask for them, msvc emits whatever intrinsics are used.
+// fma is left out on purpose, a fused multiply-add rounds differently than the shader's separate operations
+#if MANDELBROT_X86 && !defined(_MSC_VER)
+#define MANDELBROT_TARGET_AVX2 __attribute__((target("avx2")))
+#define MANDELBROT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define MANDELBROT_TARGET_AVX2
+#define MANDELBROT_TARGET_AVX512
+#endif
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // the loop of get_iterations in MandelbrotIterations.cs.slang.
+        // with periodicity checks the orbit is compared to a point saved at every power of two iterations (Brent),
+        // an orbit that exactly hits an earlier point repeats forever in float too, so it never escapes.
+        // squaredMagnitude gets |z|^2 of the first point outside the escape radius, for the smooth coloring, 0 for the inside
+        uint32_t iterate(const float cx, const float cy, const int maxIterations, const bool checkPeriodicity, float& squaredMagnitude)
+        {
+            float x = 0.f;
+            float y = 0.f;
+            float savedX = 0.f;
+            float savedY = 0.f;
+            int nextCheckpoint = 1;
+            int i;
+            for (i = 0; (i < maxIterations) && ((x * x + y * y) < 4.f); i++)
+            {
+                const float tmp = (x * x) - (y * y) + cx;
+                y = (2.f * x * y) + cy;
+                x = tmp;
+
+                if (checkPeriodicity)
+                {
+                    if (x == savedX && y == savedY)
+                    {
+                        squaredMagnitude = 0.f;
+                        return static_cast<uint32_t>(maxIterations);
+                    }
+
+                    if (i + 1 == nextCheckpoint)
+                    {
+                        savedX = x;
+                        savedY = y;
+                        nextCheckpoint *= 2;
+                    }
+                }
+            }
+            // like the vector loops, a point that didn't escape has no magnitude
+            squaredMagnitude = i < maxIterations ? x * x + y * y : 0.f;
+            return static_cast<uint32_t>(i);
+        }
+
+#if MANDELBROT_X86
+        // the magnitudes cost a blend per iteration, the plain counts don't pay for it
+        template<bool TrackMagnitudes>
+        MANDELBROT_TARGET_AVX2 void iterateAVX2(
+            const float* pCx,
+            const float* pCy,
+            const int maxIterations,
+            const bool checkPeriodicity,
+            uint32_t* pIterations,
+            float* pSquaredMagnitudes
+        )
+        {
+            const __m256 cxs = _mm256_loadu_ps(pCx);
+            const __m256 cys = _mm256_loadu_ps(pCy);
+            const __m256 four = _mm256_set1_ps(4.f);
+            const __m256 two = _mm256_set1_ps(2.f);
+
+            __m256 x = _mm256_setzero_ps();
+            __m256 y = _mm256_setzero_ps();
+            __m256i counts = _mm256_setzero_si256();
+            __m256 squaredMagnitudes = _mm256_setzero_ps();
+
+            // lanes that are still iterating, and lanes that were found in a cycle
+            __m256 isActive = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            __m256 isPeriodic = _mm256_setzero_ps();
+            __m256 savedX = _mm256_setzero_ps();
+            __m256 savedY = _mm256_setzero_ps();
+            int nextCheckpoint = 1;
+
+            for (int i = 0; i < maxIterations; i++)
+            {
+                const __m256 xx = _mm256_mul_ps(x, x);
+                const __m256 yy = _mm256_mul_ps(y, y);
+
+                // escaped lanes keep iterating (they may reach inf or nan), but they don't count anymore.
+                // a lane keeps the magnitude of the iteration it escaped in
+                const __m256 lengths = _mm256_add_ps(xx, yy);
+                const __m256 isInside = _mm256_cmp_ps(lengths, four, _CMP_LT_OQ);
+                if constexpr (TrackMagnitudes)
+                    squaredMagnitudes = _mm256_blendv_ps(squaredMagnitudes, lengths, _mm256_andnot_ps(isInside, isActive));
+                isActive = _mm256_and_ps(isActive, isInside);
+                if (_mm256_movemask_ps(isActive) == 0)
+                    break;
+
+                // the mask is all ones (-1) in the lanes that are still inside
+                counts = _mm256_sub_epi32(counts, _mm256_castps_si256(isActive));
+
+                const __m256 tmp = _mm256_add_ps(_mm256_sub_ps(xx, yy), cxs);
+                y = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, x), y), cys);
+                x = tmp;
+
+                if (checkPeriodicity)
+                {
+                    const __m256 isRepeating = _mm256_and_ps(
+                        isActive, _mm256_and_ps(_mm256_cmp_ps(x, savedX, _CMP_EQ_OQ), _mm256_cmp_ps(y, savedY, _CMP_EQ_OQ))
+                    );
+                    isPeriodic = _mm256_or_ps(isPeriodic, isRepeating);
+                    isActive = _mm256_andnot_ps(isRepeating, isActive);
+
+                    if (i + 1 == nextCheckpoint)
+                    {
+                        savedX = x;
+                        savedY = y;
+                        nextCheckpoint *= 2;
+                    }
+                }
+            }
+
+            counts = _mm256_castps_si256(
+                _mm256_blendv_ps(_mm256_castsi256_ps(counts), _mm256_castsi256_ps(_mm256_set1_epi32(maxIterations)), isPeriodic)
+            );
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pIterations), counts);
+            if constexpr (TrackMagnitudes)
+                _mm256_storeu_ps(pSquaredMagnitudes, squaredMagnitudes);
+        }
+
+        template<bool TrackMagnitudes>
+        MANDELBROT_TARGET_AVX512 void iterateAVX512(
+            const float* pCx,
+            const float* pCy,
+            const int maxIterations,
+            const bool checkPeriodicity,
+            uint32_t* pIterations,
+            float* pSquaredMagnitudes
+        )
+        {
+            const __m512 cxs = _mm512_loadu_ps(pCx);
+            const __m512 cys = _mm512_loadu_ps(pCy);
+            const __m512 four = _mm512_set1_ps(4.f);
+            const __m512 two = _mm512_set1_ps(2.f);
+            const __m512i one = _mm512_set1_epi32(1);
+
+            __m512 x = _mm512_setzero_ps();
+            __m512 y = _mm512_setzero_ps();
+            __m512i counts = _mm512_setzero_si512();
+            __m512 squaredMagnitudes = _mm512_setzero_ps();
+            __mmask16 isActive = 0xFFFF;
+            __mmask16 isPeriodic = 0;
+            __m512 savedX = _mm512_setzero_ps();
+            __m512 savedY = _mm512_setzero_ps();
+            int nextCheckpoint = 1;
+
+            for (int i = 0; i < maxIterations; i++)
+            {
+                const __m512 xx = _mm512_mul_ps(x, x);
+                const __m512 yy = _mm512_mul_ps(y, y);
+
+                // an escaped lane never comes back, its point may become nan
+                const __m512 lengths = _mm512_add_ps(xx, yy);
+                const __mmask16 isInside = _mm512_mask_cmp_ps_mask(isActive, lengths, four, _CMP_LT_OQ);
+                if constexpr (TrackMagnitudes)
+                    squaredMagnitudes = _mm512_mask_mov_ps(squaredMagnitudes, isActive & ~isInside, lengths);
+                isActive = isInside;
+                if (isActive == 0)
+                    break;
+
+                counts = _mm512_mask_add_epi32(counts, isActive, counts, one);
+
+                const __m512 tmp = _mm512_add_ps(_mm512_sub_ps(xx, yy), cxs);
+                y = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(two, x), y), cys);
+                x = tmp;
+
+                if (checkPeriodicity)
+                {
+                    const __mmask16 isRepeating = _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(isActive, x, savedX, _CMP_EQ_OQ), y, savedY, _CMP_EQ_OQ);
+                    isPeriodic |= isRepeating;
+                    isActive &= ~isRepeating;
+
+                    if (i + 1 == nextCheckpoint)
+                    {
+                        savedX = x;
+                        savedY = y;
+                        nextCheckpoint *= 2;
+                    }
+                }
+            }
+
+            counts = _mm512_mask_mov_epi32(counts, isPeriodic, _mm512_set1_epi32(maxIterations));
+            _mm512_storeu_si512(pIterations, counts);
+            if constexpr (TrackMagnitudes)
+                _mm512_storeu_ps(pSquaredMagnitudes, squaredMagnitudes);
+        }
+#endif
+
+        // rectangles with at most this many pixels inside their border are iterated instead of split again
+        constexpr uint32_t kMinSubdividedArea = 16;
+
+        // main cardioid and period 2 bulb, both are inside the set, their points would run every iteration
+        bool isInMainCardioidOrBulb(const float cx, const float cy)
+        {
+            const float xq = cx - 0.25f;
+            const float q = xq * xq + cy * cy;
+            if (q * (q + xq) <= 0.25f * cy * cy)
+                return true;
+
+            const float xb = cx + 1.f;
+            return xb * xb + cy * cy < 0.0625f;
+        }
+
+        // iterations of count pixels, getPoint(i) gives the point of the i-th pixel and store(i, iterations, squaredMagnitude) takes the result.
+        // the points are computed with the scalar formula, so every lane starts from exactly the same point.
+        // the vector loops only track the magnitudes if they are needed, the magnitude passed to store is 0 otherwise
+        template<typename GetPoint, typename Store>
+        void computePoints(
+            const MandelbrotCpuEngine::InstructionSet instructionSet,
+            const MandelbrotCpuEngine::View& view,
+            const uint32_t count,
+            const bool needsMagnitudes,
+            const GetPoint& getPoint,
+            const Store& store
+        )
+        {
+            uint32_t i = 0;
+
+#if MANDELBROT_X86
+            const auto runVectors = [&](const uint32_t laneCount, auto iterateVector)
+            {
+                float cx[16];
+                float cy[16];
+                uint32_t iterations[16];
+                float squaredMagnitudes[16] = {};
+                for (; i + laneCount <= count; i += laneCount)
+                {
+                    uint32_t interiorCount = 0;
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        const float2 point = getPoint(i + lane);
+                        cx[lane] = point.x;
+                        cy[lane] = point.y;
+                        if (view.useInteriorChecks && isInMainCardioidOrBulb(cx[lane], cy[lane]))
+                            interiorCount++;
+                    }
+
+                    // partly interior vectors are iterated, the periodicity check stops their interior lanes early
+                    if (interiorCount == laneCount)
+                    {
+                        std::fill(iterations, iterations + laneCount, static_cast<uint32_t>(view.iterations));
+                        std::fill(squaredMagnitudes, squaredMagnitudes + laneCount, 0.f);
+                    }
+                    else
+                        iterateVector(cx, cy, view.iterations, view.useInteriorChecks, iterations, squaredMagnitudes);
+
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                        store(i + lane, iterations[lane], squaredMagnitudes[lane]);
+                }
+            };
+
+            if (instructionSet == MandelbrotCpuEngine::InstructionSet::AVX512)
+                runVectors(16, needsMagnitudes ? iterateAVX512<true> : iterateAVX512<false>);
+            else if (instructionSet == MandelbrotCpuEngine::InstructionSet::AVX2)
+                runVectors(8, needsMagnitudes ? iterateAVX2<true> : iterateAVX2<false>);
+#endif
+
+            // whatever is left doesn't fill a vector
+            for (; i < count; i++)
+            {
+                const float2 point = getPoint(i);
+                if (view.useInteriorChecks && isInMainCardioidOrBulb(point.x, point.y))
+                {
+                    store(i, static_cast<uint32_t>(view.iterations), 0.f);
+                }
+                else
+                {
+                    float squaredMagnitude = 0.f;
+                    const uint32_t iterations = iterate(point.x, point.y, view.iterations, view.useInteriorChecks, squaredMagnitude);
+                    store(i, iterations, squaredMagnitude);
+                }
+            }
+        }
+    }
+
+    MandelbrotCpuEngine::MandelbrotCpuEngine(const InstructionSet instructionSet, const uint32_t threadCount)
+        : mInstructionSet(isSupported(instructionSet) ? instructionSet : InstructionSet::Scalar), mpScheduler(std::make_unique<TileScheduler>(threadCount))
+    {
+    }
+
+    void MandelbrotCpuEngine::setInstructionSet(const InstructionSet instructionSet)
+    {
+        mInstructionSet = isSupported(instructionSet) ? instructionSet : InstructionSet::Scalar;
+    }
+
+    bool MandelbrotCpuEngine::isSupported(const InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case InstructionSet::AVX2:
+            return CpuFeatures::hasAVX2();
+        case InstructionSet::AVX512:
+            return CpuFeatures::hasAVX512F();
+        default:
+            return true;
+        }
+    }
+
+    MandelbrotCpuEngine::InstructionSet MandelbrotCpuEngine::getBestInstructionSet()
+    {
+        if (isSupported(InstructionSet::AVX512))
+            return InstructionSet::AVX512;
+        if (isSupported(InstructionSet::AVX2))
+            return InstructionSet::AVX2;
+        return InstructionSet::Scalar;
+    }
+
+    std::string MandelbrotCpuEngine::getName(const InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case InstructionSet::AVX2:
+            return "avx2";
+        case InstructionSet::AVX512:
+            return "avx-512";
+        default:
+            return "scalar";
+        }
+    }
+
+    float2 MandelbrotCpuEngine::toMandelbrotSpace(const View& view, const float2 screenPos)
+    {
+        const float2 resolution{static_cast<float>(view.width), static_cast<float>(view.height)};
+        return {(screenPos.x / resolution.x) * 3.5f * (1.f / view.zoom) - 2.5f + view.positionOffset.x,
+                (screenPos.y / resolution.y) * 2.f * (1.f / view.zoom) - 1.f + view.positionOffset.y};
+    }
+
+    void MandelbrotCpuEngine::computeSpan(
+        const View& view,
+        const uint32_t y,
+        const uint32_t x0,
+        const uint32_t x1,
+        uint32_t* pIterations,
+        float* pSquaredMagnitudes
+    ) const
+    {
+        if (x1 <= x0)
+            return;
+
+        const float cy = toMandelbrotSpace(view, {0.5f, static_cast<float>(y) + 0.5f}).y;
+        computePoints(
+            mInstructionSet,
+            view,
+            x1 - x0,
+            pSquaredMagnitudes != nullptr,
+            [&](const uint32_t i) { return float2(toMandelbrotSpace(view, {static_cast<float>(x0 + i) + 0.5f, 0.5f}).x, cy); },
+            [&](const uint32_t i, const uint32_t iterations, const float squaredMagnitude)
+            {
+                pIterations[i] = iterations;
+                if (pSquaredMagnitudes != nullptr)
+                    pSquaredMagnitudes[i] = squaredMagnitude;
+            }
+        );
+    }
+
+    void MandelbrotCpuEngine::computeColumn(
+        const View& view,
+        const uint32_t x,
+        const uint32_t y0,
+        const uint32_t y1,
+        uint32_t* pIterations,
+        float* pSquaredMagnitudes
+    ) const
+    {
+        if (y1 <= y0)
+            return;
+
+        const float cx = toMandelbrotSpace(view, {static_cast<float>(x) + 0.5f, 0.5f}).x;
+        computePoints(
+            mInstructionSet,
+            view,
+            y1 - y0,
+            pSquaredMagnitudes != nullptr,
+            [&](const uint32_t i) { return float2(cx, toMandelbrotSpace(view, {0.5f, static_cast<float>(y0 + i) + 0.5f}).y); },
+            [&](const uint32_t i, const uint32_t iterations, const float squaredMagnitude)
+            {
+                pIterations[size_t(i) * view.width] = iterations;
+                if (pSquaredMagnitudes != nullptr)
+                    pSquaredMagnitudes[size_t(i) * view.width] = squaredMagnitude;
+            }
+        );
+    }
+
+    MandelbrotCpuEngine::Statistics MandelbrotCpuEngine::computeIterations(
+        const View& view,
+        std::vector<uint32_t>& iterations,
+        std::vector<float>* pSquaredMagnitudes
+    ) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        iterations.resize(size_t(view.width) * view.height);
+        float* pMagnitudes = nullptr;
+        if (pSquaredMagnitudes != nullptr)
+        {
+            pSquaredMagnitudes->resize(iterations.size());
+            pMagnitudes = pSquaredMagnitudes->data();
+        }
+
+        // the cost of a tile isn't known before it's done, the scheduler balances the tiles while they run
+        const uint32_t tileCountX = (view.width + kTileSize - 1) / kTileSize;
+        const uint32_t tileCountY = (view.height + kTileSize - 1) / kTileSize;
+
+        std::atomic<uint64_t> iteratedPixelCount{0};
+
+        mpScheduler->run(tileCountX * tileCountY, [&](const uint32_t tile, uint32_t)
+        {
+            const uint32_t x0 = (tile % tileCountX) * kTileSize;
+            const uint32_t y0 = (tile / tileCountX) * kTileSize;
+            const uint32_t x1 = std::min(x0 + kTileSize, view.width);
+            const uint32_t y1 = std::min(y0 + kTileSize, view.height);
+
+            if (view.useRectangleSubdivision)
+            {
+                iteratedPixelCount.fetch_add(computeTileSubdivided(view, x0, y0, x1, y1, iterations.data(), pMagnitudes), std::memory_order_relaxed);
+                return;
+            }
+
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                const size_t offset = size_t(y) * view.width + x0;
+                computeSpan(view, y, x0, x1, iterations.data() + offset, pMagnitudes != nullptr ? pMagnitudes + offset : nullptr);
+            }
+        });
+
+        Statistics statistics;
+        statistics.instructionSet = mInstructionSet;
+        statistics.threadCount = mpScheduler->getThreadCount();
+        statistics.tileCount = tileCountX * tileCountY;
+        statistics.stealCount = mpScheduler->getStealCount();
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (statistics.seconds > 0.0)
+            statistics.megapixelsPerSecond = static_cast<double>(iterations.size()) / statistics.seconds * 1e-6;
+        if (view.useRectangleSubdivision && !iterations.empty())
+            statistics.iteratedPixelFraction = static_cast<double>(iteratedPixelCount.load()) / static_cast<double>(iterations.size());
+
+        return statistics;
+    }
+
+    uint32_t MandelbrotCpuEngine::computeTileSubdivided(
+        const View& view,
+        const uint32_t x0,
+        const uint32_t y0,
+        const uint32_t x1,
+        const uint32_t y1,
+        uint32_t* pIterations,
+        float* pSquaredMagnitudes
+    ) const
+    {
+        const auto at = [&](const uint32_t x, const uint32_t y) -> uint32_t& { return pIterations[size_t(y) * view.width + x]; };
+        const auto magnitudeAt = [&](const uint32_t x, const uint32_t y) { return pSquaredMagnitudes != nullptr ? pSquaredMagnitudes + size_t(y) * view.width + x : nullptr; };
+        uint32_t iteratedCount = 0;
+
+        const auto computeRow = [&](const uint32_t y, const uint32_t begin, const uint32_t end)
+        {
+            if (begin < end)
+            {
+                computeSpan(view, y, begin, end, &at(begin, y), magnitudeAt(begin, y));
+                iteratedCount += end - begin;
+            }
+        };
+
+        const auto computeColumn = [&](const uint32_t x, const uint32_t begin, const uint32_t end)
+        {
+            if (begin < end)
+            {
+                this->computeColumn(view, x, begin, end, &at(x, begin), magnitudeAt(x, begin));
+                iteratedCount += end - begin;
+            }
+        };
+
+        // the border of the whole tile, tiles don't share their borders, so they stay independent
+        const uint32_t right = x1 - 1;
+        const uint32_t bottom = y1 - 1;
+        computeRow(y0, x0, x1);
+        if (bottom > y0)
+            computeRow(bottom, x0, x1);
+        computeColumn(x0, y0 + 1, bottom);
+        if (right > x0)
+            computeColumn(right, y0 + 1, bottom);
+
+        // rectangles are inclusive pixel ranges whose border is already computed
+        struct Rectangle
+        {
+            uint32_t left, top, right, bottom;
+        };
+
+        View interiorView = view;
+        interiorView.useInteriorChecks = true;
+
+        std::vector<Rectangle> stack;
+        stack.push_back({x0, y0, right, bottom});
+
+        while (!stack.empty())
+        {
+            const Rectangle rect = stack.back();
+            stack.pop_back();
+
+            if (rect.right - rect.left < 2 || rect.bottom - rect.top < 2)
+                continue;
+
+            const uint32_t value = at(rect.left, rect.top);
+            bool isUniform = true;
+            for (uint32_t x = rect.left; x <= rect.right && isUniform; x++)
+                isUniform = at(x, rect.top) == value && at(x, rect.bottom) == value;
+            for (uint32_t y = rect.top + 1; y < rect.bottom && isUniform; y++)
+                isUniform = at(rect.left, y) == value && at(rect.right, y) == value;
+
+            // a uniform inside can still hide points escaping along a filament between two border pixels, so it's
+            // iterated, with the interior checks that give the same counts but skip the cycling orbits quickly
+            const bool isInterior = static_cast<int>(value) >= view.iterations;
+            if (isUniform && isInterior)
+            {
+                for (uint32_t y = rect.top + 1; y < rect.bottom; y++)
+                {
+                    if (rect.left + 1 < rect.right)
+                    {
+                        computeSpan(interiorView, y, rect.left + 1, rect.right, &at(rect.left + 1, y), magnitudeAt(rect.left + 1, y));
+                        iteratedCount += rect.right - rect.left - 1;
+                    }
+                }
+                continue;
+            }
+
+            // the magnitudes of escaped points differ from pixel to pixel, with them the bands aren't filled
+            if (isUniform && pSquaredMagnitudes == nullptr)
+            {
+                for (uint32_t y = rect.top + 1; y < rect.bottom; y++)
+                    std::fill(&at(rect.left + 1, y), &at(rect.right, y), value);
+                continue;
+            }
+
+            const uint32_t innerWidth = rect.right - rect.left - 1;
+            const uint32_t innerHeight = rect.bottom - rect.top - 1;
+            if (innerWidth * innerHeight <= kMinSubdividedArea)
+            {
+                for (uint32_t y = rect.top + 1; y < rect.bottom; y++)
+                    computeRow(y, rect.left + 1, rect.right);
+                continue;
+            }
+
+            // splitting the longer side, so the rectangles stay roughly square and their borders short
+            if (innerWidth >= innerHeight)
+            {
+                const uint32_t middle = (rect.left + rect.right) / 2;
+                computeColumn(middle, rect.top + 1, rect.bottom);
+                stack.push_back({rect.left, rect.top, middle, rect.bottom});
+                stack.push_back({middle, rect.top, rect.right, rect.bottom});
+            }
+            else
+            {
+                const uint32_t middle = (rect.top + rect.bottom) / 2;
+                computeRow(middle, rect.left + 1, rect.right);
+                stack.push_back({rect.left, rect.top, rect.right, middle});
+                stack.push_back({rect.left, middle, rect.right, rect.bottom});
+            }
+        }
+
+        return iteratedCount;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "TileScheduler.h"
+
+#include "Utils/Math/Vector.h"
+
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * cpu implementation of MandelbrotIterations.cs.slang, for machines without a gpu and for validating frames, MandelbrotPalette colors the counts.
+     * the escape time loop does the same float operations in the same order as the shader, 8 (avx2) or 16 (avx-512)
+     * pixels at a time. a lane stops counting once its point escaped, the whole vector stops once every lane did.
+     * the instruction set is picked at runtime, so the same binary runs on any x86 cpu, and anywhere else with the scalar loop.
+     * frames are cut into tiles that are spread over the cores by a work stealing scheduler.
+     */
+    class MandelbrotCpuEngine
+    {
+    public:
+        enum class InstructionSet : uint32_t
+        {
+            Scalar,
+            AVX2,
+            AVX512
+        };
+
+        // everything the shader's cbuffer has
+        struct View
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            float zoom = 1.f;
+            int iterations = 256;
+            float2 positionOffset{0, 0};
+
+            // skips points that are known to be inside: the main cardioid, the period 2 bulb and orbits that cycle.
+            // the iteration counts are exactly the same, only interior heavy views get faster
+            bool useInteriorChecks = true;
+
+            // Mariani-Silver: only the border of a rectangle is iterated, a rectangle with a uniform border is filled,
+            // any other is split in two along a new line of pixels. the level sets of the escape time are connected
+            // and have no holes, but inside the set a filament thinner than a pixel can slip between two border pixels,
+            // so a rectangle bordered by the inside is iterated with the interior checks instead of filled.
+            // the counts are the per pixel ones, pays off for wide bands outside the set and when the inside isn't
+            // skipped anyway (useInteriorChecks off)
+            bool useRectangleSubdivision = false;
+        };
+
+        struct Statistics
+        {
+            double seconds = 0.0;
+            double megapixelsPerSecond = 0.0;
+            InstructionSet instructionSet = InstructionSet::Scalar;
+            uint32_t threadCount = 1;
+            uint32_t tileCount = 0;
+            uint32_t stealCount = 0;
+            double iteratedPixelFraction = 1.0;     // the rest was filled by the rectangle subdivision
+        };
+
+        // small enough that even a frame mostly inside the set has many tiles per core to balance
+        static constexpr uint32_t kTileSize = 32;
+
+        explicit MandelbrotCpuEngine(InstructionSet instructionSet = getBestInstructionSet(), uint32_t threadCount = std::thread::hardware_concurrency());
+
+        static bool isSupported(InstructionSet instructionSet);
+        static InstructionSet getBestInstructionSet();
+        static std::string getName(InstructionSet instructionSet);
+
+        InstructionSet getInstructionSet() const { return mInstructionSet; }
+        // falls back to scalar if the cpu doesn't support it
+        void setInstructionSet(InstructionSet instructionSet);
+        uint32_t getThreadCount() const { return mpScheduler->getThreadCount(); }
+
+        // iteration count of every pixel, row by row from the top, iterations means the point didn't escape.
+        // pSquaredMagnitudes gets |z|^2 of the escaped points for the smooth coloring, 0 for the inside.
+        // the magnitudes of the escaped points differ from pixel to pixel, with them the rectangle subdivision fills nothing
+        Statistics computeIterations(const View& view, std::vector<uint32_t>& iterations, std::vector<float>* pSquaredMagnitudes = nullptr) const;
+
+        // iterations of a span of a row, written to pIterations[0, x1 - x0), and the magnitudes to pSquaredMagnitudes if it isn't null
+        void computeSpan(const View& view, uint32_t y, uint32_t x0, uint32_t x1, uint32_t* pIterations, float* pSquaredMagnitudes = nullptr) const;
+
+        // to_mandelbrot_space of the shader, screen positions are pixel centers like SV_Position
+        static float2 toMandelbrotSpace(const View& view, float2 screenPos);
+
+    private:
+        // iterations of a span of a column, written to every view.width-th element of pIterations
+        void computeColumn(const View& view, uint32_t x, uint32_t y0, uint32_t y1, uint32_t* pIterations, float* pSquaredMagnitudes) const;
+
+        // one tile with rectangle subdivision, returns the number of pixels that were actually iterated
+        uint32_t computeTileSubdivided(const View& view, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, uint32_t* pIterations, float* pSquaredMagnitudes) const;
+
+        InstructionSet mInstructionSet;
+        std::unique_ptr<TileScheduler> mpScheduler;
+    };
+}
@@ -0,0 +1,227 @@
+#include "MandelbrotDeepZoom.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kTileSize = 32;
+
+        // relative error of the series at the probe pixels, far below what moves a pixel's orbit by a pixel
+        constexpr double kSeriesTolerance = 1e-7;
+
+        double getSquaredLength(const double x, const double y)
+        {
+            return x * x + y * y;
+        }
+    }
+
+    MandelbrotDeepZoom::MandelbrotDeepZoom(const uint32_t threadCount) : mpScheduler(std::make_unique<TileScheduler>(threadCount))
+    {
+    }
+
+    std::complex<double> MandelbrotDeepZoom::getPixelOffset(const View& view, const double x, const double y)
+    {
+        return {((x + 0.5) / view.width - 0.5) * 3.5 / view.zoom, ((y + 0.5) / view.height - 0.5) * 2.0 / view.zoom};
+    }
+
+    uint32_t MandelbrotDeepZoom::getFractionLimbCount(const View& view)
+    {
+        const double spacing = std::min(3.5 / view.zoom / view.width, 2.0 / view.zoom / view.height);
+        return FixedPoint::getFractionLimbCount(spacing);
+    }
+
+    int MandelbrotDeepZoom::getSeriesScaleExponent(const View& view)
+    {
+        // the corner pixel has the largest offset, scaled by this it is between 1 and 2
+        return std::ilogb(std::abs(getPixelOffset(view, 0.0, 0.0)));
+    }
+
+    std::vector<std::complex<double>> MandelbrotDeepZoom::computeReferenceOrbit(const View& view)
+    {
+        const uint32_t fractionLimbCount = getFractionLimbCount(view);
+        const FixedPoint cx = view.centerX.withPrecision(fractionLimbCount);
+        const FixedPoint cy = view.centerY.withPrecision(fractionLimbCount);
+        FixedPoint x(fractionLimbCount);
+        FixedPoint y(fractionLimbCount);
+
+        // Z_0 up to the first Z that escaped or Z_iterations, the last one is only used to rebase a pixel
+        std::vector<std::complex<double>> orbit;
+        orbit.reserve(static_cast<size_t>(view.iterations) + 1);
+        orbit.emplace_back(0.0, 0.0);
+
+        for (int i = 0; i < view.iterations; i++)
+        {
+            const FixedPoint xy = x * y;
+            const FixedPoint nextX = x * x - y * y + cx;
+            y = xy + xy + cy;
+            x = nextX;
+
+            const std::complex<double> z(x.toDouble(), y.toDouble());
+            orbit.push_back(z);
+            if (getSquaredLength(z.real(), z.imag()) >= 4.0)
+                break;
+        }
+
+        return orbit;
+    }
+
+    uint32_t MandelbrotDeepZoom::findSeriesSkip(const View& view, const std::vector<std::complex<double>>& orbit, SeriesCoefficients& coefficients)
+    {
+        // the corners and the middles of the edges have the largest offsets, the series is least accurate there
+        std::vector<std::complex<double>> probeOffsets;
+        for (const double y : {0.0, 0.5, 1.0})
+        {
+            for (const double x : {0.0, 0.5, 1.0})
+            {
+                if (x != 0.5 || y != 0.5)
+                    probeOffsets.push_back(getPixelOffset(view, x * (view.width - 1), y * (view.height - 1)));
+            }
+        }
+
+        std::vector<std::complex<double>> probeDeltas(probeOffsets.size(), {0.0, 0.0});
+        SeriesCoefficients current{};
+        current.scaleExponent = getSeriesScaleExponent(view);
+        coefficients = current;
+        uint32_t skip = 0;
+
+        // a' = 2 Z a + 1, b' = 2 Z b + a^2, c' = 2 Z c + 2 a b, times the scale to the power of a, b and c's degree
+        const double scale = std::ldexp(1.0, current.scaleExponent);
+        const double inverseScale = std::ldexp(1.0, -current.scaleExponent);
+
+        for (size_t n = 0; n + 1 < orbit.size(); n++)
+        {
+            const std::complex<double> twoZ = 2.0 * orbit[n];
+            const std::complex<double> a = current.a;
+            const std::complex<double> b = current.b;
+            current.a = twoZ * a + scale;
+            current.b = twoZ * b + a * a;
+            current.c = twoZ * current.c + 2.0 * a * b;
+
+            bool isAccurate = true;
+            double maxDelta = 0.0;
+            for (size_t i = 0; i < probeOffsets.size() && isAccurate; i++)
+            {
+                const std::complex<double> dc = probeOffsets[i];
+                probeDeltas[i] = (twoZ + probeDeltas[i]) * probeDeltas[i] + dc;
+
+                const std::complex<double> u = dc * inverseScale;
+                const std::complex<double> series = ((current.c * u + current.b) * u + current.a) * u;
+                const double delta = std::abs(probeDeltas[i]);
+                isAccurate = std::abs(series - probeDeltas[i]) <= kSeriesTolerance * delta;
+                maxDelta = std::max(maxDelta, delta);
+            }
+
+            // no pixel may escape or need a rebase during the skipped iterations
+            const double reference = std::abs(orbit[n + 1]);
+            if (!isAccurate || reference + maxDelta >= 2.0 || reference <= 2.0 * maxDelta)
+                break;
+
+            skip = static_cast<uint32_t>(n + 1);
+            coefficients = current;
+        }
+
+        return skip;
+    }
+
+    MandelbrotDeepZoom::Statistics MandelbrotDeepZoom::computeIterations(
+        const View& view,
+        std::vector<uint32_t>& iterations,
+        std::vector<float>* pSquaredMagnitudes
+    ) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        Statistics statistics;
+        statistics.threadCount = mpScheduler->getThreadCount();
+        statistics.precisionBits = 32 * getFractionLimbCount(view);
+
+        const std::vector<std::complex<double>> orbit = computeReferenceOrbit(view);
+        statistics.referenceLength = static_cast<uint32_t>(orbit.size() - 1);
+        statistics.referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        SeriesCoefficients coefficients;
+        const uint32_t skip = findSeriesSkip(view, orbit, coefficients);
+        statistics.skippedIterations = skip;
+
+        iterations.resize(size_t(view.width) * view.height);
+        if (pSquaredMagnitudes != nullptr)
+            pSquaredMagnitudes->assign(iterations.size(), 0.f);
+
+        const double inverseScale = std::ldexp(1.0, -coefficients.scaleExponent);
+
+        const uint32_t tileCountX = (view.width + kTileSize - 1) / kTileSize;
+        const uint32_t tileCountY = (view.height + kTileSize - 1) / kTileSize;
+        std::atomic<uint64_t> rebaseCount{0};
+
+        mpScheduler->run(tileCountX * tileCountY, [&](const uint32_t tile, uint32_t)
+        {
+            const uint32_t x0 = (tile % tileCountX) * kTileSize;
+            const uint32_t y0 = (tile / tileCountX) * kTileSize;
+            const uint32_t x1 = std::min(x0 + kTileSize, view.width);
+            const uint32_t y1 = std::min(y0 + kTileSize, view.height);
+            uint64_t tileRebaseCount = 0;
+
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                for (uint32_t x = x0; x < x1; x++)
+                {
+                    const std::complex<double> dc = getPixelOffset(view, x, y);
+                    const std::complex<double> u = dc * inverseScale;
+                    const std::complex<double> series = ((coefficients.c * u + coefficients.b) * u + coefficients.a) * u;
+
+                    // plain doubles, std::complex multiplications check for nan and inf
+                    const double dcx = dc.real();
+                    const double dcy = dc.imag();
+                    double dx = series.real();
+                    double dy = series.imag();
+                    size_t m = skip;
+                    int n = static_cast<int>(skip);
+                    double squaredMagnitude = 0.0;
+
+                    for (; n < view.iterations; n++)
+                    {
+                        const double zx = orbit[m].real() + dx;
+                        const double zy = orbit[m].imag() + dy;
+                        const double length = getSquaredLength(zx, zy);
+                        if (length >= 4.0)
+                        {
+                            squaredMagnitude = length;
+                            break;
+                        }
+
+                        // closer to zero than to the reference (or the reference ran out): the pixel's own orbit becomes the difference
+                        if (m + 1 == orbit.size() || length < getSquaredLength(dx, dy))
+                        {
+                            dx = zx;
+                            dy = zy;
+                            m = 0;
+                            tileRebaseCount++;
+                        }
+
+                        const double sumX = 2.0 * orbit[m].real() + dx;
+                        const double sumY = 2.0 * orbit[m].imag() + dy;
+                        const double nextDx = sumX * dx - sumY * dy + dcx;
+                        dy = sumX * dy + sumY * dx + dcy;
+                        dx = nextDx;
+                        m++;
+                    }
+
+                    iterations[size_t(y) * view.width + x] = static_cast<uint32_t>(n);
+                    if (pSquaredMagnitudes != nullptr)
+                        (*pSquaredMagnitudes)[size_t(y) * view.width + x] = static_cast<float>(squaredMagnitude);
+                }
+            }
+
+            rebaseCount.fetch_add(tileRebaseCount, std::memory_order_relaxed);
+        });
+
+        statistics.rebaseCount = rebaseCount.load();
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+}
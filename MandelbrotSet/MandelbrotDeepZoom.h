@@ -0,0 +1,83 @@
+#pragma once
+
+#include "FixedPoint.h"
+#include "TileScheduler.h"
+
+#include <complex>
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * cpu renderer for zooms far beyond what the float shader (and even doubles) can resolve.
+     * the orbit of the view's center is iterated once in fixed point with as many bits as the zoom needs, every pixel then
+     * only iterates its difference to that reference orbit in doubles (perturbation): d' = 2 Z d + d^2 + dc.
+     * a cubic series in dc, checked against probe pixels at the view's corners, skips the iterations every pixel spends
+     * close to the reference. where a pixel's orbit gets closer to zero than to the reference, its difference can't be
+     * resolved anymore (a glitch), so the pixel is rebased onto the start of the reference orbit and goes on from there.
+     */
+    class MandelbrotDeepZoom
+    {
+    public:
+        // same framing as the shader: the view is 3.5 / zoom wide and 2 / zoom high around the center
+        struct View
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            FixedPoint centerX;
+            FixedPoint centerY;
+            double zoom = 1.0;
+            int iterations = 256;
+
+            bool operator==(const View& other) const
+            {
+                return width == other.width && height == other.height && zoom == other.zoom && iterations == other.iterations &&
+                       centerX == other.centerX && centerY == other.centerY;
+            }
+            bool operator!=(const View& other) const { return !(*this == other); }
+        };
+
+        struct Statistics
+        {
+            double seconds = 0.0;
+            double referenceSeconds = 0.0;
+            uint32_t precisionBits = 0;
+            uint32_t referenceLength = 0;       // iterations of the reference before it escaped or hit the limit
+            uint32_t skippedIterations = 0;     // by the series approximation, for every pixel
+            uint64_t rebaseCount = 0;
+            uint32_t threadCount = 1;
+        };
+
+        // the series coefficients are kept relative to the frame's scale and fit at any zoom, but the pixels iterate their
+        // differences in plain doubles and the glitch test squares them: deeper than about 1e150 the square of an offset
+        // of half a pixel of a 16k wide frame falls below the smallest normal double
+        static constexpr double kMaxZoom = 1e140;
+
+        explicit MandelbrotDeepZoom(uint32_t threadCount = std::thread::hardware_concurrency());
+
+        // iteration count of every pixel, row by row from the top, and |z|^2 at the escape, like MandelbrotCpuEngine::computeIterations
+        Statistics computeIterations(const View& view, std::vector<uint32_t>& iterations, std::vector<float>* pSquaredMagnitudes = nullptr) const;
+
+        // offset of a pixel center from the view's center
+        static std::complex<double> getPixelOffset(const View& view, double x, double y);
+        static uint32_t getFractionLimbCount(const View& view);
+        // the power of two the series scales the pixel offsets by, so the offsets are about 1
+        static int getSeriesScaleExponent(const View& view);
+
+    private:
+        // of the series in the pixel offset divided by 2^scaleExponent, i.e. a, b and c times 2^scaleExponent to the power
+        // of their degree. c grows like a^3, unscaled it leaves the range of doubles at zooms of about 1e100
+        struct SeriesCoefficients
+        {
+            std::complex<double> a, b, c;
+            int scaleExponent = 0;
+        };
+
+        static std::vector<std::complex<double>> computeReferenceOrbit(const View& view);
+        // the number of iterations all pixels can skip and the coefficients there
+        static uint32_t findSeriesSkip(const View& view, const std::vector<std::complex<double>>& orbit, SeriesCoefficients& coefficients);
+
+        std::unique_ptr<TileScheduler> mpScheduler;
+    };
+}
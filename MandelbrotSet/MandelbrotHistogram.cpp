@@ -0,0 +1,54 @@
+#include "MandelbrotHistogram.h"
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kGroupSize = 16;
+
+        uint32_t divideRoundingUp(const uint32_t a, const uint32_t b)
+        {
+            return (a + b - 1) / b;
+        }
+    }
+
+    MandelbrotHistogram::MandelbrotHistogram(const std::shared_ptr<Device>& pDevice) : mpDevice(pDevice)
+    {
+        Program::Desc accumulateDesc;
+        accumulateDesc.addShaderLibrary("Samples/MandelbrotSet/MandelbrotHistogram.cs.slang").csEntry("accumulate");
+        mpAccumulateProgram = ComputeProgram::create(mpDevice, accumulateDesc);
+        mpAccumulateVars = ComputeVars::create(mpDevice, mpAccumulateProgram->getReflector());
+
+        Program::Desc cumulateDesc;
+        cumulateDesc.addShaderLibrary("Samples/MandelbrotSet/MandelbrotHistogram.cs.slang").csEntry("cumulate");
+        mpCumulateProgram = ComputeProgram::create(mpDevice, cumulateDesc);
+        mpCumulateVars = ComputeVars::create(mpDevice, mpCumulateProgram->getReflector());
+    }
+
+    void MandelbrotHistogram::update(RenderContext* pRenderContext, const Texture::SharedPtr& pIterations, const int maxIterations)
+    {
+        const uint32_t binCount = static_cast<uint32_t>(std::max(maxIterations, 0)) + 1;
+        if (mpHistogram == nullptr || mpHistogram->getElementCount() != binCount)
+        {
+            const auto bindFlags = Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess;
+            mpHistogram = Buffer::createStructured(mpDevice.get(), sizeof(uint32_t), binCount, bindFlags, Buffer::CpuAccess::None, nullptr, false);
+            mpDistribution = Buffer::createStructured(mpDevice.get(), sizeof(float), binCount + 1, bindFlags, Buffer::CpuAccess::None, nullptr, false);
+        }
+
+        pRenderContext->clearUAV(mpHistogram->getUAV().get(), uint4(0));
+
+        const uint2 resolution{pIterations->getWidth(), pIterations->getHeight()};
+        mpAccumulateVars["MandelbrotHistogramCB"]["iResolution"] = resolution;
+        mpAccumulateVars["MandelbrotHistogramCB"]["iIterations"] = maxIterations;
+        mpAccumulateVars->setTexture("gIterations", pIterations);
+        mpAccumulateVars->setBuffer("gHistogram", mpHistogram);
+        mpAccumulateProgram->dispatchCompute(
+            pRenderContext, mpAccumulateVars.get(), uint3(divideRoundingUp(resolution.x, kGroupSize), divideRoundingUp(resolution.y, kGroupSize), 1)
+        );
+
+        mpCumulateVars["MandelbrotHistogramCB"]["iIterations"] = maxIterations;
+        mpCumulateVars->setBuffer("gHistogram", mpHistogram);
+        mpCumulateVars->setBuffer("gCumulativeDistribution", mpDistribution);
+        mpCumulateProgram->dispatchCompute(pRenderContext, mpCumulateVars.get(), uint3(1, 1, 1));
+    }
+}
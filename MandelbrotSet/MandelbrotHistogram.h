@@ -0,0 +1,35 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/Program/ComputeProgram.h"
+#include "Core/Program/ProgramVars.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * histogram of the escape times of a frame on the gpu and its cumulative distribution, for histogram equalization.
+     * every thread group counts its pixels into a histogram in group shared memory, so most increments never leave
+     * the group, and adds the bins it used to the global histogram. counts past the shared bins go to the global one directly.
+     * a single group then sums the bins up: every thread adds a run of bins, the runs are scanned in shared memory.
+     */
+    class MandelbrotHistogram
+    {
+    public:
+        explicit MandelbrotHistogram(const std::shared_ptr<Device>& pDevice);
+
+        // pIterations is the texture of MandelbrotIterationCache, the count in x
+        void update(RenderContext* pRenderContext, const Texture::SharedPtr& pIterations, int maxIterations);
+
+        // maxIterations + 2 floats, like MandelbrotPalette::getCumulativeDistribution
+        const Buffer::SharedPtr& getCumulativeDistribution() const { return mpDistribution; }
+
+    private:
+        std::shared_ptr<Device> mpDevice;
+        ComputeProgram::SharedPtr mpAccumulateProgram;
+        ComputeVars::SharedPtr mpAccumulateVars;
+        ComputeProgram::SharedPtr mpCumulateProgram;
+        ComputeVars::SharedPtr mpCumulateVars;
+
+        Buffer::SharedPtr mpHistogram;
+        Buffer::SharedPtr mpDistribution;
+    };
+}
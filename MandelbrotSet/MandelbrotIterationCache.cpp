@@ -0,0 +1,154 @@
+#include "MandelbrotIterationCache.h"
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kGroupSize = 16;
+
+        // float offsets don't land exactly on a whole pixel, this much of a pixel still counts as one
+        constexpr float kPanTolerance = 0.01f;
+
+        uint32_t divideRoundingUp(const uint32_t a, const uint32_t b)
+        {
+            return (a + b - 1) / b;
+        }
+    }
+
+    MandelbrotIterationCache::MandelbrotIterationCache(const std::shared_ptr<Device>& pDevice) : mpDevice(pDevice)
+    {
+        Program::Desc iterateDesc;
+        iterateDesc.addShaderLibrary("Samples/MandelbrotSet/MandelbrotIterations.cs.slang").csEntry("iterate");
+        mpIterateProgram = ComputeProgram::create(mpDevice, iterateDesc);
+        mpIterateVars = ComputeVars::create(mpDevice, mpIterateProgram->getReflector());
+
+        Program::Desc shiftDesc;
+        shiftDesc.addShaderLibrary("Samples/MandelbrotSet/MandelbrotIterations.cs.slang").csEntry("shift");
+        mpShiftProgram = ComputeProgram::create(mpDevice, shiftDesc);
+        mpShiftVars = ComputeVars::create(mpDevice, mpShiftProgram->getReflector());
+    }
+
+    void MandelbrotIterationCache::update(RenderContext* pRenderContext, const View& view, const bool useCache)
+    {
+        mComputedSampleCount = 0;
+        if (view.resolution.x == 0 || view.resolution.y == 0)
+            return;
+
+        if (mpIterations[0] == nullptr || mpIterations[0]->getWidth() != view.resolution.x || mpIterations[0]->getHeight() != view.resolution.y)
+        {
+            for (auto& pIterations : mpIterations)
+            {
+                pIterations = Texture::create2D(
+                    mpDevice.get(), view.resolution.x, view.resolution.y, ResourceFormat::RG32Float, 1, 1, nullptr,
+                    Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess
+                );
+            }
+            mRefinementStep = -1;
+        }
+
+        const uint2 origin{0, 0};
+        const int lastStep = static_cast<int>(std::size(kBlockSizes)) - 1;
+
+        if (!useCache)
+        {
+            computeRegion(pRenderContext, view, origin, view.resolution, 1);
+            mRefinementStep = lastStep;
+            mCachedView = view;
+            return;
+        }
+
+        const bool isSameFrame = mRefinementStep >= 0 && view.iterations == mCachedView.iterations && view.zoom == mCachedView.zoom &&
+                                 view.useInteriorChecks == mCachedView.useInteriorChecks;
+
+        if (isSameFrame && all(view.positionOffset == mCachedView.positionOffset))
+        {
+            // nothing to do once the refinement is finished
+            if (!isComplete())
+            {
+                mRefinementStep++;
+                computeRegion(pRenderContext, view, origin, view.resolution, kBlockSizes[mRefinementStep]);
+            }
+            return;
+        }
+
+        int2 panShift{0, 0};
+        if (isSameFrame && isComplete() && getPanShift(view, panShift))
+        {
+            shift(pRenderContext, view, panShift);
+
+            // the exposed strips, the corner where they meet is computed twice
+            if (panShift.x != 0)
+            {
+                const uint32_t width = static_cast<uint32_t>(std::abs(panShift.x));
+                const uint32_t x = panShift.x > 0 ? view.resolution.x - width : 0;
+                computeRegion(pRenderContext, view, {x, 0}, {width, view.resolution.y}, 1);
+            }
+            if (panShift.y != 0)
+            {
+                const uint32_t height = static_cast<uint32_t>(std::abs(panShift.y));
+                const uint32_t y = panShift.y > 0 ? view.resolution.y - height : 0;
+                computeRegion(pRenderContext, view, {0, y}, {view.resolution.x, height}, 1);
+            }
+
+            mCachedView = view;
+            return;
+        }
+
+        mRefinementStep = 0;
+        computeRegion(pRenderContext, view, origin, view.resolution, kBlockSizes[0]);
+        mCachedView = view;
+    }
+
+    bool MandelbrotIterationCache::getPanShift(const View& view, int2& shift) const
+    {
+        // pixel p of the new frame shows the point that pixel p + shift of the cached frame showed
+        const float2 pixelSize{3.5f / (view.zoom * view.resolution.x), 2.f / (view.zoom * view.resolution.y)};
+        const float2 pixels = (view.positionOffset - mCachedView.positionOffset) / pixelSize;
+        const float2 rounded{std::round(pixels.x), std::round(pixels.y)};
+
+        if (std::abs(pixels.x - rounded.x) > kPanTolerance || std::abs(pixels.y - rounded.y) > kPanTolerance)
+            return false;
+
+        shift = {static_cast<int>(rounded.x), static_cast<int>(rounded.y)};
+        return std::abs(shift.x) < static_cast<int>(view.resolution.x) && std::abs(shift.y) < static_cast<int>(view.resolution.y);
+    }
+
+    void MandelbrotIterationCache::setConstants(const ComputeVars::SharedPtr& pVars, const View& view) const
+    {
+        pVars["MandelbrotCSCB"]["iResolution"] = float2(view.resolution);
+        pVars["MandelbrotCSCB"]["iIterations"] = view.iterations;
+        pVars["MandelbrotCSCB"]["iPoitionOffset"] = view.positionOffset;
+        pVars["MandelbrotCSCB"]["iZoom"] = view.zoom;
+        pVars["MandelbrotCSCB"]["iUseInteriorChecks"] = view.useInteriorChecks;
+    }
+
+    void MandelbrotIterationCache::computeRegion(RenderContext* pRenderContext, const View& view, const uint2 origin, const uint2 size, const uint32_t blockSize)
+    {
+        setConstants(mpIterateVars, view);
+        mpIterateVars["MandelbrotCSCB"]["iRegionOrigin"] = origin;
+        mpIterateVars["MandelbrotCSCB"]["iRegionSize"] = size;
+        mpIterateVars["MandelbrotCSCB"]["iBlockSize"] = blockSize;
+        mpIterateVars->setTexture("gIterations", mpIterations[mCurrent]);
+
+        const uint2 blockCount{divideRoundingUp(size.x, blockSize), divideRoundingUp(size.y, blockSize)};
+        mpIterateProgram->dispatchCompute(
+            pRenderContext, mpIterateVars.get(), uint3(divideRoundingUp(blockCount.x, kGroupSize), divideRoundingUp(blockCount.y, kGroupSize), 1)
+        );
+
+        mComputedSampleCount += uint64_t(blockCount.x) * blockCount.y;
+    }
+
+    void MandelbrotIterationCache::shift(RenderContext* pRenderContext, const View& view, const int2 shift)
+    {
+        setConstants(mpShiftVars, view);
+        mpShiftVars["MandelbrotCSCB"]["iShift"] = shift;
+        mpShiftVars->setTexture("gPreviousIterations", mpIterations[mCurrent]);
+        mpShiftVars->setTexture("gIterations", mpIterations[1 - mCurrent]);
+
+        mpShiftProgram->dispatchCompute(
+            pRenderContext, mpShiftVars.get(), uint3(divideRoundingUp(view.resolution.x, kGroupSize), divideRoundingUp(view.resolution.y, kGroupSize), 1)
+        );
+
+        mCurrent = 1 - mCurrent;
+    }
+}
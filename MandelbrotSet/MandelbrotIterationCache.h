@@ -0,0 +1,66 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/Program/ComputeProgram.h"
+#include "Core/Program/ProgramVars.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * iteration counts of the last frame on the gpu, so a frame only computes what changed.
+     * an unchanged view computes nothing, a pan by whole pixels moves the old counts and only computes the exposed
+     * strips, anything else (zoom, iterations) starts over with a coarse preview that gets refined over the next frames:
+     * one count per 4x4 pixels, then per 2x2, then every pixel. a pan during the refinement starts it over too.
+     */
+    class MandelbrotIterationCache
+    {
+    public:
+        // everything the counts depend on
+        struct View
+        {
+            uint2 resolution{0, 0};
+            int iterations = 256;
+            float2 positionOffset{0, 0};
+            float zoom = 1.f;
+            bool useInteriorChecks = true;
+        };
+
+        // sides of the pixel blocks sharing one count, one step per frame
+        static constexpr uint32_t kBlockSizes[] = {4, 2, 1};
+
+        explicit MandelbrotIterationCache(const std::shared_ptr<Device>& pDevice);
+
+        // does this frame's share of the work, useCache false computes every pixel like a plain full screen pass
+        void update(RenderContext* pRenderContext, const View& view, bool useCache);
+
+        // RG32Float, the count and |z|^2 at the escape of every pixel of the view
+        const Texture::SharedPtr& getIterations() const { return mpIterations[mCurrent]; }
+        // counts computed by the last update, one for every block of pixels, 0 when the frame was reused as it was
+        uint64_t getComputedSampleCount() const { return mComputedSampleCount; }
+        // 1 once every pixel has its own count
+        uint32_t getBlockSize() const { return mRefinementStep < 0 ? 0 : kBlockSizes[mRefinementStep]; }
+
+    private:
+        bool isComplete() const { return mRefinementStep == static_cast<int>(std::size(kBlockSizes)) - 1; }
+        // shift in whole pixels between the cached view and view, false if it isn't a pan by whole pixels
+        bool getPanShift(const View& view, int2& shift) const;
+
+        void setConstants(const ComputeVars::SharedPtr& pVars, const View& view) const;
+        void computeRegion(RenderContext* pRenderContext, const View& view, uint2 origin, uint2 size, uint32_t blockSize);
+        void shift(RenderContext* pRenderContext, const View& view, int2 shift);
+
+        std::shared_ptr<Device> mpDevice;
+        ComputeProgram::SharedPtr mpIterateProgram;
+        ComputeVars::SharedPtr mpIterateVars;
+        ComputeProgram::SharedPtr mpShiftProgram;
+        ComputeVars::SharedPtr mpShiftVars;
+
+        // the shift reads one and writes the other
+        Texture::SharedPtr mpIterations[2];
+        uint32_t mCurrent = 0;
+
+        View mCachedView;
+        // index into kBlockSizes of the finest finished step, -1 if the counts are invalid
+        int mRefinementStep = -1;
+        uint64_t mComputedSampleCount = 0;
+    };
+}
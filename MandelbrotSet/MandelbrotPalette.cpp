@@ -0,0 +1,202 @@
+#include "MandelbrotPalette.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        uint32_t toUnorm8(const float value)
+        {
+            return static_cast<uint32_t>(std::lround(std::clamp(value, 0.f, 1.f) * 255.f));
+        }
+
+        uint32_t packColor(const float3 color)
+        {
+            return toUnorm8(color.x) | (toUnorm8(color.y) << 8) | (toUnorm8(color.z) << 16) | 0xFF000000;
+        }
+
+        float3 fromBytes(const uint32_t r, const uint32_t g, const uint32_t b)
+        {
+            return float3(static_cast<float>(r), static_cast<float>(g), static_cast<float>(b)) / 255.f;
+        }
+
+        // everything getColor needs that is the same for every pixel
+        struct Mapping
+        {
+            const uint32_t* pLut = nullptr;
+            const float* pDistribution = nullptr;   // null without histogram equalization
+            uint32_t lastBin = 0;
+            float inversePeriod = 1.f;
+            bool useSmoothColoring = true;
+            int maxIterations = 0;
+        };
+
+        Mapping getMapping(const MandelbrotPalette& palette, const int maxIterations, const std::vector<float>& distribution)
+        {
+            Mapping mapping;
+            mapping.pLut = palette.getLut().data();
+            if (palette.useHistogramEqualization && distribution.size() >= 2)
+            {
+                mapping.pDistribution = distribution.data();
+                mapping.lastBin = static_cast<uint32_t>(distribution.size()) - 2;
+            }
+            mapping.inversePeriod = 1.f / std::max(palette.period, 1.f);
+            mapping.useSmoothColoring = palette.useSmoothColoring;
+            mapping.maxIterations = maxIterations;
+            return mapping;
+        }
+
+        // the position in the gradient with histogram equalization is between the shares below the integer count and below the next one
+        uint32_t mapColor(const Mapping& mapping, const uint32_t iterations, const float squaredMagnitude)
+        {
+            if (static_cast<int>(iterations) >= mapping.maxIterations)
+                return 0xFF000000;
+
+            const float value = mapping.useSmoothColoring ? MandelbrotPalette::getSmoothIterations(iterations, squaredMagnitude) : static_cast<float>(iterations);
+            float t = 0.f;
+            if (mapping.pDistribution != nullptr)
+            {
+                const uint32_t bin = std::min(static_cast<uint32_t>(value), mapping.lastBin);
+                const float fraction = std::min(value - static_cast<float>(bin), 1.f);
+                t = mapping.pDistribution[bin] + (mapping.pDistribution[bin + 1] - mapping.pDistribution[bin]) * fraction;
+            }
+            else
+            {
+                t = value * mapping.inversePeriod;
+                t -= std::floor(t);
+            }
+            return mapping.pLut[std::min(static_cast<uint32_t>(t * static_cast<float>(MandelbrotPalette::kLutSize)), MandelbrotPalette::kLutSize - 1)];
+        }
+    }
+
+    MandelbrotPalette::MandelbrotPalette(const Preset preset) : mStops(getPresetStops(preset))
+    {
+        bake();
+    }
+
+    std::string MandelbrotPalette::getName(const Preset preset)
+    {
+        switch (preset)
+        {
+        case Preset::Fire:
+            return "fire";
+        case Preset::Grayscale:
+            return "grayscale";
+        case Preset::Rainbow:
+            return "rainbow";
+        default:
+            return "ocean";
+        }
+    }
+
+    std::vector<MandelbrotPalette::Stop> MandelbrotPalette::getPresetStops(const Preset preset)
+    {
+        switch (preset)
+        {
+        case Preset::Fire:
+            return {{0.f, fromBytes(0, 0, 0)}, {0.3f, fromBytes(200, 24, 0)}, {0.6f, fromBytes(255, 180, 0)}, {0.85f, fromBytes(255, 255, 200)}};
+        case Preset::Grayscale:
+            return {{0.f, fromBytes(0, 0, 0)}, {0.5f, fromBytes(255, 255, 255)}};
+        case Preset::Rainbow:
+            return {{0.f, fromBytes(255, 0, 0)}, {1.f / 6.f, fromBytes(255, 255, 0)}, {2.f / 6.f, fromBytes(0, 255, 0)},
+                    {3.f / 6.f, fromBytes(0, 255, 255)}, {4.f / 6.f, fromBytes(0, 0, 255)}, {5.f / 6.f, fromBytes(255, 0, 255)}};
+        default:
+            // the well known blue, white and orange gradient
+            return {{0.f, fromBytes(0, 7, 100)}, {0.16f, fromBytes(32, 107, 203)}, {0.42f, fromBytes(237, 255, 255)},
+                    {0.6425f, fromBytes(255, 170, 0)}, {0.8575f, fromBytes(0, 2, 0)}};
+        }
+    }
+
+    void MandelbrotPalette::bake()
+    {
+        for (Stop& stop : mStops)
+            stop.position = std::clamp(stop.position, 0.f, 1.f);
+        std::stable_sort(mStops.begin(), mStops.end(), [](const Stop& a, const Stop& b) { return a.position < b.position; });
+
+        mLut.assign(kLutSize, 0xFF000000);
+        if (!mStops.empty())
+        {
+            for (uint32_t i = 0; i < kLutSize; i++)
+            {
+                const float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(kLutSize);
+
+                // the stops around t, the gradient wraps from the last stop around to the first one of the next period
+                const auto next = std::upper_bound(mStops.begin(), mStops.end(), t, [](const float value, const Stop& stop) { return value < stop.position; });
+                const Stop& after = next == mStops.end() ? mStops.front() : *next;
+                const Stop& before = next == mStops.begin() ? mStops.back() : *(next - 1);
+                const float afterPosition = next == mStops.end() ? after.position + 1.f : after.position;
+                const float beforePosition = next == mStops.begin() ? before.position - 1.f : before.position;
+
+                const float length = afterPosition - beforePosition;
+                const float weight = length > 0.f ? (t - beforePosition) / length : 0.f;
+                mLut[i] = packColor(before.color + (after.color - before.color) * weight);
+            }
+        }
+    }
+
+    float MandelbrotPalette::getSmoothIterations(const uint32_t iterations, const float squaredMagnitude)
+    {
+        // |z|^2 is at least 4 for an escaped point, log2(log2|z|) goes from 0 at the escape radius up to about 1
+        if (!(squaredMagnitude > 1.f))
+            return static_cast<float>(iterations);
+        return std::max(static_cast<float>(iterations) + 1.f - std::log2(0.5f * std::log2(squaredMagnitude)), 0.f);
+    }
+
+    void MandelbrotPalette::getCumulativeDistribution(const std::vector<uint32_t>& histogram, std::vector<float>& distribution)
+    {
+        uint64_t total = 0;
+        for (const uint32_t count : histogram)
+            total += count;
+
+        // the prefix sums stay integers, only the shares are rounded
+        const double scale = total > 0 ? 1.0 / static_cast<double>(total) : 0.0;
+        distribution.resize(histogram.size() + 1);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < histogram.size(); i++)
+        {
+            distribution[i] = static_cast<float>(static_cast<double>(sum) * scale);
+            sum += histogram[i];
+        }
+        distribution.back() = static_cast<float>(static_cast<double>(sum) * scale);
+    }
+
+    uint32_t MandelbrotPalette::getColor(const uint32_t iterations, const float squaredMagnitude, const int maxIterations, const std::vector<float>& distribution) const
+    {
+        return mapColor(getMapping(*this, maxIterations, distribution), iterations, squaredMagnitude);
+    }
+
+    void MandelbrotPalette::colorize(
+        const uint32_t* pIterations,
+        const float* pSquaredMagnitudes,
+        const size_t count,
+        const int maxIterations,
+        uint8_t* pRgba,
+        const std::vector<float>& distribution
+    ) const
+    {
+        const Mapping mapping = getMapping(*this, maxIterations, distribution);
+        for (size_t i = 0; i < count; i++)
+        {
+            // red in the lowest byte is red first in memory on the little endian machines falcor runs on
+            const uint32_t color = mapColor(mapping, pIterations[i], pSquaredMagnitudes != nullptr ? pSquaredMagnitudes[i] : 0.f);
+            std::memcpy(pRgba + i * 4, &color, sizeof(color));
+        }
+    }
+
+    void MandelbrotPalette::colorize(
+        const std::vector<uint32_t>& iterations,
+        const std::vector<float>& squaredMagnitudes,
+        const int maxIterations,
+        std::vector<uint8_t>& rgba,
+        const std::vector<float>& distribution
+    ) const
+    {
+        // without magnitudes the smooth value falls back to the integer count
+        const bool hasMagnitudes = squaredMagnitudes.size() == iterations.size();
+        rgba.resize(iterations.size() * 4);
+        colorize(iterations.data(), hasMagnitudes ? squaredMagnitudes.data() : nullptr, iterations.size(), maxIterations, rgba.data(), distribution);
+    }
+}
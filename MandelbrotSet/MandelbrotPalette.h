@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Utils/Math/Vector.h"
+
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * color gradient of the escape times, baked into a lookup table whenever it's edited.
+     * the gpu gets the table as a 1d texture (Mandelbrot.ps.slang), the cpu renders, the deep zoom and the tile exporter
+     * read the same table, so a pixel's color is a single fetch everywhere. the gradient repeats every period iterations.
+     * smooth coloring uses the normalized iteration count n + 1 - log2(log2|z|), where |z| is the first orbit point
+     * outside the escape radius, instead of the integer count, so the bands between counts become a continuous gradient.
+     * with histogram equalization the gradient spans the cumulative distribution of the frame's counts once instead,
+     * so every color covers about as many pixels, however the counts of a deep zoom happen to be spread.
+     */
+    class MandelbrotPalette
+    {
+    public:
+        struct Stop
+        {
+            float position = 0.f;   // in [0, 1) along one period
+            float3 color{0.f};      // rgb in [0, 1]
+        };
+
+        enum class Preset : uint32_t
+        {
+            Ocean,
+            Fire,
+            Grayscale,
+            Rainbow
+        };
+
+        // entries of one period, fine enough that neighbouring entries can't be told apart
+        static constexpr uint32_t kLutSize = 1024;
+
+        explicit MandelbrotPalette(Preset preset = Preset::Ocean);
+
+        static std::string getName(Preset preset);
+        static std::vector<Stop> getPresetStops(Preset preset);
+
+        // edited stops only take effect with bake()
+        std::vector<Stop>& getStops() { return mStops; }
+        const std::vector<Stop>& getStops() const { return mStops; }
+        // sorts the stops and fills the table, the gradient wraps around from the last stop to the first
+        void bake();
+
+        // rgba8 entries, red in the lowest byte, like an RGBA8Unorm texel
+        const std::vector<uint32_t>& getLut() const { return mLut; }
+
+        float period = 64.f;        // iterations per repetition of the gradient
+        bool useSmoothColoring = true;
+        // needs the distribution of the frame, MandelbrotColorizer on the cpu and MandelbrotHistogram on the gpu
+        bool useHistogramEqualization = false;
+
+        // get_pixel_color of Mandelbrot.ps.slang, squaredMagnitude is |z|^2 at the escape, unused for interior points.
+        // distribution is only used with histogram equalization, without one the gradient repeats every period iterations
+        uint32_t getColor(uint32_t iterations, float squaredMagnitude, int maxIterations, const std::vector<float>& distribution = {}) const;
+        // rgba8 pixels, squaredMagnitudes may be empty, then every pixel gets the color of its integer count
+        void colorize(
+            const std::vector<uint32_t>& iterations,
+            const std::vector<float>& squaredMagnitudes,
+            int maxIterations,
+            std::vector<uint8_t>& rgba,
+            const std::vector<float>& distribution = {}
+        ) const;
+
+        // count pixels into pRgba, 4 bytes each, pSquaredMagnitudes may be null
+        void colorize(
+            const uint32_t* pIterations,
+            const float* pSquaredMagnitudes,
+            size_t count,
+            int maxIterations,
+            uint8_t* pRgba,
+            const std::vector<float>& distribution = {}
+        ) const;
+
+        static float getSmoothIterations(uint32_t iterations, float squaredMagnitude);
+
+        // histogram has one bin per count, distribution gets one more entry: the share of the pixels below each count, 1 at the end
+        static void getCumulativeDistribution(const std::vector<uint32_t>& histogram, std::vector<float>& distribution);
+
+    private:
+        std::vector<Stop> mStops;
+        std::vector<uint32_t> mLut;
+    };
+}
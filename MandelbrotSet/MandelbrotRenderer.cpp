@@ -1,18 +1,11 @@
 #include "MandelbrotRenderer.h"
 
-#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 
 namespace Falcor::Tutorial
 {
-    void MandelbrotRenderer::dumpIterationCount() const
-    {
-        std::ofstream file("testresult.txt");
-
-        file << "It took " << mSettings.iterations << " iterations, to get below 60 FPS.";
-
-        file.close();
-    }
-
     void MandelbrotRenderer::onLoad(RenderContext* pRenderContext)
     {
         Program::Desc programDesc;
@@ -20,34 +13,70 @@ namespace Falcor::Tutorial
         programDesc.addShaderLibrary("Samples/MandelbrotSet/Mandelbrot.ps.slang").psEntry("main");
 
         mpMainPass = FullScreenPass::create(getDevice(), programDesc);
+        mpIterationCache = std::make_unique<MandelbrotIterationCache>(getDevice());
+        mpHistogram = std::make_unique<MandelbrotHistogram>(getDevice());
     }
 
     void MandelbrotRenderer::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
     {
         // passing inputs to shaders before rendering
         mSettings.resolution = { static_cast<float>(pTargetFbo->getWidth()), static_cast<float>(pTargetFbo->getHeight()) };
-        mpMainPass["MandelbrotPSCB"]["iResolution"] = mSettings.resolution;
-        mpMainPass["MandelbrotPSCB"]["iIterations"] = mSettings.iterations;
-        mpMainPass["MandelbrotPSCB"]["iPoitionOffset"] = mSettings.positionOffset;
-        mpMainPass["MandelbrotPSCB"]["iZoom"] = mSettings.zoom;
-
-        // run final pass
-        mpMainPass->execute(pRenderContext, pTargetFbo);
 
-        mFrameRate.newFrame();
-
-        if (mSettings.isStressTesting)
+        if (mSettings.useDeepZoom)
+        {
+            renderDeepZoom(pRenderContext, pTargetFbo);
+        }
+        else
         {
-            // 0.033 to render a frame ~ 30 FPS
-            if (mFrameRate.getAverageFrameTime() < 0.033)
+            mIterationResolution = {
+                std::max(static_cast<uint32_t>(pTargetFbo->getWidth() * mSettings.resolutionScale), 1u),
+                std::max(static_cast<uint32_t>(pTargetFbo->getHeight() * mSettings.resolutionScale), 1u)
+            };
+
+            MandelbrotIterationCache::View view;
+            view.resolution = mIterationResolution;
+            view.iterations = mSettings.iterations;
+            view.positionOffset = mSettings.positionOffset;
+            view.zoom = mSettings.zoom;
+            view.useInteriorChecks = mSettings.useInteriorChecks;
+
+            // the frame time controller has to measure full frames
+            mpIterationCache->update(pRenderContext, view, mSettings.useIterationCache && !mSettings.useFrameBudget);
+
+            if (mpPaletteTexture == nullptr)
             {
-                mSettings.iterations += 100;
+                const std::vector<uint32_t>& lut = mSettings.palette.getLut();
+                mpPaletteTexture = Texture::create1D(
+                    getDevice().get(), static_cast<uint32_t>(lut.size()), ResourceFormat::RGBA8Unorm, 1, 1, lut.data(), Resource::BindFlags::ShaderResource
+                );
             }
-            else
+
+            // a histogram of the whole frame is two small dispatches, cheaper than telling when the counts changed
+            if (mSettings.palette.useHistogramEqualization)
             {
-                dumpIterationCount();
-                mSettings.isStressTesting = false;
+                mpHistogram->update(pRenderContext, mpIterationCache->getIterations(), mSettings.iterations);
+                mpMainPass["gCumulativeDistribution"] = mpHistogram->getCumulativeDistribution();
             }
+
+            mpMainPass["gIterations"] = mpIterationCache->getIterations();
+            mpMainPass["gPalette"] = mpPaletteTexture;
+            mpMainPass["MandelbrotPSCB"]["iIterations"] = mSettings.iterations;
+            mpMainPass["MandelbrotPSCB"]["iResolutionScale"] = float2(mIterationResolution) / mSettings.resolution;
+            mpMainPass["MandelbrotPSCB"]["iPalettePeriod"] = mSettings.palette.period;
+            mpMainPass["MandelbrotPSCB"]["iUseSmoothColoring"] = mSettings.palette.useSmoothColoring;
+            mpMainPass["MandelbrotPSCB"]["iUseHistogramEqualization"] = mSettings.palette.useHistogramEqualization;
+
+            // run final pass
+            mpMainPass->execute(pRenderContext, pTargetFbo);
+        }
+
+        mFrameRate.newFrame();
+
+        if (mSettings.useFrameBudget && !mSettings.useDeepZoom)
+        {
+            mFrameBudget.update(mFrameRate.getLastFrameTime());
+            mSettings.iterations = mFrameBudget.getIterations();
+            mSettings.resolutionScale = mFrameBudget.getResolutionScale();
         }
     }
 
@@ -58,12 +87,40 @@ namespace Falcor::Tutorial
 
     bool MandelbrotRenderer::onKeyEvent(const KeyboardEvent& keyEvent)
     {
-        if (mSettings.isStressTesting)
-            return false;
+        if (mSettings.useDeepZoom && (keyEvent.type == KeyboardEvent::Type::KeyPressed || keyEvent.type == KeyboardEvent::Type::KeyRepeated))
+        {
+            const double step = 1.0 / (std::pow(10.0, mSettings.deepZoomExponent) * 3.0);
+
+            switch (keyEvent.key)
+            {
+            case Input::Key::D:
+            case Input::Key::Right:
+                moveDeepZoomCenter(step, 0.0);
+                return true;
+
+            case Input::Key::A:
+            case Input::Key::Left:
+                moveDeepZoomCenter(-step, 0.0);
+                return true;
+
+            case Input::Key::W:
+            case Input::Key::Up:
+                moveDeepZoomCenter(0.0, -step);
+                return true;
+
+            case Input::Key::S:
+            case Input::Key::Down:
+                moveDeepZoomCenter(0.0, step);
+                return true;
+
+            default:
+                return false;
+            }
+        }
 
         if (keyEvent.type == KeyboardEvent::Type::KeyPressed || keyEvent.type == KeyboardEvent::Type::KeyRepeated)
         {
-            const float step = 1 / (mSettings.zoom * 3);
+            const float2 step = snapToPixels(float2(1 / (mSettings.zoom * 3)));
 
             switch(keyEvent.key)
             {
@@ -71,7 +128,7 @@ namespace Falcor::Tutorial
             case Input::Key::Right:
                 if (mSettings.positionOffset.x < 3.0f)
                 {
-                    mSettings.positionOffset.x += step;
+                    mSettings.positionOffset.x += step.x;
                     return true;
                 }
                 return false;
@@ -80,7 +137,7 @@ namespace Falcor::Tutorial
             case Input::Key::Left:
                 if (mSettings.positionOffset.x > -3.0f)
                 {
-                    mSettings.positionOffset.x -= step;
+                    mSettings.positionOffset.x -= step.x;
                     return true;
                 }
                 return false;
@@ -89,7 +146,7 @@ namespace Falcor::Tutorial
             case Input::Key::Up:
                 if (mSettings.positionOffset.y > -3.0f)
                 {
-                    mSettings.positionOffset.y -= step;
+                    mSettings.positionOffset.y -= step.y;
                     return true;
                 }
                 return false;
@@ -98,7 +155,7 @@ namespace Falcor::Tutorial
             case Input::Key::Down:
                 if (mSettings.positionOffset.y < 3.0f)
                 {
-                    mSettings.positionOffset.y += step;
+                    mSettings.positionOffset.y += step.y;
                     return true;
                 }
                 return false;
@@ -113,9 +170,6 @@ namespace Falcor::Tutorial
 
     bool MandelbrotRenderer::onMouseEvent(const MouseEvent& mouseEvent)
     {
-        if (mSettings.isStressTesting)
-            return false;
-
         // panning with mouse
         if (mouseEvent.type == MouseEvent::Type::ButtonDown || mouseEvent.type == MouseEvent::Type::ButtonUp)
         {
@@ -123,10 +177,39 @@ namespace Falcor::Tutorial
             return true;
         }
 
+        // same panning and zooming, only on the high precision center, the zoom goes in powers of ten
+        if (mSettings.useDeepZoom)
+        {
+            const double scale = 1.0 / std::pow(10.0, mSettings.deepZoomExponent);
+            const float2 previousPos = mPrevNormalizedMousePos;
+            mPrevNormalizedMousePos = mouseEvent.pos;
+
+            if (mouseEvent.type == MouseEvent::Type::Move && mIsMouseButtonDown)
+            {
+                moveDeepZoomCenter((previousPos.x - mouseEvent.pos.x) * 3.5 * scale, (previousPos.y - mouseEvent.pos.y) * 2.0 * scale);
+                return true;
+            }
+
+            if (mouseEvent.type == MouseEvent::Type::Wheel)
+            {
+                const double factor = std::max(1.0 + mouseEvent.wheelDelta.y / 5.0, 0.1);
+                const double maxExponent = std::log10(MandelbrotDeepZoom::kMaxZoom);
+                const float exponent = static_cast<float>(std::clamp(mSettings.deepZoomExponent + std::log10(factor), 0.0, maxExponent));
+                const double newScale = 1.0 / std::pow(10.0, exponent);
+
+                // the point under the mouse stays where it is
+                moveDeepZoomCenter((mouseEvent.pos.x - 0.5) * 3.5 * (scale - newScale), (mouseEvent.pos.y - 0.5) * 2.0 * (scale - newScale));
+                mSettings.deepZoomExponent = exponent;
+                return true;
+            }
+
+            return false;
+        }
+
         if (mouseEvent.type == MouseEvent::Type::Move && mIsMouseButtonDown)
         {
             const float2& newMousePos = NormalizedScreenPosToMandelbrotPos(mouseEvent.pos);
-            mSettings.positionOffset += mPrevMousePos - newMousePos;
+            mSettings.positionOffset += snapToPixels(mPrevMousePos - newMousePos);
 
             return true;
         }
@@ -158,9 +241,39 @@ namespace Falcor::Tutorial
         window.text("Move around with w, a, s, d or arrow keys.");
         window.text("Zoom with scroll wheel.");
         window.text("Holding down a mouse button and moving the mouse will pan the image.");
-        window.slider("Zoom level", mSettings.zoom, 0.33f, 70.f);
-        window.slider("Iterations", mSettings.iterations, 1, 8192);
-        window.slider("Position", mSettings.positionOffset, -3.0, 3.0);
+        bool useDeepZoom = mSettings.useDeepZoom;
+        if (window.checkbox("Deep zoom (cpu, perturbation)", useDeepZoom))
+            setDeepZoom(useDeepZoom);
+
+        if (mSettings.useDeepZoom)
+        {
+            window.slider("Zoom level (log10)", mSettings.deepZoomExponent, 0.f, static_cast<float>(std::log10(MandelbrotDeepZoom::kMaxZoom)));
+            window.slider("Iterations", mSettings.iterations, 1, 65536);
+
+            // enough digits to tell the pixels apart
+            const uint32_t digitCount = static_cast<uint32_t>(mSettings.deepZoomExponent) + 6;
+            window.text("Center x: " + mSettings.deepCenterX.toString(digitCount));
+            window.text("Center y: " + mSettings.deepCenterY.toString(digitCount));
+            if (!mDeepZoomResult.empty())
+                window.text(mDeepZoomResult);
+            if (mPendingDeepZoom.valid())
+                window.text("Rendering the next frame...");
+        }
+        else
+        {
+            window.slider("Zoom level", mSettings.zoom, 0.33f, 70.f);
+            window.slider("Iterations", mSettings.iterations, 1, 8192);
+            window.slider("Position", mSettings.positionOffset, -3.0, 3.0);
+        }
+        window.checkbox("Skip cardioid, bulb and periodic orbits", mSettings.useInteriorChecks);
+
+        if (!mSettings.useDeepZoom)
+        {
+            window.checkbox("Reuse iteration counts between frames", mSettings.useIterationCache);
+            const uint32_t blockSize = mpIterationCache->getBlockSize();
+            window.text("Computed " + std::to_string(mpIterationCache->getComputedSampleCount()) + " counts this frame, one per " +
+                        std::to_string(blockSize) + "x" + std::to_string(blockSize) + " pixels");
+        }
 
         if (window.button("Reset settings"))
         {
@@ -168,18 +281,138 @@ namespace Falcor::Tutorial
             float2 res = mSettings.resolution;
             mSettings = MandelbrotGUI();
             mSettings.resolution = res;
+            mpPaletteTexture = nullptr;
+            mIsDeepZoomColorStale = true;
         }
 
-        if (mSettings.isStressTesting)
+        static const Gui::DropdownList instructionSetList = {
+            {static_cast<uint32_t>(MandelbrotCpuEngine::InstructionSet::Scalar), "scalar"},
+            {static_cast<uint32_t>(MandelbrotCpuEngine::InstructionSet::AVX2), "avx2 (8 pixels)"},
+            {static_cast<uint32_t>(MandelbrotCpuEngine::InstructionSet::AVX512), "avx-512 (16 pixels)"}
+        };
+
+        window.dropdown("Cpu instruction set", instructionSetList, reinterpret_cast<uint32_t&>(mSettings.cpuInstructionSet));
+        window.checkbox("Fill rectangles with uniform borders on cpu", mSettings.useRectangleSubdivision);
+        if (window.button("Render frame on cpu"))
+            renderOnCpu();
+        if (!mCpuRenderResult.empty())
+            window.text(mCpuRenderResult);
+
+        renderPaletteGui(window);
+        renderFrameBudgetGui(window);
+    }
+
+    void MandelbrotRenderer::renderPaletteGui(Gui::Window& window)
+    {
+        auto paletteGroup = window.group("Palette", true);
+        if (!paletteGroup)
+            return;
+
+        static const Gui::DropdownList presetList = {
+            {static_cast<uint32_t>(MandelbrotPalette::Preset::Ocean), MandelbrotPalette::getName(MandelbrotPalette::Preset::Ocean)},
+            {static_cast<uint32_t>(MandelbrotPalette::Preset::Fire), MandelbrotPalette::getName(MandelbrotPalette::Preset::Fire)},
+            {static_cast<uint32_t>(MandelbrotPalette::Preset::Grayscale), MandelbrotPalette::getName(MandelbrotPalette::Preset::Grayscale)},
+            {static_cast<uint32_t>(MandelbrotPalette::Preset::Rainbow), MandelbrotPalette::getName(MandelbrotPalette::Preset::Rainbow)}
+        };
+
+        MandelbrotPalette& palette = mSettings.palette;
+        bool isChanged = false;
+
+        if (window.dropdown("Preset", presetList, reinterpret_cast<uint32_t&>(mSettings.palettePreset)))
         {
-            window.text("Mouse and keyboard events are disabled during stress testing.");
-            if (window.button("Stop stress test"))
-                mSettings.isStressTesting = false;
+            palette.getStops() = MandelbrotPalette::getPresetStops(mSettings.palettePreset);
+            isChanged = true;
         }
-        else
+        isChanged |= window.checkbox("Smooth coloring", palette.useSmoothColoring);
+        // the equalized gradient spans the counts of the frame once
+        isChanged |= window.checkbox("Histogram equalization", palette.useHistogramEqualization);
+        if (!palette.useHistogramEqualization)
+            isChanged |= window.var("Iterations per repetition", palette.period, 1.f, 65536.f);
+
+        // the stops are sorted by position when the table is baked
+        std::vector<MandelbrotPalette::Stop>& stops = palette.getStops();
+        for (size_t i = 0; i < stops.size(); i++)
+        {
+            const std::string index = std::to_string(i);
+            isChanged |= window.var(("Position " + index).c_str(), stops[i].position, 0.f, 1.f, 0.005f);
+            isChanged |= window.rgbColor(("Color " + index).c_str(), stops[i].color);
+            if (stops.size() > 1 && window.button(("Remove " + index).c_str()))
+            {
+                stops.erase(stops.begin() + i);
+                isChanged = true;
+                break;
+            }
+        }
+        if (window.button("Add stop"))
+        {
+            stops.push_back({0.5f, float3(1.f)});
+            isChanged = true;
+        }
+
+        if (isChanged)
+        {
+            palette.bake();
+            mpPaletteTexture = nullptr;
+            mIsDeepZoomColorStale = true;
+        }
+    }
+
+    void MandelbrotRenderer::renderFrameBudgetGui(Gui::Window& window)
+    {
+        auto budgetGroup = window.group("Frame time controller", true);
+        if (!budgetGroup)
+            return;
+
+        bool useFrameBudget = mSettings.useFrameBudget;
+        if (window.checkbox("Keep the frame time at the target", useFrameBudget))
+        {
+            mSettings.useFrameBudget = useFrameBudget;
+            mSettings.resolutionScale = 1.f;
+            if (useFrameBudget)
+                mFrameBudget.start(mSettings.iterations);
+        }
+
+        // the gui edits floats, the controller works with doubles
+        FrameBudgetController::Settings& settings = mFrameBudget.getSettings();
+        const auto editDouble = [&](const char* label, double& value, float minValue, float maxValue)
+        {
+            float editedValue = static_cast<float>(value);
+            if (window.var(label, editedValue, minValue, maxValue))
+                value = editedValue;
+        };
+
+        float targetMilliseconds = static_cast<float>(settings.targetFrameTime * 1000.0);
+        if (window.var("Target frame time (ms)", targetMilliseconds, 1.f, 1000.f))
+            settings.targetFrameTime = targetMilliseconds / 1000.0;
+        editDouble("Proportional gain", settings.proportionalGain, 0.f, 2.f);
+        editDouble("Integral gain", settings.integralGain, 0.f, 2.f);
+        editDouble("Derivative gain", settings.derivativeGain, 0.f, 2.f);
+        editDouble("Dead band", settings.deadBand, 0.f, 0.5f);
+        editDouble("Smoothing", settings.smoothing, 0.01f, 1.f);
+        window.var("Min iterations", settings.minIterations, 1, settings.maxIterations);
+        window.var("Max iterations", settings.maxIterations, settings.minIterations, 1 << 20);
+        window.checkbox("Adjust resolution", settings.adjustResolution);
+        if (settings.adjustResolution)
+            window.var("Min resolution scale", settings.minResolutionScale, 0.05f, 1.f);
+
+        if (mSettings.useFrameBudget)
         {
-            if (window.button("Start stress test"))
-                mSettings.isStressTesting = true;
+            const double smoothedFrameTime = mFrameBudget.getSmoothedFrameTime();
+            window.text(std::to_string(mSettings.iterations) + " iterations at " + std::to_string(mSettings.resolutionScale) + " resolution, " +
+                       std::to_string(smoothedFrameTime * 1000.0) + " ms");
+        }
+
+        if (window.button("Save log"))
+        {
+            try
+            {
+                mFrameBudget.writeCsv("frame_budget.csv");
+                mFrameBudget.writeJson("frame_budget.json");
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Can't save the frame time log: {}", e.what());
+            }
         }
     }
 
@@ -188,10 +421,410 @@ namespace Falcor::Tutorial
         return { pos.x * 3.5f * (1.0f / mSettings.zoom) - 2.5f + mSettings.positionOffset.x,
                  pos.y * 2.0f * (1.0f / mSettings.zoom) - 1.0f + mSettings.positionOffset.y };
     }
+
+    void MandelbrotRenderer::setDeepZoom(const bool useDeepZoom)
+    {
+        if (useDeepZoom == mSettings.useDeepZoom)
+            return;
+
+        mSettings.useDeepZoom = useDeepZoom;
+        if (useDeepZoom)
+        {
+            // the center of the shader's view, to_mandelbrot_space of the middle of the screen
+            const double zoom = mSettings.zoom;
+            const double centerX = 1.75 / zoom - 2.5 + mSettings.positionOffset.x;
+            const double centerY = 1.0 / zoom - 1.0 + mSettings.positionOffset.y;
+
+            mSettings.deepZoomExponent = static_cast<float>(std::max(std::log10(zoom), 0.0));
+            const uint32_t fractionLimbCount = MandelbrotDeepZoom::getFractionLimbCount(getDeepZoomView(mSettings));
+            mSettings.deepCenterX = FixedPoint::fromDouble(centerX, fractionLimbCount);
+            mSettings.deepCenterY = FixedPoint::fromDouble(centerY, fractionLimbCount);
+        }
+        else
+        {
+            // as close as the float view gets
+            mSettings.zoom = static_cast<float>(std::clamp(std::pow(10.0, mSettings.deepZoomExponent), 0.33, 70.0));
+            mSettings.positionOffset = {
+                static_cast<float>(mSettings.deepCenterX.toDouble() - 1.75 / mSettings.zoom + 2.5),
+                static_cast<float>(mSettings.deepCenterY.toDouble() - 1.0 / mSettings.zoom + 1.0)
+            };
+        }
+    }
+
+    MandelbrotDeepZoom::View MandelbrotRenderer::getDeepZoomView(const MandelbrotGUI& settings)
+    {
+        MandelbrotDeepZoom::View view;
+        view.width = static_cast<uint32_t>(settings.resolution.x);
+        view.height = static_cast<uint32_t>(settings.resolution.y);
+        view.zoom = std::pow(10.0, settings.deepZoomExponent);
+        view.iterations = settings.iterations;
+        view.centerX = settings.deepCenterX;
+        view.centerY = settings.deepCenterY;
+        return view;
+    }
+
+    void MandelbrotRenderer::moveDeepZoomCenter(const double x, const double y)
+    {
+        // the center gets more digits as the zoom goes deeper, none are dropped when it comes back up
+        const uint32_t fractionLimbCount = MandelbrotDeepZoom::getFractionLimbCount(getDeepZoomView(mSettings));
+        mSettings.deepCenterX = mSettings.deepCenterX + FixedPoint::fromDouble(x, fractionLimbCount);
+        mSettings.deepCenterY = mSettings.deepCenterY + FixedPoint::fromDouble(y, fractionLimbCount);
+    }
+
+    void MandelbrotRenderer::renderDeepZoom(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+    {
+        const MandelbrotDeepZoom::View view = getDeepZoomView(mSettings);
+        if (view.width == 0 || view.height == 0)
+            return;
+
+        if (mPendingDeepZoom.valid() && mPendingDeepZoom.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            DeepZoomFrame frame = mPendingDeepZoom.get();
+            mDeepZoomView = frame.view;
+            mDeepZoomIterations = std::move(frame.iterations);
+            mDeepZoomMagnitudes = std::move(frame.squaredMagnitudes);
+            mIsDeepZoomColorStale = true;
+
+            const MandelbrotDeepZoom::Statistics& statistics = frame.statistics;
+            mDeepZoomResult = std::to_string(statistics.seconds * 1000.0) + " ms, " + std::to_string(statistics.precisionBits) + " bit reference of " +
+                              std::to_string(statistics.referenceLength) + " iterations, " + std::to_string(statistics.skippedIterations) +
+                              " skipped by the series, " + std::to_string(statistics.rebaseCount) + " rebases";
+        }
+
+        // the reference orbit and the pixels are computed on a worker, one frame at a time since they share the scheduler.
+        // a view that changed again meanwhile is started once the frame in flight is done
+        const bool isShownView = !mDeepZoomIterations.empty() && view == mDeepZoomView;
+        if (!isShownView && !mPendingDeepZoom.valid())
+        {
+            if (mpDeepZoom == nullptr)
+                mpDeepZoom = std::make_unique<MandelbrotDeepZoom>();
+
+            mPendingDeepZoom = std::async(std::launch::async, [this, view]()
+            {
+                DeepZoomFrame frame;
+                frame.view = view;
+                frame.statistics = mpDeepZoom->computeIterations(view, frame.iterations, &frame.squaredMagnitudes);
+                return frame;
+            });
+        }
+
+        // nothing to show until the first frame is done
+        if (mDeepZoomIterations.empty())
+        {
+            pRenderContext->clearFbo(pTargetFbo.get(), {0, 0, 0, 1}, 1.0f, 0, FboAttachmentType::All);
+            return;
+        }
+
+        if (mIsDeepZoomColorStale)
+        {
+            if (mpCpuColorizer == nullptr)
+                mpCpuColorizer = std::make_unique<MandelbrotColorizer>();
+
+            std::vector<uint8_t> rgba;
+            mpCpuColorizer->colorize(mSettings.palette, mDeepZoomIterations, mDeepZoomMagnitudes, mDeepZoomView.iterations, rgba);
+            mpDeepZoomTexture = Texture::create2D(
+                getDevice().get(), mDeepZoomView.width, mDeepZoomView.height, ResourceFormat::RGBA8Unorm, 1, 1, rgba.data(), Resource::BindFlags::ShaderResource
+            );
+            mIsDeepZoomColorStale = false;
+        }
+
+        pRenderContext->blit(mpDeepZoomTexture->getSRV(), pTargetFbo->getRenderTargetView(0));
+    }
+
+    float2 MandelbrotRenderer::snapToPixels(const float2& offset) const
+    {
+        if (mSettings.resolution.x < 1.f || mSettings.resolution.y < 1.f)
+            return offset;
+
+        // whole pixels of the iteration counts, which can have a lower resolution than the target
+        const float2 resolution = mIterationResolution.x > 0 ? float2(mIterationResolution) : mSettings.resolution;
+        const float2 pixelSize{ 3.5f / (mSettings.zoom * resolution.x), 2.0f / (mSettings.zoom * resolution.y) };
+        return { std::round(offset.x / pixelSize.x) * pixelSize.x, std::round(offset.y / pixelSize.y) * pixelSize.y };
+    }
+
+    MandelbrotCpuEngine::View MandelbrotRenderer::getCpuView(const MandelbrotGUI& settings)
+    {
+        MandelbrotCpuEngine::View view;
+        view.width = static_cast<uint32_t>(settings.resolution.x);
+        view.height = static_cast<uint32_t>(settings.resolution.y);
+        view.zoom = settings.zoom;
+        view.iterations = settings.iterations;
+        view.positionOffset = settings.positionOffset;
+        view.useInteriorChecks = settings.useInteriorChecks;
+        view.useRectangleSubdivision = settings.useRectangleSubdivision;
+        return view;
+    }
+
+    MandelbrotCpuEngine::Statistics MandelbrotRenderer::renderCpuImage(
+        MandelbrotCpuEngine& engine,
+        MandelbrotColorizer& colorizer,
+        const MandelbrotGUI& settings,
+        const std::filesystem::path& path
+    )
+    {
+        engine.setInstructionSet(settings.cpuInstructionSet);
+        const MandelbrotCpuEngine::View view = getCpuView(settings);
+
+        std::vector<uint32_t> iterations;
+        // the banded colors don't need the magnitudes, without them the subdivision fills the uniform bands outside the set
+        std::vector<float> squaredMagnitudes;
+        const MandelbrotCpuEngine::Statistics statistics =
+            engine.computeIterations(view, iterations, settings.palette.useSmoothColoring ? &squaredMagnitudes : nullptr);
+
+        std::vector<uint8_t> rgba;
+        colorizer.colorize(settings.palette, iterations, squaredMagnitudes, view.iterations, rgba);
+        Bitmap::saveImage(path, view.width, view.height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, rgba.data());
+
+        return statistics;
+    }
+
+    void MandelbrotRenderer::renderOnCpu()
+    {
+        if (mpCpuEngine == nullptr)
+            mpCpuEngine = std::make_unique<MandelbrotCpuEngine>();
+        if (mpCpuColorizer == nullptr)
+            mpCpuColorizer = std::make_unique<MandelbrotColorizer>();
+
+        const MandelbrotCpuEngine::Statistics statistics = renderCpuImage(*mpCpuEngine, *mpCpuColorizer, mSettings, "mandelbrot_cpu.png");
+
+        mCpuRenderResult = "mandelbrot_cpu.png: " + std::to_string(statistics.megapixelsPerSecond) + " Mpixel/s (" +
+                           MandelbrotCpuEngine::getName(statistics.instructionSet) + ", " + std::to_string(mSettings.iterations) + " iterations, " +
+                           std::to_string(statistics.threadCount) + " threads, " + std::to_string(statistics.stealCount) + " steals, " +
+                           std::to_string(statistics.iteratedPixelFraction * 100.0) + "% of the pixels iterated)";
+    }
+
+    /*
+     * MandelbrotSet --cpu <output.png> [--size <width> <height>] [--iterations <n>] [--zoom <zoom>] [--offset <x> <y>] [--isa scalar|avx2|avx512]
+     *               [--interior-checks on|off] [--measure-interior-checks] [--subdivide] [--measure-subdivision]
+     *               [--deep-center <x> <y>] [--deep-zoom <log10 of the zoom>]
+     *               [--palette ocean|fire|grayscale|rainbow] [--palette-period <iterations>] [--banded] [--equalize]
+     * MandelbrotSet --pyramid <output> [--size <width> <height>] [--tile-size <n>] [same view options as --cpu]
+     * renders one frame with the cpu engine, saves it and prints the throughput.
+     * --pyramid renders an image of any size as a deep zoom pyramid, <output>.dzi and the tiles in <output>_files.
+     * --deep-center renders with the deep zoom instead, the center can have any number of decimal digits.
+     * --measure-interior-checks renders the frame with and without the interior checks too, and compares the two.
+     * --subdivide fills rectangles with uniform borders outside the set instead of iterating every pixel,
+     * --measure-subdivision renders the frame both ways and counts the pixels that differ.
+     * --banded colors the integer counts instead of the smooth iteration count,
+     * --equalize spreads the gradient over the distribution of the counts instead of repeating it every period.
+     */
+    int MandelbrotRenderer::runCpuRender(const std::vector<std::string>& args)
+    {
+        MandelbrotGUI settings;
+        settings.resolution = {1280, 720};
+        std::filesystem::path outputPath;
+        std::filesystem::path pyramidPath;
+        MandelbrotTileExporter::Settings pyramidSettings;
+        bool measureInteriorChecks = false;
+        bool measureSubdivision = false;
+        std::string deepCenterX;
+        std::string deepCenterY;
+
+        try
+        {
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                const auto next = [&]() -> const std::string&
+                {
+                    if (++i >= args.size())
+                        throw std::invalid_argument("missing value after " + args[i - 1]);
+                    return args[i];
+                };
+
+                if (args[i] == "--cpu")
+                    outputPath = next();
+                else if (args[i] == "--pyramid")
+                    pyramidPath = next();
+                else if (args[i] == "--tile-size")
+                    pyramidSettings.tileSize = static_cast<uint32_t>(std::stoul(next()));
+                else if (args[i] == "--size")
+                    settings.resolution = {std::stof(next()), std::stof(next())};
+                else if (args[i] == "--iterations")
+                    settings.iterations = std::stoi(next());
+                else if (args[i] == "--zoom")
+                    settings.zoom = std::stof(next());
+                else if (args[i] == "--offset")
+                    settings.positionOffset = {std::stof(next()), std::stof(next())};
+                else if (args[i] == "--interior-checks")
+                    settings.useInteriorChecks = next() == "on";
+                else if (args[i] == "--measure-interior-checks")
+                    measureInteriorChecks = true;
+                else if (args[i] == "--subdivide")
+                    settings.useRectangleSubdivision = true;
+                else if (args[i] == "--measure-subdivision")
+                    measureSubdivision = true;
+                else if (args[i] == "--deep-center")
+                {
+                    settings.useDeepZoom = true;
+                    deepCenterX = next();
+                    deepCenterY = next();
+                }
+                else if (args[i] == "--deep-zoom")
+                    settings.deepZoomExponent = std::stof(next());
+                else if (args[i] == "--palette")
+                {
+                    const std::string& name = next();
+                    const MandelbrotPalette::Preset presets[] = {
+                        MandelbrotPalette::Preset::Ocean, MandelbrotPalette::Preset::Fire, MandelbrotPalette::Preset::Grayscale, MandelbrotPalette::Preset::Rainbow
+                    };
+                    const auto preset = std::find_if(std::begin(presets), std::end(presets), [&](const auto p) { return MandelbrotPalette::getName(p) == name; });
+                    if (preset == std::end(presets))
+                        throw std::invalid_argument("unknown palette " + name);
+                    settings.palettePreset = *preset;
+                    settings.palette.getStops() = MandelbrotPalette::getPresetStops(*preset);
+                    settings.palette.bake();
+                }
+                else if (args[i] == "--palette-period")
+                    settings.palette.period = std::stof(next());
+                else if (args[i] == "--banded")
+                    settings.palette.useSmoothColoring = false;
+                else if (args[i] == "--equalize")
+                    settings.palette.useHistogramEqualization = true;
+                else if (args[i] == "--isa")
+                {
+                    const std::string& name = next();
+                    if (name == "scalar")
+                        settings.cpuInstructionSet = MandelbrotCpuEngine::InstructionSet::Scalar;
+                    else if (name == "avx2")
+                        settings.cpuInstructionSet = MandelbrotCpuEngine::InstructionSet::AVX2;
+                    else if (name == "avx512")
+                        settings.cpuInstructionSet = MandelbrotCpuEngine::InstructionSet::AVX512;
+                    else
+                        throw std::invalid_argument("unknown instruction set " + name);
+                }
+                else
+                    throw std::invalid_argument("unknown argument " + args[i]);
+            }
+
+            // the number of digits kept depends on the zoom, which can come after the center
+            if (settings.useDeepZoom)
+            {
+                const uint32_t fractionLimbCount = MandelbrotDeepZoom::getFractionLimbCount(getDeepZoomView(settings));
+                settings.deepCenterX = FixedPoint::fromString(deepCenterX, fractionLimbCount);
+                settings.deepCenterY = FixedPoint::fromString(deepCenterY, fractionLimbCount);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        if ((outputPath.empty() && pyramidPath.empty()) || settings.resolution.x < 1.f || settings.resolution.y < 1.f)
+        {
+            std::cerr << "an output path and a non-empty size are needed" << std::endl;
+            return 1;
+        }
+
+        if (!pyramidPath.empty())
+        {
+            if (settings.useDeepZoom)
+            {
+                std::cerr << "the pyramid is rendered with the float engine, it can't have a deep zoom center" << std::endl;
+                return 1;
+            }
+
+            try
+            {
+                const MandelbrotTileExporter exporter(pyramidSettings, settings.cpuInstructionSet);
+                const MandelbrotTileExporter::Statistics statistics = exporter.exportPyramid(getCpuView(settings), settings.palette, pyramidPath);
+
+                std::cout << settings.resolution.x << "x" << settings.resolution.y << ", " << statistics.levelCount << " levels, " << statistics.tileCount << " tiles, "
+                          << statistics.computeThreadCount << " threads: " << statistics.seconds << " s, " << statistics.pixelCount / statistics.seconds * 1e-6
+                          << " Mpixel/s, at most " << statistics.peakQueuedTiles << " tiles waiting to be written and " << statistics.peakTileBytes / (1024 * 1024)
+                          << " MB of tiles in memory" << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
+        if (settings.useDeepZoom)
+        {
+            if (settings.deepZoomExponent < 0.f || settings.deepZoomExponent > std::log10(MandelbrotDeepZoom::kMaxZoom))
+            {
+                std::cerr << "the deep zoom has to be between 10^0 and " << MandelbrotDeepZoom::kMaxZoom << std::endl;
+                return 1;
+            }
+
+            const MandelbrotDeepZoom::View view = getDeepZoomView(settings);
+            std::vector<uint32_t> iterations;
+            std::vector<float> squaredMagnitudes;
+            const MandelbrotDeepZoom::Statistics statistics = MandelbrotDeepZoom().computeIterations(view, iterations, &squaredMagnitudes);
+
+            std::vector<uint8_t> rgba;
+            MandelbrotColorizer().colorize(settings.palette, iterations, squaredMagnitudes, view.iterations, rgba);
+            Bitmap::saveImage(outputPath, view.width, view.height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, rgba.data());
+
+            std::cout << view.width << "x" << view.height << ", zoom " << view.zoom << ", " << view.iterations << " iterations, " << statistics.threadCount
+                      << " threads: " << statistics.seconds * 1000.0 << " ms (reference " << statistics.referenceSeconds * 1000.0 << " ms, "
+                      << statistics.precisionBits << " bits, " << statistics.referenceLength << " iterations), " << statistics.skippedIterations
+                      << " iterations skipped by the series, " << statistics.rebaseCount << " rebases" << std::endl;
+            return 0;
+        }
+
+        MandelbrotCpuEngine engine;
+        MandelbrotColorizer colorizer;
+        const MandelbrotCpuEngine::Statistics statistics = renderCpuImage(engine, colorizer, settings, outputPath);
+
+        if (measureInteriorChecks)
+        {
+            engine.setInstructionSet(settings.cpuInstructionSet);
+            MandelbrotCpuEngine::View view = getCpuView(settings);
+
+            std::vector<uint32_t> withChecks;
+            std::vector<uint32_t> withoutChecks;
+            view.useInteriorChecks = true;
+            const double secondsWithChecks = engine.computeIterations(view, withChecks).seconds;
+            view.useInteriorChecks = false;
+            const double secondsWithoutChecks = engine.computeIterations(view, withoutChecks).seconds;
+
+            std::cout << "interior checks: " << secondsWithChecks * 1000.0 << " ms, without: " << secondsWithoutChecks * 1000.0 << " ms, speedup "
+                      << secondsWithoutChecks / secondsWithChecks << "x, " << (withChecks == withoutChecks ? "identical" : "DIFFERENT") << " iterations" << std::endl;
+            if (withChecks != withoutChecks)
+                return 1;
+        }
+
+        if (measureSubdivision)
+        {
+            engine.setInstructionSet(settings.cpuInstructionSet);
+            MandelbrotCpuEngine::View view = getCpuView(settings);
+
+            std::vector<uint32_t> subdivided;
+            std::vector<uint32_t> perPixel;
+            view.useRectangleSubdivision = true;
+            const MandelbrotCpuEngine::Statistics subdividedStatistics = engine.computeIterations(view, subdivided);
+            view.useRectangleSubdivision = false;
+            const double secondsPerPixel = engine.computeIterations(view, perPixel).seconds;
+
+            size_t differentCount = 0;
+            for (size_t i = 0; i < perPixel.size(); i++)
+                differentCount += subdivided[i] != perPixel[i] ? 1 : 0;
+
+            std::cout << "subdivision: " << subdividedStatistics.seconds * 1000.0 << " ms, per pixel: " << secondsPerPixel * 1000.0 << " ms, speedup "
+                      << secondsPerPixel / subdividedStatistics.seconds << "x, " << subdividedStatistics.iteratedPixelFraction * 100.0 << "% of the pixels iterated, "
+                      << differentCount << " different pixels" << std::endl;
+        }
+
+        std::cout << settings.resolution.x << "x" << settings.resolution.y << ", " << settings.iterations << " iterations, " << MandelbrotCpuEngine::getName(statistics.instructionSet)
+                  << ", " << statistics.threadCount << " threads: " << statistics.seconds * 1000.0 << " ms, " << statistics.megapixelsPerSecond << " Mpixel/s";
+        if (settings.useRectangleSubdivision)
+            std::cout << ", " << statistics.iteratedPixelFraction * 100.0 << "% of the pixels iterated";
+        std::cout << std::endl;
+        return 0;
+    }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // a frame or a pyramid can be rendered on the cpu without creating a window
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (std::find(args.begin(), args.end(), "--cpu") != args.end() || std::find(args.begin(), args.end(), "--pyramid") != args.end())
+        return Falcor::Tutorial::MandelbrotRenderer::runCpuRender(args);
+
     Falcor::SampleAppConfig config;
     config.windowDesc.width = 1280;
     config.windowDesc.height = 720;
@@ -3,6 +3,17 @@
 #include "Core/SampleApp.h"
 #include "RenderGraph/BasePasses/FullScreenPass.h"
 
+#include "FrameBudgetController.h"
+#include "MandelbrotColorizer.h"
+#include "MandelbrotCpuEngine.h"
+#include "MandelbrotDeepZoom.h"
+#include "MandelbrotHistogram.h"
+#include "MandelbrotIterationCache.h"
+#include "MandelbrotPalette.h"
+#include "MandelbrotTileExporter.h"
+
+#include <future>
+
 namespace Falcor::Tutorial
 {
     struct MandelbrotGUI
@@ -11,17 +22,40 @@ namespace Falcor::Tutorial
         int     iterations = 256;
         float2  positionOffset{ 0, 0 };
         float2  resolution{ 0, 0 };
-        bool    isStressTesting = false;
+        // the frame time controller sets the iterations and the resolution scale
+        bool    useFrameBudget = false;
+        float   resolutionScale = 1.f;
+        bool    useInteriorChecks = true;
+        bool    useRectangleSubdivision = false;
+        bool    useIterationCache = true;
+        MandelbrotCpuEngine::InstructionSet cpuInstructionSet = MandelbrotCpuEngine::getBestInstructionSet();
+        // baked again whenever it's edited, the gpu and the cpu renders color with the same table
+        MandelbrotPalette palette;
+        MandelbrotPalette::Preset palettePreset = MandelbrotPalette::Preset::Ocean;
+
+        // past the float zoom the frame is rendered on the cpu around a center with as many digits as the zoom needs
+        bool        useDeepZoom = false;
+        float       deepZoomExponent = 0.f;
+        FixedPoint  deepCenterX;
+        FixedPoint  deepCenterY;
     };
 
     class MandelbrotRenderer : public SampleApp
     {
     public:
+        // a deep zoom frame computed on a worker thread, the reference orbit alone can take seconds
+        struct DeepZoomFrame
+        {
+            MandelbrotDeepZoom::View view;
+            std::vector<uint32_t> iterations;
+            std::vector<float> squaredMagnitudes;
+            MandelbrotDeepZoom::Statistics statistics;
+        };
+
         MandelbrotRenderer(const SampleAppConfig& config) : SampleApp(config)
         {
         }
 
-        void dumpIterationCount() const;
         // SampleApp implementation
         void onLoad(RenderContext* pRenderContext) override;
         void onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
@@ -33,13 +67,62 @@ namespace Falcor::Tutorial
 
         // own functions
         float2 NormalizedScreenPosToMandelbrotPos(const float2& pos) const;
+        // rounds a pan to whole pixels, so the iteration cache can reuse the previous frame
+        float2 snapToPixels(const float2& offset) const;
+        // renders the current view with the cpu engine into mandelbrot_cpu.png in the working directory
+        void renderOnCpu();
+        void renderFrameBudgetGui(Gui::Window& window);
+        void renderPaletteGui(Gui::Window& window);
+
+        // switches between the shader's view and the deep zoom view of the same region
+        void setDeepZoom(bool useDeepZoom);
+        // moves the deep zoom center by an offset in the complex plane
+        void moveDeepZoomCenter(double x, double y);
+        void renderDeepZoom(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo);
+
+        static MandelbrotCpuEngine::View getCpuView(const MandelbrotGUI& settings);
+        static MandelbrotCpuEngine::Statistics renderCpuImage(
+            MandelbrotCpuEngine& engine,
+            MandelbrotColorizer& colorizer,
+            const MandelbrotGUI& settings,
+            const std::filesystem::path& path
+        );
+        static MandelbrotDeepZoom::View getDeepZoomView(const MandelbrotGUI& settings);
+        // headless rendering without a window or gpu, returns the process exit code
+        static int runCpuRender(const std::vector<std::string>& args);
 
     protected:
         FullScreenPass::SharedPtr mpMainPass;
+        std::unique_ptr<MandelbrotIterationCache> mpIterationCache;
+        // the baked palette, created again after every edit
+        Texture::SharedPtr mpPaletteTexture;
+        // distribution of the counts for the histogram equalization, built again every frame
+        std::unique_ptr<MandelbrotHistogram> mpHistogram;
         MandelbrotGUI mSettings;
         bool mIsMouseButtonDown = false;
         float2 mPrevMousePos{ 0, 0 };
 
         FrameRate mFrameRate;
+        FrameBudgetController mFrameBudget;
+        // resolution of the iteration counts, the target's scaled by the resolution scale
+        uint2 mIterationResolution{ 0, 0 };
+        // created on first use, its worker threads stay around for the next frame
+        std::unique_ptr<MandelbrotCpuEngine> mpCpuEngine;
+        // colors the cpu and deep zoom frames
+        std::unique_ptr<MandelbrotColorizer> mpCpuColorizer;
+        std::string mCpuRenderResult;
+
+        std::unique_ptr<MandelbrotDeepZoom> mpDeepZoom;
+        // the last deep zoom frame is shown until the frame of the current view is done
+        MandelbrotDeepZoom::View mDeepZoomView;
+        Texture::SharedPtr mpDeepZoomTexture;
+        // kept to color the frame again when only the palette changes
+        std::vector<uint32_t> mDeepZoomIterations;
+        std::vector<float> mDeepZoomMagnitudes;
+        bool mIsDeepZoomColorStale = false;
+        std::string mDeepZoomResult;
+        // the worker uses mpDeepZoom, so the future is declared after it and waits for the worker before it's destroyed
+        std::future<DeepZoomFrame> mPendingDeepZoom;
+        float2 mPrevNormalizedMousePos{ 0, 0 };
     };
 }
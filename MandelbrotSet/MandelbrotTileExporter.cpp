@@ -0,0 +1,309 @@
+#include "MandelbrotTileExporter.h"
+
+#include "Utils/Image/Bitmap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        struct RenderedTile
+        {
+            std::filesystem::path path;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> rgba;
+        };
+
+        // bounded fifo between the compute threads and the writers
+        class TileQueue
+        {
+        public:
+            explicit TileQueue(const size_t capacity) : mCapacity(std::max<size_t>(capacity, 1)) {}
+
+            // blocks while the queue is full
+            void push(RenderedTile&& tile)
+            {
+                std::unique_lock lock(mMutex);
+                mNotFull.wait(lock, [&] { return mTiles.size() < mCapacity; });
+                mTiles.push_back(std::move(tile));
+                mPeakSize = std::max(mPeakSize, mTiles.size());
+                mNotEmpty.notify_one();
+            }
+
+            // false once the queue is closed and empty
+            bool pop(RenderedTile& tile)
+            {
+                std::unique_lock lock(mMutex);
+                mNotEmpty.wait(lock, [&] { return !mTiles.empty() || mIsClosed; });
+                if (mTiles.empty())
+                    return false;
+
+                tile = std::move(mTiles.front());
+                mTiles.pop_front();
+                mNotFull.notify_one();
+                return true;
+            }
+
+            void close()
+            {
+                std::lock_guard lock(mMutex);
+                mIsClosed = true;
+                mNotEmpty.notify_all();
+            }
+
+            size_t getPeakSize() const { return mPeakSize; }
+
+        private:
+            const size_t mCapacity;
+            std::deque<RenderedTile> mTiles;
+            size_t mPeakSize = 0;
+            bool mIsClosed = false;
+
+            std::mutex mMutex;
+            std::condition_variable mNotFull;
+            std::condition_variable mNotEmpty;
+        };
+
+        struct TileRef
+        {
+            uint32_t level;
+            uint32_t column;
+            uint32_t row;
+        };
+
+        // where a level's tiles start in the order they are computed, the tiles themselves are never listed
+        struct LevelTiles
+        {
+            uint64_t firstTile;
+            uint32_t columnCount;
+        };
+
+        TileRef getTile(const std::vector<LevelTiles>& levels, const uint64_t tileIndex)
+        {
+            // the last level that starts at or before the tile, there are only a few dozen levels
+            const auto it = std::upper_bound(levels.begin(), levels.end(), tileIndex, [](const uint64_t index, const LevelTiles& level)
+            {
+                return index < level.firstTile;
+            }) - 1;
+            const uint64_t tile = tileIndex - it->firstTile;
+            return {static_cast<uint32_t>(it - levels.begin()), static_cast<uint32_t>(tile % it->columnCount), static_cast<uint32_t>(tile / it->columnCount)};
+        }
+
+        // first pixel and size of a tile along one axis, the overlap reaches into the neighbours where there are any
+        void getTileSpan(const uint32_t index, const uint32_t tileSize, const uint32_t overlap, const uint32_t levelSize, uint32_t& begin, uint32_t& end)
+        {
+            const uint64_t start = uint64_t(index) * tileSize;
+            begin = static_cast<uint32_t>(start >= overlap ? start - overlap : 0);
+            end = static_cast<uint32_t>(std::min<uint64_t>(start + tileSize + overlap, levelSize));
+        }
+
+        void updatePeak(std::atomic<uint64_t>& peak, const uint64_t value)
+        {
+            uint64_t current = peak.load(std::memory_order_relaxed);
+            while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    MandelbrotTileExporter::MandelbrotTileExporter(const Settings& settings, const MandelbrotCpuEngine::InstructionSet instructionSet, const uint32_t threadCount)
+        // the engine only computes spans on the exporter's threads, it doesn't need threads of its own
+        : mSettings(settings), mEngine(instructionSet, 1), mpScheduler(std::make_unique<TileScheduler>(threadCount))
+    {
+        mSettings.tileSize = std::max(mSettings.tileSize, 1u);
+        mSettings.writerThreadCount = std::max(mSettings.writerThreadCount, 1u);
+    }
+
+    uint32_t MandelbrotTileExporter::getLevelCount(const uint32_t width, const uint32_t height)
+    {
+        // one level per halving until the larger side is a single pixel
+        uint32_t levelCount = 1;
+        for (uint64_t size = std::max(width, height); size > 1; size = (size + 1) / 2)
+            levelCount++;
+        return levelCount;
+    }
+
+    uint32_t MandelbrotTileExporter::getLevelSize(const uint32_t size, const uint32_t level, const uint32_t levelCount)
+    {
+        const uint32_t shift = levelCount - 1 - level;
+        return static_cast<uint32_t>(std::max<uint64_t>((uint64_t(size) + (uint64_t(1) << shift) - 1) >> shift, 1));
+    }
+
+    void MandelbrotTileExporter::computePreviewDistribution(
+        const MandelbrotCpuEngine::View& view,
+        const uint32_t levelCount,
+        std::vector<float>& distribution
+    ) const
+    {
+        // the largest level that fits, the full image if it's small enough
+        MandelbrotCpuEngine::View previewView = view;
+        previewView.useRectangleSubdivision = false;
+        for (uint32_t level = levelCount; level-- > 0;)
+        {
+            previewView.width = getLevelSize(view.width, level, levelCount);
+            previewView.height = getLevelSize(view.height, level, levelCount);
+            if (std::max(previewView.width, previewView.height) <= kPreviewSize)
+                break;
+        }
+
+        std::vector<uint32_t> iterations(size_t(previewView.width) * previewView.height);
+        mpScheduler->run(previewView.height, [&](const uint32_t y, uint32_t)
+        {
+            mEngine.computeSpan(previewView, y, 0, previewView.width, iterations.data() + size_t(y) * previewView.width);
+        });
+
+        std::vector<uint32_t> histogram(size_t(std::max(view.iterations, 0)) + 1, 0);
+        for (const uint32_t count : iterations)
+        {
+            if (static_cast<int>(count) < view.iterations)
+                histogram[count]++;
+        }
+        MandelbrotPalette::getCumulativeDistribution(histogram, distribution);
+    }
+
+    MandelbrotTileExporter::Statistics MandelbrotTileExporter::exportPyramid(
+        const MandelbrotCpuEngine::View& view,
+        const MandelbrotPalette& palette,
+        const std::filesystem::path& path
+    ) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        if (view.width == 0 || view.height == 0)
+            throw std::runtime_error("can't export an empty image");
+
+        Statistics statistics;
+        statistics.levelCount = getLevelCount(view.width, view.height);
+        statistics.computeThreadCount = mpScheduler->getThreadCount();
+
+        const std::filesystem::path filesDirectory = path.parent_path() / (path.filename().string() + "_files");
+        const uint32_t tileSize = mSettings.tileSize;
+
+        // the coarse levels first, they are done in no time and a viewer can already show something.
+        // a 1e6 x 1e6 export has millions of tiles, so only where each level starts is kept and the tile is worked out
+        // from its index
+        std::vector<LevelTiles> levels;
+        for (uint32_t level = 0; level < statistics.levelCount; level++)
+        {
+            const uint32_t levelWidth = getLevelSize(view.width, level, statistics.levelCount);
+            const uint32_t levelHeight = getLevelSize(view.height, level, statistics.levelCount);
+            const uint32_t columnCount = (levelWidth + tileSize - 1) / tileSize;
+            const uint32_t rowCount = (levelHeight + tileSize - 1) / tileSize;
+
+            std::filesystem::create_directories(filesDirectory / std::to_string(level));
+            levels.push_back({statistics.tileCount, columnCount});
+            statistics.tileCount += uint64_t(columnCount) * rowCount;
+            statistics.pixelCount += uint64_t(levelWidth) * levelHeight;
+        }
+
+        std::vector<float> distribution;
+        if (palette.useHistogramEqualization)
+            computePreviewDistribution(view, statistics.levelCount, distribution);
+
+        TileQueue queue(mSettings.maxQueuedTiles);
+        std::atomic<uint64_t> tileBytes{0};
+        std::atomic<uint64_t> peakTileBytes{0};
+
+        std::mutex errorMutex;
+        std::string error;
+
+        std::vector<std::thread> writers;
+        for (uint32_t i = 0; i < mSettings.writerThreadCount; i++)
+        {
+            writers.emplace_back([&]()
+            {
+                RenderedTile tile;
+                while (queue.pop(tile))
+                {
+                    // after an error the queue is still drained, so the compute threads don't wait on it forever
+                    try
+                    {
+                        Bitmap::saveImage(tile.path, tile.width, tile.height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, tile.rgba.data());
+                    }
+                    catch (const std::exception& e)
+                    {
+                        std::lock_guard lock(errorMutex);
+                        if (error.empty())
+                            error = "can't write " + tile.path.string() + ": " + e.what();
+                    }
+
+                    tileBytes.fetch_sub(tile.rgba.size(), std::memory_order_relaxed);
+                    tile.rgba = {};
+                }
+            });
+        }
+
+        const auto computeTile = [&](const uint64_t tileIndex)
+        {
+            const TileRef tile = getTile(levels, tileIndex);
+
+            MandelbrotCpuEngine::View levelView = view;
+            levelView.width = getLevelSize(view.width, tile.level, statistics.levelCount);
+            levelView.height = getLevelSize(view.height, tile.level, statistics.levelCount);
+            levelView.useRectangleSubdivision = false;
+
+            uint32_t x0, x1, y0, y1;
+            getTileSpan(tile.column, tileSize, mSettings.overlap, levelView.width, x0, x1);
+            getTileSpan(tile.row, tileSize, mSettings.overlap, levelView.height, y0, y1);
+
+            RenderedTile rendered;
+            rendered.path = filesDirectory / std::to_string(tile.level) / (std::to_string(tile.column) + "_" + std::to_string(tile.row) + ".png");
+            rendered.width = x1 - x0;
+            rendered.height = y1 - y0;
+
+            const uint64_t pixelCount = uint64_t(rendered.width) * rendered.height;
+            updatePeak(peakTileBytes, tileBytes.fetch_add(pixelCount * 12, std::memory_order_relaxed) + pixelCount * 12);
+
+            {
+                std::vector<uint32_t> iterations(pixelCount);
+                std::vector<float> squaredMagnitudes(pixelCount);
+                for (uint32_t y = y0; y < y1; y++)
+                {
+                    const size_t offset = size_t(y - y0) * rendered.width;
+                    mEngine.computeSpan(levelView, y, x0, x1, iterations.data() + offset, squaredMagnitudes.data() + offset);
+                }
+                palette.colorize(iterations, squaredMagnitudes, view.iterations, rendered.rgba, distribution);
+            }
+            tileBytes.fetch_sub(pixelCount * 8, std::memory_order_relaxed);
+
+            queue.push(std::move(rendered));
+        };
+
+        // the scheduler counts tiles in 32 bits, a tile size of 1 on a huge image can have more
+        for (uint64_t firstTile = 0; firstTile < statistics.tileCount;)
+        {
+            const uint32_t runTileCount = static_cast<uint32_t>(std::min<uint64_t>(statistics.tileCount - firstTile, std::numeric_limits<uint32_t>::max()));
+            mpScheduler->run(runTileCount, [&](const uint32_t tile, uint32_t) { computeTile(firstTile + tile); });
+            firstTile += runTileCount;
+        }
+
+        queue.close();
+        for (std::thread& writer : writers)
+            writer.join();
+
+        if (!error.empty())
+            throw std::runtime_error(error);
+
+        // written last, a viewer only finds the pyramid once every tile is there
+        const std::filesystem::path descriptorPath = path.parent_path() / (path.filename().string() + ".dzi");
+        std::ofstream descriptor(descriptorPath);
+        if (!descriptor)
+            throw std::runtime_error("can't write " + descriptorPath.string());
+
+        descriptor << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                   << "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"png\" Overlap=\"" << mSettings.overlap << "\" TileSize=\"" << tileSize << "\">\n"
+                   << "  <Size Width=\"" << view.width << "\" Height=\"" << view.height << "\"/>\n"
+                   << "</Image>\n";
+
+        statistics.peakQueuedTiles = static_cast<uint32_t>(queue.getPeakSize());
+        statistics.peakTileBytes = peakTileBytes.load();
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "MandelbrotCpuEngine.h"
+#include "MandelbrotPalette.h"
+
+#include <filesystem>
+#include <string>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * renders views far larger than any frame as a deep zoom image pyramid (the .dzi layout of OpenSeadragon and friends):
+     *   <name>.dzi                             size, tile size and overlap
+     *   <name>_files/<level>/<column>_<row>.png
+     * the last level is the full image, every level before it has half the size, down to a single pixel.
+     * every level is rendered at its own resolution instead of downsampling the one below, so a tile never waits for
+     * other tiles and nothing but the tiles in flight is in memory: one per compute thread plus the write queue, whatever
+     * the size of the image. the tiles are computed on the engine's threads and encoded and written by separate writer
+     * threads, a full queue holds the computation back until the disk catches up.
+     * the engine iterates in floats like the shader, so the detail stops growing at about 10^7 pixels across at zoom 1.
+     * a histogram equalized palette needs the distribution of the whole image before the first tile, it's taken from a
+     * level of at most kPreviewSize pixels, so every tile of every level is mapped through the same distribution.
+     */
+    class MandelbrotTileExporter
+    {
+    public:
+        struct Settings
+        {
+            uint32_t tileSize = 254;            // 254 + 2 overlap pixels makes 256 wide inner tiles
+            uint32_t overlap = 1;               // pixels shared with each neighbour, so viewers can filter across tiles
+            uint32_t writerThreadCount = 2;
+            uint32_t maxQueuedTiles = 16;       // rendered tiles waiting to be written
+        };
+
+        struct Statistics
+        {
+            double seconds = 0.0;
+            uint32_t levelCount = 0;
+            uint64_t tileCount = 0;
+            uint64_t pixelCount = 0;            // over every level
+            uint32_t computeThreadCount = 0;
+            uint32_t peakQueuedTiles = 0;
+            uint64_t peakTileBytes = 0;         // iterations, magnitudes and colors of every tile that was in memory at the same time
+        };
+
+        // sides of the level the distribution for histogram equalization is taken from
+        static constexpr uint32_t kPreviewSize = 1024;
+
+        explicit MandelbrotTileExporter(const Settings& settings, MandelbrotCpuEngine::InstructionSet instructionSet = MandelbrotCpuEngine::getBestInstructionSet(),
+                                        uint32_t threadCount = std::thread::hardware_concurrency());
+
+        // view.width and view.height are the size of the full image, the rectangle subdivision isn't used.
+        // writes <path>.dzi and <path>_files, throws std::runtime_error if a file can't be written
+        Statistics exportPyramid(const MandelbrotCpuEngine::View& view, const MandelbrotPalette& palette, const std::filesystem::path& path) const;
+
+        // the deep zoom levels: the last one is the full image, level 0 is one pixel
+        static uint32_t getLevelCount(uint32_t width, uint32_t height);
+        static uint32_t getLevelSize(uint32_t size, uint32_t level, uint32_t levelCount);
+
+    private:
+        void computePreviewDistribution(const MandelbrotCpuEngine::View& view, uint32_t levelCount, std::vector<float>& distribution) const;
+
+        Settings mSettings;
+        MandelbrotCpuEngine mEngine;
+        std::unique_ptr<TileScheduler> mpScheduler;
+    };
+}
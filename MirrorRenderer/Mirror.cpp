@@ -35,11 +35,7 @@ namespace Falcor::Tutorial
     {
         mpCamera->setPosition(transform.getTranslation());
 
-        const auto& inverseTranspose4by4 = transpose(inverse(transform.getMatrix()));
-        const rmcv::mat3& inverseTranspose = inverseTranspose4by4;
-
-        const float3& surfaceNormal = inverseTranspose * float3(0, 1, 0);
-        mSurfaceNormal = normalize(surfaceNormal);
+        mSurfaceNormal = getSurfaceNormal(transform);
 
         mpCamera->setAspectRatio((transform.getScaling().x * mQuadSize.x )/ (transform.getScaling().z * mQuadSize.y));
 
@@ -72,12 +68,26 @@ namespace Falcor::Tutorial
 
     void RenderToTextureMirror::setViewAngle(const float3& observerPos)
     {
-        float3 inVector = normalize(mpCamera->getPosition() - observerPos);
-        mReflectionVector = inVector - 2 * dot(inVector, mSurfaceNormal) * mSurfaceNormal;
+        mReflectionVector = getReflectionVector(mpCamera->getPosition(), observerPos, mSurfaceNormal);
         mpCamera->setTarget(mReflectionVector);
         mObserverPos = observerPos;
     }
 
+    float3 RenderToTextureMirror::getReflectionVector(const float3& mirrorPos, const float3& observerPos, const float3& surfaceNormal)
+    {
+        float3 inVector = normalize(mirrorPos - observerPos);
+        return inVector - 2 * dot(inVector, surfaceNormal) * surfaceNormal;
+    }
+
+    float3 RenderToTextureMirror::getSurfaceNormal(const Transform& transform)
+    {
+        const auto& inverseTranspose4by4 = transpose(inverse(transform.getMatrix()));
+        const rmcv::mat3& inverseTranspose = inverseTranspose4by4;
+
+        const float3& surfaceNormal = inverseTranspose * float3(0, 1, 0);
+        return normalize(surfaceNormal);
+    }
+
     void RenderToTextureMirror::clearMirror(RenderContext* context, const float4& clearCorlor) const
     {
         context->clearFbo(mpFbo.get(), clearCorlor, 1.0f, 0, FboAttachmentType::All);
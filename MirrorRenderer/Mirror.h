@@ -17,6 +17,10 @@ namespace Falcor::Tutorial
         FlipTextureAxis getTextureFlipAxis() override { return Y; }
 
         void setViewAngle(const float3& observerPos);
+        // where the mirror's camera looks for an observer at observerPos
+        static float3 getReflectionVector(const float3& mirrorPos, const float3& observerPos, const float3& surfaceNormal);
+        // normal of the quad after transform, the quad itself faces +y
+        static float3 getSurfaceNormal(const Transform& transform);
         void clearMirror(RenderContext* context, const float4& clearCorlor) const;
 
         Fbo::SharedPtr getFbo() const { return mpFbo; }
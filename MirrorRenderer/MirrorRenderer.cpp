@@ -64,10 +64,7 @@ namespace Falcor::Tutorial
         buildScene();
 
         mpObserver = std::make_shared<FpsObserver>(TriangleMesh::createFromFile("C:/Users/Jancsik/Documents/suzanne.obj"), mpDevice.get(), "Player");
-        Transform observerTransform;
-        observerTransform.setTranslation({0, 0, -15});
-        observerTransform.setScaling({00.3, 0.3, 0.3});
-        mpObserver->setTransform(observerTransform);
+        mpObserver->setTransform(MirrorScene::getObserverTransform());
         mpObserver->update();
         mObjects.push_back(mpObserver);
     }
@@ -208,23 +205,19 @@ namespace Falcor::Tutorial
     void MirrorRenderer::buildScene()
     {
         const auto floor = std::make_shared<Object>(TriangleMesh::createQuad({100, 100}), mpDevice.get(), "floor");
-        Transform floorTransform;
-        floorTransform.setTranslation({0, -3.5, 0});
-        floor->setTransform(floorTransform);
+        floor->setTransform(MirrorScene::getFloorTransform());
         floor->setAmbient({0.8f, 0.52f, 0.247f});
         floor->setDiffuse({0.8f, 0.52f, 0.247f});
         floor->setSpecular({0, 0, 0});
         mObjects.push_back(floor);
 
-        for (uint32_t i = 0; i < 20; i++)
+        for (uint32_t i = 0; i < MirrorScene::kShapeCount; i++)
         {
             const auto pMesh = i % 2 == 0 ? TriangleMesh::createCube({0.5, 0.5, 0.5}) : TriangleMesh::createSphere(0.25);
             mObjects.push_back(std::make_shared<Object>(pMesh, mpDevice.get(), "cube" + std::to_string(i)));
-            Transform t;
-            t.setTranslation({cos(2 * (i / M_PI)) * 3, -3 + i * (1.f / 2), sin(2 * (i / M_PI)) * 3 - 7});
 
-            mObjects[i + 2]->setTransform(t);
-            mObjects[i + 2]->setAmbient({static_cast<float>(i) * 0.01, static_cast<float>(i) * 0.03, static_cast<float>(i) * 0.04});
+            mObjects[i + 2]->setTransform(MirrorScene::getShapeTransform(i));
+            mObjects[i + 2]->setAmbient(MirrorScene::getShapeAmbient(i));
         }
     }
 }
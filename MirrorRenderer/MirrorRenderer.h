@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Mirror.h"
+#include "MirrorScene.h"
 #include "Observer.h"
 #include "Core/SampleApp.h"
 #include "RenderGraph/BasePasses/FullScreenPass.h"
@@ -41,10 +42,7 @@ namespace Falcor::Tutorial
         explicit MirrorRenderer(const SampleAppConfig& config)
             : SampleApp(config), mpMirrorObj(std::make_shared<RenderToTextureMirror>(float2(3, 3), getDevice().get(), "main mirror"))
         {
-            Transform t;
-            t.setRotationEuler({-1.57079633, 0, 0});
-            t.setScaling({2, 1, 1});
-            mpMirrorObj->setTransform(t);
+            mpMirrorObj->setTransform(MirrorScene::getMirrorTransform());
             mObjects.push_back(mpMirrorObj);
         }
 
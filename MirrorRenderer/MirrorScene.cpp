@@ -0,0 +1,41 @@
+#include "MirrorScene.h"
+
+#include <cmath>
+
+namespace Falcor::Tutorial
+{
+    Transform MirrorScene::getMirrorTransform()
+    {
+        Transform t;
+        t.setRotationEuler({-1.57079633, 0, 0});
+        t.setScaling({2, 1, 1});
+        return t;
+    }
+
+    Transform MirrorScene::getFloorTransform()
+    {
+        Transform t;
+        t.setTranslation({0, -3.5, 0});
+        return t;
+    }
+
+    Transform MirrorScene::getShapeTransform(const uint32_t index)
+    {
+        Transform t;
+        t.setTranslation({cos(2 * (index / M_PI)) * 3, -3 + index * (1.f / 2), sin(2 * (index / M_PI)) * 3 - 7});
+        return t;
+    }
+
+    float3 MirrorScene::getShapeAmbient(const uint32_t index)
+    {
+        return {static_cast<float>(index) * 0.01f, static_cast<float>(index) * 0.03f, static_cast<float>(index) * 0.04f};
+    }
+
+    Transform MirrorScene::getObserverTransform()
+    {
+        Transform t;
+        t.setTranslation({0, 0, -15});
+        t.setScaling({0.3, 0.3, 0.3});
+        return t;
+    }
+}
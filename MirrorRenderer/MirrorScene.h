@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Scene/Transform.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * where everything of the mirror scene is placed, so the renderer and the benchmarks build the same scene:
+     * a floor, the mirror lying on its back, a spiral of cubes and spheres next to it and the observer in front.
+     */
+    class MirrorScene
+    {
+    public:
+        // cubes and spheres alternate, starting with a cube
+        static constexpr uint32_t kShapeCount = 20;
+
+        MirrorScene() = delete;
+
+        static Transform getMirrorTransform();
+        static Transform getFloorTransform();
+        static Transform getShapeTransform(uint32_t index);
+        static float3 getShapeAmbient(uint32_t index);
+        static Transform getObserverTransform();
+    };
+}
@@ -1,5 +1,7 @@
 #include "Object.h"
 
+#include <limits>
+
 namespace Falcor::Tutorial
 {
     Object::Object(TriangleMesh::SharedPtr mesh, Device* device, const std::string_view name)
@@ -118,11 +120,25 @@ namespace Falcor::Tutorial
         if (mpMesh->getVertices().empty() || mpMesh->getIndices().empty())
             return false;
 
-        const ResourceBindFlags ibBindFlags =
-            Resource::BindFlags::Index | ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        const Buffer::SharedPtr pIndexBuffer = Buffer::createStructured(
-            mpDevice, sizeof(uint32_t), mpMesh->getIndices().size(), ibBindFlags, Buffer::CpuAccess::None, mpMesh->getIndices().data()
-        );
+        // the built-in shapes are small, so their indices usually fit into 16 bits, which halves the index buffer
+        const bool use16BitIndices = mpMesh->getVertices().size() <= std::numeric_limits<uint16_t>::max() + size_t(1);
+        Buffer::SharedPtr pIndexBuffer;
+
+        if (use16BitIndices)
+        {
+            const std::vector<uint16_t> indices(mpMesh->getIndices().begin(), mpMesh->getIndices().end());
+            pIndexBuffer = Buffer::create(
+                mpDevice, indices.size() * sizeof(uint16_t), Resource::BindFlags::Index, Buffer::CpuAccess::None, indices.data()
+            );
+        }
+        else
+        {
+            const ResourceBindFlags ibBindFlags =
+                Resource::BindFlags::Index | ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+            pIndexBuffer = Buffer::createStructured(
+                mpDevice, sizeof(uint32_t), mpMesh->getIndices().size(), ibBindFlags, Buffer::CpuAccess::None, mpMesh->getIndices().data()
+            );
+        }
 
         const ResourceBindFlags vbBindFlags =
             Resource::BindFlags::Vertex | ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
@@ -139,7 +155,9 @@ namespace Falcor::Tutorial
         pLayout->addBufferLayout(0, pBufLayout);
 
         const Vao::BufferVec buffers{pVertexBuffer};
-        mpVao = Vao::create(Vao::Topology::TriangleList, pLayout, buffers, pIndexBuffer, ResourceFormat::R32Uint);
+        mpVao = Vao::create(
+            Vao::Topology::TriangleList, pLayout, buffers, pIndexBuffer, use16BitIndices ? ResourceFormat::R16Uint : ResourceFormat::R32Uint
+        );
 
         return true;
     }
@@ -0,0 +1,100 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Falcor::Tutorial
+{
+#if defined(_WIN32)
+
+    MappedFile::SharedPtr MappedFile::create(const std::filesystem::path& path)
+    {
+        SharedPtr pFile(new MappedFile());
+
+        pFile->mFileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (pFile->mFileHandle == INVALID_HANDLE_VALUE)
+        {
+            pFile->mFileHandle = nullptr;
+            return nullptr;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(pFile->mFileHandle, &size))
+            return nullptr;
+
+        pFile->mSize = static_cast<size_t>(size.QuadPart);
+
+        // an empty file can't be mapped, but it is still a valid (empty) file
+        if (pFile->mSize == 0)
+            return pFile;
+
+        pFile->mMappingHandle = CreateFileMappingW(pFile->mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (pFile->mMappingHandle == nullptr)
+            return nullptr;
+
+        pFile->mpData = static_cast<const char*>(MapViewOfFile(pFile->mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (pFile->mpData == nullptr)
+            return nullptr;
+
+        return pFile;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (mpData != nullptr)
+            UnmapViewOfFile(mpData);
+        if (mMappingHandle != nullptr)
+            CloseHandle(mMappingHandle);
+        if (mFileHandle != nullptr)
+            CloseHandle(mFileHandle);
+    }
+
+#else
+
+    MappedFile::SharedPtr MappedFile::create(const std::filesystem::path& path)
+    {
+        SharedPtr pFile(new MappedFile());
+
+        pFile->mFileDescriptor = open(path.c_str(), O_RDONLY);
+        if (pFile->mFileDescriptor < 0)
+            return nullptr;
+
+        struct stat fileStat;
+        if (fstat(pFile->mFileDescriptor, &fileStat) != 0)
+            return nullptr;
+
+        pFile->mSize = static_cast<size_t>(fileStat.st_size);
+
+        // an empty file can't be mapped, but it is still a valid (empty) file
+        if (pFile->mSize == 0)
+            return pFile;
+
+        void* pData = mmap(nullptr, pFile->mSize, PROT_READ, MAP_PRIVATE, pFile->mFileDescriptor, 0);
+        if (pData == MAP_FAILED)
+            return nullptr;
+
+        // the whole file is read front to back
+        madvise(pData, pFile->mSize, MADV_SEQUENTIAL);
+
+        pFile->mpData = static_cast<const char*>(pData);
+        return pFile;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (mpData != nullptr)
+            munmap(const_cast<char*>(mpData), mSize);
+        if (mFileDescriptor >= 0)
+            close(mFileDescriptor);
+    }
+
+#endif
+}
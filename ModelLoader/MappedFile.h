@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * read-only memory mapping of a whole file.
+     * the operating system pages the file in on demand, so parsing it directly from data() needs no copy
+     * into a std::string and no per-line allocations.
+     */
+    class MappedFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<MappedFile>;
+
+        // returns nullptr if the file can't be opened or mapped
+        static SharedPtr create(const std::filesystem::path& path);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        const char* getData() const { return mpData; }
+        size_t getSize() const { return mSize; }
+        std::string_view getView() const { return {mpData, mSize}; }
+
+    private:
+        MappedFile() = default;
+
+        const char* mpData = nullptr;
+        size_t mSize = 0;
+
+#if defined(_WIN32)
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+#else
+        int mFileDescriptor = -1;
+#endif
+    };
+}
@@ -0,0 +1,134 @@
+#include "MeshCache.h"
+
+#include "Utils/Logger.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace Falcor::Tutorial
+{
+    std::filesystem::path MeshCache::getCachePath(const std::filesystem::path& sourcePath)
+    {
+        std::filesystem::path cachePath = sourcePath;
+        cachePath += ".meshcache";
+        return cachePath;
+    }
+
+    MeshCache::SharedPtr MeshCache::open(const std::filesystem::path& sourcePath, const uint32_t optimizationFlags)
+    {
+        Header sourceInfo{};
+        if (!fillSourceInfo(sourcePath, sourceInfo))
+            return nullptr;
+
+        const MappedFile::SharedPtr pFile = MappedFile::create(getCachePath(sourcePath));
+        if (pFile == nullptr || pFile->getSize() < sizeof(Header))
+            return nullptr;
+
+        Header header;
+        std::memcpy(&header, pFile->getData(), sizeof(Header));
+
+        if (header.magic != kMagic || header.version != kVersion || header.vertexSize != sizeof(TriangleMesh::Vertex))
+            return nullptr;
+
+        if (header.sourceSize != sourceInfo.sourceSize || header.sourceWriteTime != sourceInfo.sourceWriteTime)
+            return nullptr;
+
+        if (header.optimizationFlags != optimizationFlags)
+            return nullptr;
+
+        // a truncated file (e.g. the disk was full while writing) is just as stale.
+        // the counts come from the file, they are checked against the bytes there are before they are multiplied, so they can't wrap
+        const uint64_t bodySize = pFile->getSize() - sizeof(Header);
+        if (header.vertexCount > bodySize / sizeof(TriangleMesh::Vertex))
+            return nullptr;
+
+        const uint64_t indexBytes = bodySize - header.vertexCount * sizeof(TriangleMesh::Vertex);
+        if (header.indexCount > indexBytes / sizeof(uint32_t) || header.indexCount * sizeof(uint32_t) != indexBytes)
+            return nullptr;
+
+        SharedPtr pCache(new MeshCache());
+        pCache->mpFile = pFile;
+        pCache->mVertexCount = header.vertexCount;
+        pCache->mIndexCount = header.indexCount;
+        pCache->mpVertices = reinterpret_cast<const TriangleMesh::Vertex*>(pFile->getData() + sizeof(Header));
+        pCache->mpIndices = reinterpret_cast<const uint32_t*>(pCache->mpVertices + header.vertexCount);
+        return pCache;
+    }
+
+    MeshCache::SharedPtr MeshCache::create(const std::filesystem::path& sourcePath, TriangleMesh::SharedPtr pMesh, const uint32_t optimizationFlags)
+    {
+        if (pMesh == nullptr)
+            return nullptr;
+
+        SharedPtr pCache(new MeshCache());
+        pCache->mpMesh = std::move(pMesh);
+        pCache->mVertexCount = pCache->mpMesh->getVertices().size();
+        pCache->mIndexCount = pCache->mpMesh->getIndices().size();
+        pCache->mpVertices = pCache->mpMesh->getVertices().data();
+        pCache->mpIndices = pCache->mpMesh->getIndices().data();
+
+        Header header{};
+        if (!fillSourceInfo(sourcePath, header))
+            return pCache;
+
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.vertexSize = sizeof(TriangleMesh::Vertex);
+        header.optimizationFlags = optimizationFlags;
+        header.vertexCount = pCache->mVertexCount;
+        header.indexCount = pCache->mIndexCount;
+
+        // writing to a temporary file first, so a half written cache is never picked up by open()
+        const std::filesystem::path cachePath = getCachePath(sourcePath);
+        std::filesystem::path tempPath = cachePath;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+            if (!outFile)
+            {
+                logWarning("Can't write mesh cache '{}'.", cachePath.string());
+                return pCache;
+            }
+
+            outFile.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            outFile.write(reinterpret_cast<const char*>(pCache->mpVertices), pCache->mVertexCount * sizeof(TriangleMesh::Vertex));
+            outFile.write(reinterpret_cast<const char*>(pCache->mpIndices), pCache->mIndexCount * sizeof(uint32_t));
+
+            if (!outFile)
+            {
+                logWarning("Can't write mesh cache '{}'.", cachePath.string());
+                outFile.close();
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return pCache;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            logWarning("Can't write mesh cache '{}': {}", cachePath.string(), ec.message());
+            std::filesystem::remove(tempPath, ec);
+        }
+
+        return pCache;
+    }
+
+    bool MeshCache::fillSourceInfo(const std::filesystem::path& sourcePath, Header& header)
+    {
+        std::error_code ec;
+
+        header.sourceSize = std::filesystem::file_size(sourcePath, ec);
+        if (ec)
+            return false;
+
+        const auto writeTime = std::filesystem::last_write_time(sourcePath, ec);
+        if (ec)
+            return false;
+
+        header.sourceWriteTime = writeTime.time_since_epoch().count();
+        return true;
+    }
+}
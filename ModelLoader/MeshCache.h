@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * binary cache of a loaded mesh, stored next to the source file (model.obj -> model.obj.meshcache).
+     * file layout:
+     *   Header
+     *   TriangleMesh::Vertex[vertexCount]
+     *   uint32_t[indexCount]
+     * the cache is considered stale if the size or the last write time of the source file changed,
+     * or if it was written with different optimization flags (MeshOptimizer::getOptionFlags) than requested.
+     * a valid cache is memory mapped, so its arrays can be uploaded to the gpu without any parsing or copying.
+     */
+    class MeshCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<MeshCache>;
+
+        static std::filesystem::path getCachePath(const std::filesystem::path& sourcePath);
+
+        // maps the cache of sourcePath, returns nullptr if there is no valid, up to date cache
+        static SharedPtr open(const std::filesystem::path& sourcePath, uint32_t optimizationFlags = 0);
+
+        // writes the cache of sourcePath, the returned cache keeps the mesh in memory, so it's usable even if writing failed
+        static SharedPtr create(const std::filesystem::path& sourcePath, TriangleMesh::SharedPtr pMesh, uint32_t optimizationFlags = 0);
+
+        const TriangleMesh::Vertex* getVertices() const { return mpVertices; }
+        size_t getVertexCount() const { return mVertexCount; }
+        const uint32_t* getIndices() const { return mpIndices; }
+        size_t getIndexCount() const { return mIndexCount; }
+
+    private:
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vertexSize;
+            uint32_t optimizationFlags; // 0 for unoptimized meshes, that's what older caches have here too
+            uint64_t sourceSize;
+            int64_t sourceWriteTime;
+            uint64_t vertexCount;
+            uint64_t indexCount;
+            uint64_t padding[2];
+        };
+
+        // keeps the vertex array 64 byte aligned in the mapped file
+        static_assert(sizeof(Header) == 64);
+
+        static constexpr uint32_t kMagic = 0x48434D46; // "FMCH"
+        // has to be increased whenever the loader produces different meshes for the same file
+        static constexpr uint32_t kVersion = 1;
+
+        static bool fillSourceInfo(const std::filesystem::path& sourcePath, Header& header);
+
+        MeshCache() = default;
+
+        MappedFile::SharedPtr mpFile;
+        TriangleMesh::SharedPtr mpMesh;
+
+        const TriangleMesh::Vertex* mpVertices = nullptr;
+        size_t mVertexCount = 0;
+        const uint32_t* mpIndices = nullptr;
+        size_t mIndexCount = 0;
+    };
+}
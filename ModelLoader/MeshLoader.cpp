@@ -1,10 +1,148 @@
 #include "MeshLoader.h"
+#include "MappedFile.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <thread>
 
 namespace Falcor::Tutorial
 {
+    namespace
+    {
+        bool isBlank(const char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        const char* skipBlanks(const char* pos, const char* end)
+        {
+            while (pos != end && isBlank(*pos))
+                pos++;
+            return pos;
+        }
+
+        const char* findBlank(const char* pos, const char* end)
+        {
+            while (pos != end && !isBlank(*pos))
+                pos++;
+            return pos;
+        }
+
+        // std::from_chars doesn't accept an explicit '+' sign, but operator>> and std::stoi do
+        const char* skipPlusSign(const char* pos, const char* end)
+        {
+            if (pos != end && *pos == '+')
+                pos++;
+            return pos;
+        }
+
+        // on failure value is left untouched and every following read on the line fails too,
+        // just like operator>> on a stream that has its failbit set
+        const char* parseFloat(const char* pos, const char* end, float& value)
+        {
+            pos = skipPlusSign(skipBlanks(pos, end), end);
+            const auto [ptr, ec] = std::from_chars(pos, end, value);
+            return ec == std::errc() ? ptr : end;
+        }
+
+        // chunks smaller than this aren't worth a thread
+        constexpr size_t kMinChunkSize = 1 << 20;
+
+        // progress is only published after this many bytes or corners, so it doesn't cost anything
+        constexpr size_t kProgressGranularity = 1 << 20;
+
+        /*
+         * open addressing (linear probing) hash map from a (position, texCoord, normal) index triple
+         * to the index of the welded vertex. the slots only store the vertex index, the keys live in a
+         * separate array indexed by it, so the table itself stays small and cache friendly.
+         */
+        class VertexWeldTable
+        {
+        public:
+            explicit VertexWeldTable(const size_t expectedVertexCount)
+            {
+                size_t capacity = 16;
+                while (capacity < expectedVertexCount * 2)
+                    capacity *= 2;
+
+                mSlots.assign(capacity, kEmpty);
+                mKeys.reserve(expectedVertexCount);
+            }
+
+            // returns the index of the triple and whether it was just inserted
+            std::pair<uint32_t, bool> insert(const uint32_t position, const uint32_t texCoord, const uint32_t normal)
+            {
+                // keeping the load factor below 1/2, so probe sequences stay short
+                if ((mKeys.size() + 1) * 2 > mSlots.size())
+                    grow();
+
+                const Key key{position, texCoord, normal};
+                size_t slot = hash(key) & (mSlots.size() - 1);
+
+                while (mSlots[slot] != kEmpty)
+                {
+                    if (mKeys[mSlots[slot]] == key)
+                        return {mSlots[slot], false};
+
+                    slot = (slot + 1) & (mSlots.size() - 1);
+                }
+
+                const uint32_t index = static_cast<uint32_t>(mKeys.size());
+                mSlots[slot] = index;
+                mKeys.push_back(key);
+                return {index, true};
+            }
+
+        private:
+            struct Key
+            {
+                uint32_t position;
+                uint32_t texCoord;
+                uint32_t normal;
+
+                bool operator==(const Key& other) const
+                {
+                    return position == other.position && texCoord == other.texCoord && normal == other.normal;
+                }
+            };
+
+            static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+            static size_t hash(const Key& key)
+            {
+                // multiplicative mixing followed by the murmur3 finalizer
+                uint32_t h = key.position * 0x9E3779B1u ^ key.texCoord * 0x85EBCA77u ^ key.normal * 0xC2B2AE3Du;
+                h ^= h >> 16;
+                h *= 0x85EBCA6Bu;
+                h ^= h >> 13;
+                h *= 0xC2B2AE35u;
+                h ^= h >> 16;
+                return h;
+            }
+
+            void grow()
+            {
+                mSlots.assign(mSlots.size() * 2, kEmpty);
+
+                for (uint32_t index = 0; index < mKeys.size(); index++)
+                {
+                    size_t slot = hash(mKeys[index]) & (mSlots.size() - 1);
+                    while (mSlots[slot] != kEmpty)
+                        slot = (slot + 1) & (mSlots.size() - 1);
+
+                    mSlots[slot] = index;
+                }
+            }
+
+            std::vector<uint32_t> mSlots;
+            std::vector<Key> mKeys;
+        };
+    }
+
 
     /*
      * loading data from obj files manually:
@@ -25,47 +163,156 @@ namespace Falcor::Tutorial
      *      'a', 'b' and 'c' are indexed from 1 not from 0 like in c++
      */
 
-    TriangleMesh::SharedPtr MeshLoader::loadMeshFromObjFile(const std::filesystem::path& path)
+    TriangleMesh::SharedPtr MeshLoader::loadMeshFromObjFile(const std::filesystem::path& path, const ParseMode mode, Progress* pProgress)
     {
         if (path.extension().string() != ".obj")
             return nullptr;
 
-        std::ifstream inFile(path);
+        ObjFileData data;
+
+        if (mode == ParseMode::Mapped || mode == ParseMode::Parallel)
+        {
+            const MappedFile::SharedPtr pFile = MappedFile::create(path);
+
+            if (pFile == nullptr)
+                return nullptr;
+
+            ParseProgress progress(pProgress, pFile->getSize());
+
+            if (mode == ParseMode::Parallel)
+                loadRawDataParallel(data, pFile->getView(), progress);
+            else
+                loadRawData(data, pFile->getView(), progress);
+        }
+        else
+        {
+            std::ifstream inFile(path);
+
+            if (!inFile)
+                return nullptr;
+
+            std::error_code ec;
+            ParseProgress progress(pProgress, std::filesystem::file_size(path, ec));
+            loadRawData(data, inFile, progress);
+        }
+
+        TriangleMesh::VertexList vertices;
+        TriangleMesh::IndexList indices;
 
-        if (!inFile)
+        if (!createFaces(data, vertices, indices, pProgress))
             return nullptr;
 
-        ObjFileData data;
-        loadRawData(data, inFile);
-        createFaces(data);
+        if (pProgress != nullptr)
+            *pProgress = 1.f;
+
+        return TriangleMesh::create(vertices, indices);
+    }
+
+    MeshCache::SharedPtr MeshLoader::loadMeshThroughCache(
+        const std::filesystem::path& path,
+        const ParseMode mode,
+        Progress* pProgress,
+        const MeshOptimizer::Options* pOptimizerOptions,
+        MeshOptimizer::Report* pOptimizerReport
+    )
+    {
+        if (path.extension().string() != ".obj")
+            return nullptr;
+
+        const uint32_t optimizationFlags = pOptimizerOptions != nullptr ? MeshOptimizer::getOptionFlags(*pOptimizerOptions) : 0;
+
+        if (MeshCache::SharedPtr pCache = MeshCache::open(path, optimizationFlags))
+        {
+            if (pOptimizerReport != nullptr)
+            {
+                // the unoptimized order of an optimized cache is gone
+                *pOptimizerReport = MeshOptimizer::Report();
+                pOptimizerReport->after = MeshOptimizer::analyzeVertexCache(pCache->getIndices(), pCache->getIndexCount(), pCache->getVertexCount());
+                if (optimizationFlags == 0)
+                    pOptimizerReport->before = pOptimizerReport->after;
+            }
+
+            if (pProgress != nullptr)
+                *pProgress = 1.f;
+
+            return pCache;
+        }
 
-        return TriangleMesh::create(data.vertices, data.indices);
+        TriangleMesh::SharedPtr pMesh = loadMeshFromObjFile(path, mode, pProgress);
+
+        const MeshOptimizer::Report report = MeshOptimizer::optimize(pMesh, pOptimizerOptions != nullptr ? *pOptimizerOptions : MeshOptimizer::Options::none());
+        if (pOptimizerReport != nullptr)
+            *pOptimizerReport = report;
+
+        return MeshCache::create(path, pMesh, optimizationFlags);
     }
 
-    void MeshLoader::createFaces(ObjFileData& data)
+    void MeshLoader::ParseProgress::addParsedBytes(const size_t bytes)
     {
-        std::vector<uint32_t> finalIndices;
-        uint32_t maxVertexIndex = 0;
+        if (mpProgress == nullptr || mTotalBytes == 0)
+            return;
+
+        const size_t parsedBytes = mParsedBytes.fetch_add(bytes) + bytes;
+        *mpProgress = kParseProgressShare * std::min(1.f, static_cast<float>(parsedBytes) / static_cast<float>(mTotalBytes));
+    }
+
+    /*
+     * the same position can be used with different texture coordinates or normals (uv seams, hard edges),
+     * so a vertex is identified by its whole index triple. every unique triple becomes one vertex,
+     * and the index buffer only refers to those.
+     */
+    bool MeshLoader::createFaces(const ObjFileData& data, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, Progress* pProgress)
+    {
+        // every triangle needs 3 corners with 3 indices each
+        if (data.indices.size() % 9 != 0)
+            return false;
+
+        const size_t cornerCount = data.indices.size() / 3;
+
+        // closed meshes have roughly as many unique triples as positions
+        VertexWeldTable weldTable(std::max(data.positions.size(), data.normals.size()));
+
+        vertices.clear();
+        vertices.reserve(std::max(data.positions.size(), data.normals.size()));
+        indices.clear();
+        indices.reserve(cornerCount);
+
         for (size_t i = 0; i < data.indices.size(); i += 3)
         {
-            if (data.indices[i] > maxVertexIndex)
-                maxVertexIndex = data.indices[i];
+            if (pProgress != nullptr && i % kProgressGranularity == 0)
+                *pProgress = ParseProgress::kParseProgressShare + (1.f - ParseProgress::kParseProgressShare) * static_cast<float>(i) / static_cast<float>(data.indices.size());
+
+            const uint32_t positionIndex = data.indices[i];
+            const uint32_t texCoordIndex = data.indices[i + 1];
+            const uint32_t normalIndex = data.indices[i + 2];
+
+            if (positionIndex >= data.positions.size() || texCoordIndex >= data.texCoords.size() || normalIndex >= data.normals.size())
+                return false;
+
+            const auto [vertexIndex, isNew] = weldTable.insert(positionIndex, texCoordIndex, normalIndex);
+
+            if (isNew)
+                vertices.push_back({data.positions[positionIndex], data.normals[normalIndex], data.texCoords[texCoordIndex]});
 
-            finalIndices.push_back(data.indices[i]);
-            data.vertices[data.indices[i]].texCoord = data.vertices[data.indices[i + 1] + data.vertexCount].texCoord;
-            data.vertices[data.indices[i]].normal = data.vertices[data.indices[i + 2] + data.texCoordCount + data.vertexCount].normal;
+            indices.push_back(vertexIndex);
         }
 
-        data.indices = finalIndices;
+        return true;
     }
 
-    void MeshLoader::loadRawData(ObjFileData& data, std::ifstream& inFile)
+    void MeshLoader::loadRawData(ObjFileData& data, std::ifstream& inFile, ParseProgress& progress)
     {
         std::string line;
+        size_t unreportedBytes = 0;
 
         while (std::getline(inFile, line))
         {
-            TriangleMesh::Vertex v;
+            unreportedBytes += line.size() + 1;
+            if (unreportedBytes >= kProgressGranularity)
+            {
+                progress.addParsedBytes(unreportedBytes);
+                unreportedBytes = 0;
+            }
 
             std::stringstream ss(line);
             std::string inType;
@@ -74,21 +321,21 @@ namespace Falcor::Tutorial
 
             if (inType == "v")
             {
-                ss >> v.position.x >> v.position.y >> v.position.z;
-                data.vertices.push_back(v);
-                data.vertexCount++;
+                float3 position{};
+                ss >> position.x >> position.y >> position.z;
+                data.positions.push_back(position);
             }
             else if (inType == "vt")
             {
-                ss >> v.texCoord.x >> v.texCoord.y;
-                data.vertices.push_back(v);
-                data.texCoordCount++;
+                float2 texCoord{};
+                ss >> texCoord.x >> texCoord.y;
+                data.texCoords.push_back(texCoord);
             }
             else if (inType == "vn")
             {
-                ss >> v.normal.x >> v.normal.y >> v.normal.z;
-                data.vertices.push_back(v);
-                data.normalCount++;
+                float3 normal{};
+                ss >> normal.x >> normal.y >> normal.z;
+                data.normals.push_back(normal);
             }
             else if (inType == "f")
             {
@@ -120,5 +367,178 @@ namespace Falcor::Tutorial
             }
         }
     }
-}
 
+    /*
+     * same grammar as the stream based loadRawData, but working directly on the mapped file:
+     * lines are found with memchr and numbers are parsed in place, so nothing is allocated per line
+     */
+    void MeshLoader::loadRawData(ObjFileData& data, const std::string_view text, ParseProgress& progress)
+    {
+        const char* pos = text.data();
+        const char* const textEnd = text.data() + text.size();
+        const char* lastReported = pos;
+
+        while (pos < textEnd)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', textEnd - pos));
+            if (lineEnd == nullptr)
+                lineEnd = textEnd;
+
+            if (static_cast<size_t>(pos - lastReported) >= kProgressGranularity)
+            {
+                progress.addParsedBytes(pos - lastReported);
+                lastReported = pos;
+            }
+
+            const char* typeBegin = skipBlanks(pos, lineEnd);
+            const char* typeEnd = findBlank(typeBegin, lineEnd);
+            const std::string_view inType(typeBegin, typeEnd - typeBegin);
+
+            if (inType == "v")
+            {
+                float3 position{};
+                const char* p = parseFloat(typeEnd, lineEnd, position.x);
+                p = parseFloat(p, lineEnd, position.y);
+                parseFloat(p, lineEnd, position.z);
+                data.positions.push_back(position);
+            }
+            else if (inType == "vt")
+            {
+                float2 texCoord{};
+                const char* p = parseFloat(typeEnd, lineEnd, texCoord.x);
+                parseFloat(p, lineEnd, texCoord.y);
+                data.texCoords.push_back(texCoord);
+            }
+            else if (inType == "vn")
+            {
+                float3 normal{};
+                const char* p = parseFloat(typeEnd, lineEnd, normal.x);
+                p = parseFloat(p, lineEnd, normal.y);
+                parseFloat(p, lineEnd, normal.z);
+                data.normals.push_back(normal);
+            }
+            else if (inType == "f")
+            {
+                const char* cornerBegin = skipBlanks(typeEnd, lineEnd);
+
+                while (cornerBegin != lineEnd)
+                {
+                    const char* cornerEnd = findBlank(cornerBegin, lineEnd);
+
+                    // position, texCoord and normal index separated by '/', empty ones are skipped
+                    const char* p = cornerBegin;
+                    for (int component = 0; component < 3 && p < cornerEnd; component++)
+                    {
+                        const char* slash = std::find(p, cornerEnd, '/');
+                        int index = 0;
+                        const char* digits = skipPlusSign(p, slash);
+                        if (std::from_chars(digits, slash, index).ec == std::errc())
+                            data.indices.push_back(index - 1);
+
+                        p = slash + 1;
+                    }
+
+                    cornerBegin = skipBlanks(cornerEnd, lineEnd);
+                }
+            }
+
+            pos = lineEnd + 1;
+        }
+    }
+
+    /*
+     * the file is cut into one chunk per hardware thread, every cut is moved forward to the next line break,
+     * so no record is split in two. the chunks are parsed independently with the mapped parser.
+     * obj indices are global (counted from the start of the file), and they are stored as they are read,
+     * so simply concatenating the chunk results in file order gives the same data as a serial parse.
+     */
+    void MeshLoader::loadRawDataParallel(ObjFileData& data, const std::string_view text, ParseProgress& progress)
+    {
+        const size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        const size_t chunkCount = std::clamp<size_t>(text.size() / kMinChunkSize, 1, threadCount);
+
+        if (chunkCount == 1)
+        {
+            loadRawData(data, text, progress);
+            return;
+        }
+
+        std::vector<std::string_view> chunkTexts;
+        chunkTexts.reserve(chunkCount);
+
+        size_t chunkBegin = 0;
+        for (size_t i = 1; i <= chunkCount && chunkBegin < text.size(); i++)
+        {
+            size_t chunkEnd = text.size();
+            if (i < chunkCount)
+            {
+                chunkEnd = text.find('\n', std::max(chunkBegin, text.size() * i / chunkCount));
+                chunkEnd = chunkEnd == std::string_view::npos ? text.size() : chunkEnd + 1;
+            }
+
+            chunkTexts.push_back(text.substr(chunkBegin, chunkEnd - chunkBegin));
+            chunkBegin = chunkEnd;
+        }
+
+        std::vector<ObjFileData> chunks(chunkTexts.size());
+        std::vector<std::thread> workers;
+        workers.reserve(chunkTexts.size() - 1);
+
+        for (size_t i = 1; i < chunkTexts.size(); i++)
+            workers.emplace_back([&chunks, &chunkTexts, &progress, i]() { loadRawData(chunks[i], chunkTexts[i], progress); });
+
+        // the calling thread takes the first chunk instead of just waiting
+        loadRawData(chunks[0], chunkTexts[0], progress);
+
+        for (auto& worker : workers)
+            worker.join();
+
+        mergeChunks(data, chunks);
+    }
+
+    void MeshLoader::mergeChunks(ObjFileData& data, const std::vector<ObjFileData>& chunks)
+    {
+        // exclusive prefix sums give every chunk its place in the final arrays
+        struct Offsets
+        {
+            size_t positions = 0;
+            size_t texCoords = 0;
+            size_t normals = 0;
+            size_t indices = 0;
+        };
+
+        std::vector<Offsets> offsets(chunks.size() + 1);
+
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size();
+            offsets[i + 1].texCoords = offsets[i].texCoords + chunks[i].texCoords.size();
+            offsets[i + 1].normals = offsets[i].normals + chunks[i].normals.size();
+            offsets[i + 1].indices = offsets[i].indices + chunks[i].indices.size();
+        }
+
+        data.positions.resize(offsets.back().positions);
+        data.texCoords.resize(offsets.back().texCoords);
+        data.normals.resize(offsets.back().normals);
+        data.indices.resize(offsets.back().indices);
+
+        // copying is memory bound, but it still scales with a few threads
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size());
+
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                const ObjFileData& chunk = chunks[i];
+                std::copy(chunk.positions.begin(), chunk.positions.end(), data.positions.begin() + offsets[i].positions);
+                std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), data.texCoords.begin() + offsets[i].texCoords);
+                std::copy(chunk.normals.begin(), chunk.normals.end(), data.normals.begin() + offsets[i].normals);
+                std::copy(chunk.indices.begin(), chunk.indices.end(), data.indices.begin() + offsets[i].indices);
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+}
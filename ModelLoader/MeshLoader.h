@@ -1,28 +1,78 @@
 #pragma once
 
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
 #include "Scene/TriangleMesh.h"
 
+#include <atomic>
+#include <string_view>
+
 namespace Falcor::Tutorial
 {
     class MeshLoader
     {
     public:
+        // every parse mode produces exactly the same mesh, they only differ in speed
+        enum class ParseMode : uint32_t
+        {
+            Stream,     // std::getline + std::stringstream, the straightforward way
+            Mapped,     // memory mapped file, numbers are parsed in place with std::from_chars
+            Parallel    // memory mapped file split into chunks at line boundaries, chunks are parsed on worker threads
+        };
+
+        // load progress in [0, 1], written by the loader, can be polled from any thread
+        using Progress = std::atomic<float>;
+
         MeshLoader() = delete;
 
-        static TriangleMesh::SharedPtr loadMeshFromObjFile(const std::filesystem::path& path);
+        static TriangleMesh::SharedPtr loadMeshFromObjFile(const std::filesystem::path& path, ParseMode mode = ParseMode::Stream, Progress* pProgress = nullptr);
+
+        // maps the binary cache of the file if it's up to date, otherwise parses the file and (re)writes its cache.
+        // an optimized mesh is cached separately from the unoptimized one, the report's before statistics are only
+        // filled if the file was parsed, a cache hit has nothing to compare to
+        static MeshCache::SharedPtr loadMeshThroughCache(
+            const std::filesystem::path& path,
+            ParseMode mode = ParseMode::Stream,
+            Progress* pProgress = nullptr,
+            const MeshOptimizer::Options* pOptimizerOptions = nullptr,
+            MeshOptimizer::Report* pOptimizerReport = nullptr
+        );
 
     private:
+        // staging data, exactly as it is in the file, none of it is uploaded to the gpu
         struct ObjFileData
         {
-            TriangleMesh::VertexList vertices;
+            std::vector<float3> positions;
+            std::vector<float2> texCoords;
+            std::vector<float3> normals;
+
+            // (position, texCoord, normal) index triple for every corner of every face, starting from 0
             TriangleMesh::IndexList indices;
+        };
+
+        // turns parsed bytes into progress, parsing is the first kParseProgressShare part of a load
+        class ParseProgress
+        {
+        public:
+            ParseProgress(Progress* pProgress, size_t totalBytes) : mpProgress(pProgress), mTotalBytes(totalBytes) {}
+
+            // thread safe, the parallel parser reports from every worker
+            void addParsedBytes(size_t bytes);
+
+            static constexpr float kParseProgressShare = 0.8f;
 
-            size_t vertexCount = 0;
-            size_t texCoordCount = 0;
-            size_t normalCount = 0;
+        private:
+            Progress* mpProgress;
+            size_t mTotalBytes;
+            std::atomic<size_t> mParsedBytes{0};
         };
 
-        static void createFaces(ObjFileData& data);
-        static void loadRawData(ObjFileData& data, std::ifstream& inFile);
+        // welds the index triples into one vertex per unique triple, returns false if the face data is invalid
+        static bool createFaces(const ObjFileData& data, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, Progress* pProgress);
+        static void loadRawData(ObjFileData& data, std::ifstream& inFile, ParseProgress& progress);
+        static void loadRawData(ObjFileData& data, std::string_view text, ParseProgress& progress);
+        static void loadRawDataParallel(ObjFileData& data, std::string_view text, ParseProgress& progress);
+        static void mergeChunks(ObjFileData& data, const std::vector<ObjFileData>& chunks);
     };
 }
@@ -0,0 +1,455 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        // the cache size Forsyth's scoring is tuned for, it works well for smaller real caches too
+        constexpr int kForsythCacheSize = 32;
+        constexpr uint32_t kValenceTableSize = 64;
+
+        // a hard cluster shorter than this isn't split any further by the overdraw optimizer
+        constexpr size_t kMinSoftClusterSize = 16;
+
+        struct ForsythScores
+        {
+            ForsythScores()
+            {
+                for (int i = 0; i < kForsythCacheSize; i++)
+                {
+                    // the last triangle's vertices get a fixed score, so the next triangle doesn't simply continue a strip
+                    if (i < 3)
+                        cache[i] = 0.75f;
+                    else
+                        cache[i] = std::pow(1.f - static_cast<float>(i - 3) / static_cast<float>(kForsythCacheSize - 3), 1.5f);
+                }
+
+                // vertices with few remaining triangles are boosted, so they are finished and don't linger
+                valence[0] = 0.f;
+                for (uint32_t i = 1; i < kValenceTableSize; i++)
+                    valence[i] = 2.f * std::pow(static_cast<float>(i), -0.5f);
+            }
+
+            float get(const int cachePosition, const uint32_t remainingValence) const
+            {
+                if (remainingValence == 0)
+                    return -1.f;
+
+                const float valenceScore = remainingValence < kValenceTableSize ? valence[remainingValence] : 2.f * std::pow(static_cast<float>(remainingValence), -0.5f);
+                const float cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.f;
+                return cacheScore + valenceScore;
+            }
+
+            std::array<float, kForsythCacheSize> cache;
+            std::array<float, kValenceTableSize> valence;
+        };
+
+        float3 getTriangleNormal(const TriangleMesh::VertexList& vertices, const uint32_t* pTriangle)
+        {
+            const float3& p0 = vertices[pTriangle[0]].position;
+            const float3& p1 = vertices[pTriangle[1]].position;
+            const float3& p2 = vertices[pTriangle[2]].position;
+
+            // length is twice the area of the triangle, so summing these gives area weighted averages
+            return cross(p1 - p0, p2 - p0);
+        }
+
+        float3 getTriangleCentroid(const TriangleMesh::VertexList& vertices, const uint32_t* pTriangle)
+        {
+            return (vertices[pTriangle[0]].position + vertices[pTriangle[1]].position + vertices[pTriangle[2]].position) / 3.f;
+        }
+    }
+
+    MeshOptimizer::Report MeshOptimizer::optimize(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, const Options& options)
+    {
+        Report report;
+        report.before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+        if (options.optimizeVertexCache)
+            optimizeVertexCache(indices, vertices.size());
+
+        if (options.optimizeOverdraw)
+            optimizeOverdraw(indices, vertices, options.overdrawThreshold);
+
+        if (options.optimizeVertexFetch)
+            optimizeVertexFetch(vertices, indices);
+
+        report.after = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+        return report;
+    }
+
+    MeshOptimizer::Report MeshOptimizer::optimize(TriangleMesh::SharedPtr& pMesh, const Options& options)
+    {
+        if (pMesh == nullptr)
+            return {};
+
+        // nothing to do, the mesh isn't copied just to be measured
+        if (getOptionFlags(options) == 0)
+        {
+            Report report;
+            report.before = analyzeVertexCache(pMesh->getIndices().data(), pMesh->getIndices().size(), pMesh->getVertices().size());
+            report.after = report.before;
+            return report;
+        }
+
+        TriangleMesh::VertexList vertices = pMesh->getVertices();
+        TriangleMesh::IndexList indices = pMesh->getIndices();
+
+        const Report report = optimize(vertices, indices, options);
+        pMesh = TriangleMesh::create(vertices, indices);
+        return report;
+    }
+
+    /*
+     * Tom Forsyth: Linear-Speed Vertex Cache Optimisation.
+     * greedily emits the triangle with the highest score, the score of a triangle is the sum of the scores of its vertices,
+     * vertices score higher the more recently they were used (position in a simulated lru cache) and the fewer
+     * triangles still use them. only the triangles around the cached vertices change score after an emit,
+     * so every step is bounded by the cache size, not by the mesh size.
+     */
+    void MeshOptimizer::optimizeVertexCache(TriangleMesh::IndexList& indices, const size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        static const ForsythScores scores;
+
+        // vertex -> triangles adjacency in compressed rows
+        std::vector<uint32_t> liveValence(vertexCount, 0);
+        for (const uint32_t index : indices)
+            liveValence[index]++;
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveValence[v];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<int> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            vertexScores[v] = scores.get(-1, liveValence[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<bool> isEmitted(triangleCount, false);
+        for (size_t t = 0; t < triangleCount; t++)
+            triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+        TriangleMesh::IndexList newIndices;
+        newIndices.reserve(indices.size());
+
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> newCache;
+        cache.reserve(kForsythCacheSize + 3);
+        newCache.reserve(kForsythCacheSize + 3);
+
+        // when nothing in the cache has triangles left, none of the remaining triangles has a cached vertex and their
+        // scores only depend on their valences. those only go down, which raises the scores, so the triangles whose
+        // valences changed are pushed to a max heap again before it's searched, and an entry is stale when its
+        // triangle was emitted or its score went up since
+        const auto getUncachedScore = [&](const uint32_t t)
+        {
+            return scores.get(-1, liveValence[indices[t * 3]]) + scores.get(-1, liveValence[indices[t * 3 + 1]]) + scores.get(-1, liveValence[indices[t * 3 + 2]]);
+        };
+        // ties go to the lower triangle like in the cache
+        const auto isLowerPriority = [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b)
+        {
+            return a.first < b.first || (a.first == b.first && a.second > b.second);
+        };
+
+        std::vector<std::pair<float, uint32_t>> fallbackHeap(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+            fallbackHeap[t] = {triangleScores[t], static_cast<uint32_t>(t)};
+        std::make_heap(fallbackHeap.begin(), fallbackHeap.end(), isLowerPriority);
+        std::vector<uint32_t> changedTriangles;
+        std::vector<bool> isChanged(triangleCount, false);
+
+        uint32_t bestTriangle = kInvalidIndex;
+
+        for (size_t emitted = 0; emitted < triangleCount; emitted++)
+        {
+            // nothing in the cache has triangles left, continuing with the best scored triangle that's left
+            if (bestTriangle == kInvalidIndex)
+            {
+                for (const uint32_t t : changedTriangles)
+                {
+                    isChanged[t] = false;
+                    if (!isEmitted[t])
+                    {
+                        fallbackHeap.emplace_back(getUncachedScore(t), t);
+                        std::push_heap(fallbackHeap.begin(), fallbackHeap.end(), isLowerPriority);
+                    }
+                }
+                changedTriangles.clear();
+            }
+
+            while (bestTriangle == kInvalidIndex)
+            {
+                std::pop_heap(fallbackHeap.begin(), fallbackHeap.end(), isLowerPriority);
+                const auto [score, t] = fallbackHeap.back();
+                fallbackHeap.pop_back();
+
+                if (!isEmitted[t] && score == getUncachedScore(t))
+                    bestTriangle = t;
+            }
+
+            const uint32_t* pTriangle = &indices[bestTriangle * 3];
+            isEmitted[bestTriangle] = true;
+            newIndices.insert(newIndices.end(), pTriangle, pTriangle + 3);
+
+            // removing the triangle from the adjacency of its vertices
+            for (int corner = 0; corner < 3; corner++)
+            {
+                const uint32_t v = pTriangle[corner];
+                const uint32_t begin = adjacencyOffsets[v];
+                const uint32_t end = begin + liveValence[v];
+                const auto it = std::find(adjacency.begin() + begin, adjacency.begin() + end, bestTriangle);
+                std::iter_swap(it, adjacency.begin() + end - 1);
+                liveValence[v]--;
+
+                for (uint32_t i = begin; i < begin + liveValence[v]; i++)
+                {
+                    if (!isChanged[adjacency[i]])
+                    {
+                        isChanged[adjacency[i]] = true;
+                        changedTriangles.push_back(adjacency[i]);
+                    }
+                }
+            }
+
+            // the triangle's vertices move to the front of the lru cache
+            newCache.assign(pTriangle, pTriangle + 3);
+            for (const uint32_t v : cache)
+            {
+                if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2])
+                    newCache.push_back(v);
+            }
+            std::swap(cache, newCache);
+
+            for (size_t i = 0; i < cache.size(); i++)
+            {
+                const uint32_t v = cache[i];
+                cachePositions[v] = i < kForsythCacheSize ? static_cast<int>(i) : -1;
+                vertexScores[v] = scores.get(cachePositions[v], liveValence[v]);
+            }
+
+            // only triangles around the cached vertices have new scores
+            bestTriangle = kInvalidIndex;
+            float bestScore = -std::numeric_limits<float>::max();
+
+            for (const uint32_t v : cache)
+            {
+                const uint32_t begin = adjacencyOffsets[v];
+                for (uint32_t i = begin; i < begin + liveValence[v]; i++)
+                {
+                    const uint32_t t = adjacency[i];
+                    const float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                    triangleScores[t] = score;
+
+                    if (score > bestScore || (score == bestScore && t < bestTriangle))
+                    {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            // vertices that fell out of the cache aren't tracked anymore
+            if (cache.size() > kForsythCacheSize)
+                cache.resize(kForsythCacheSize);
+        }
+
+        indices = std::move(newIndices);
+    }
+
+    /*
+     * Sander, Nehab, Barczak: Fast Triangle Reordering for Vertex Locality and Reduced Overdraw (Tipsify).
+     * the cache optimized triangle order is cut into clusters: hard boundaries are where the simulated cache
+     * starts over anyway (all 3 vertices of a triangle miss), soft boundaries split long clusters where their
+     * ACMR is still within threshold times the ACMR of the whole mesh. the clusters are then sorted by how much
+     * they face away from the center of the mesh, those are likely to occlude the rest, so they are drawn first.
+     */
+    void MeshOptimizer::optimizeOverdraw(TriangleMesh::IndexList& indices, const TriangleMesh::VertexList& vertices, const float threshold)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        const float meshAcmr = analyzeVertexCache(indices.data(), indices.size(), vertices.size()).acmr;
+
+        // cluster boundaries, as the index of the first triangle of every cluster
+        std::vector<size_t> clusterStarts;
+        {
+            std::vector<uint32_t> timestamps(vertices.size(), 0);
+            uint32_t time = kSimulatedCacheSize + 1;
+            size_t clusterTriangles = 0;
+            size_t clusterMisses = 0;
+
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                uint32_t misses = 0;
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t v = indices[t * 3 + corner];
+                    if (time - timestamps[v] > kSimulatedCacheSize)
+                    {
+                        timestamps[v] = time++;
+                        misses++;
+                    }
+                }
+
+                const bool isHardBoundary = misses == 3;
+                const bool isSoftBoundary = clusterTriangles >= kMinSoftClusterSize &&
+                                            static_cast<float>(clusterMisses) <= threshold * meshAcmr * static_cast<float>(clusterTriangles);
+
+                if (t == 0 || isHardBoundary || isSoftBoundary)
+                {
+                    clusterStarts.push_back(t);
+                    clusterTriangles = 0;
+                    clusterMisses = 0;
+                }
+
+                clusterTriangles++;
+                clusterMisses += misses;
+            }
+        }
+
+        const size_t clusterCount = clusterStarts.size();
+        clusterStarts.push_back(triangleCount);
+
+        // area weighted centroid and normal of every cluster and of the whole mesh
+        std::vector<float3> clusterCentroids(clusterCount, float3(0.f));
+        std::vector<float3> clusterNormals(clusterCount, float3(0.f));
+        float3 meshCentroid(0.f);
+        float meshArea = 0.f;
+
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            float clusterArea = 0.f;
+
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+            {
+                const float3 normal = getTriangleNormal(vertices, &indices[t * 3]);
+                const float area = length(normal);
+                const float3 centroid = getTriangleCentroid(vertices, &indices[t * 3]);
+
+                clusterNormals[c] += normal;
+                clusterCentroids[c] += centroid * area;
+                clusterArea += area;
+            }
+
+            meshCentroid += clusterCentroids[c];
+            meshArea += clusterArea;
+
+            if (clusterArea > 0.f)
+                clusterCentroids[c] /= clusterArea;
+        }
+
+        if (meshArea > 0.f)
+            meshCentroid /= meshArea;
+
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            const float normalLength = length(clusterNormals[c]);
+            sortKeys[c] = normalLength > 0.f ? dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / normalLength) : 0.f;
+        }
+
+        std::vector<size_t> clusterOrder(clusterCount);
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](const size_t a, const size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        TriangleMesh::IndexList newIndices;
+        newIndices.reserve(indices.size());
+
+        for (const size_t c : clusterOrder)
+            newIndices.insert(newIndices.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+
+        indices = std::move(newIndices);
+    }
+
+    void MeshOptimizer::optimizeVertexFetch(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+    {
+        std::vector<uint32_t> remap(vertices.size(), kInvalidIndex);
+        uint32_t nextVertex = 0;
+
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == kInvalidIndex)
+                remap[index] = nextVertex++;
+
+            index = remap[index];
+        }
+
+        // vertices no triangle uses are dropped
+        TriangleMesh::VertexList newVertices(nextVertex);
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            if (remap[v] != kInvalidIndex)
+                newVertices[remap[v]] = vertices[v];
+        }
+
+        vertices = std::move(newVertices);
+    }
+
+    MeshOptimizer::CacheStatistics MeshOptimizer::analyzeVertexCache(const uint32_t* pIndices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize)
+    {
+        CacheStatistics statistics;
+        if (indexCount < 3)
+            return statistics;
+
+        // a vertex is in the fifo if fewer than cacheSize vertices were loaded since it was loaded
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        size_t usedVertexCount = 0;
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            const uint32_t v = pIndices[i];
+
+            if (timestamps[v] == 0)
+                usedVertexCount++;
+
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                statistics.vertexTransforms++;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(statistics.vertexTransforms) / static_cast<float>(indexCount / 3);
+        statistics.atvr = static_cast<float>(statistics.vertexTransforms) / static_cast<float>(usedVertexCount);
+        return statistics;
+    }
+
+    uint32_t MeshOptimizer::getOptionFlags(const Options& options)
+    {
+        uint32_t flags = (options.optimizeVertexCache ? 1u : 0u) |
+                         (options.optimizeOverdraw ? 2u : 0u) |
+                         (options.optimizeVertexFetch ? 4u : 0u);
+
+        // the threshold only matters with the overdraw step, in the steps of the gui slider
+        if (options.optimizeOverdraw)
+        {
+            const long threshold = std::lround(std::clamp(options.overdrawThreshold, 0.f, 60.f) * 1000.f);
+            flags |= static_cast<uint32_t>(threshold) << 16;
+        }
+
+        return flags;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * reorders the triangles and vertices of an indexed triangle list, so the gpu does less work for the same mesh:
+     *   vertex cache: triangles sharing vertices are drawn close to each other (Forsyth's algorithm),
+     *                 so transformed vertices are reused from the post-transform cache
+     *   overdraw:     the cache optimized order is cut into clusters, which are sorted so outward facing
+     *                 parts of the mesh are drawn first and occlude the rest (Tipsify)
+     *   vertex fetch: vertices are stored in the order they are first used, so fetching them is sequential
+     * none of these change how the mesh looks, only the order of the data.
+     */
+    class MeshOptimizer
+    {
+    public:
+        struct Options
+        {
+            bool optimizeVertexCache = true;
+            bool optimizeOverdraw = false;
+            bool optimizeVertexFetch = true;
+
+            // a cluster may have at most this much worse ACMR than the cache optimized order
+            float overdrawThreshold = 1.05f;
+
+            static Options none() { return {false, false, false}; }
+        };
+
+        // result of simulating a fifo post-transform vertex cache
+        struct CacheStatistics
+        {
+            size_t vertexTransforms = 0;    // cache misses
+            float acmr = 0.f;               // average cache miss ratio: transforms per triangle, 0.5 is the best possible
+            float atvr = 0.f;               // average transform to vertex ratio: transforms per used vertex, 1 is the best possible
+        };
+
+        struct Report
+        {
+            CacheStatistics before;
+            CacheStatistics after;
+        };
+
+        // size of the simulated cache, modern gpus behave roughly like a small fifo
+        static constexpr uint32_t kSimulatedCacheSize = 16;
+
+        MeshOptimizer() = delete;
+
+        static Report optimize(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, const Options& options);
+        // replaces the mesh with an optimized copy
+        static Report optimize(TriangleMesh::SharedPtr& pMesh, const Options& options);
+
+        static void optimizeVertexCache(TriangleMesh::IndexList& indices, size_t vertexCount);
+        static void optimizeOverdraw(TriangleMesh::IndexList& indices, const TriangleMesh::VertexList& vertices, float threshold);
+        static void optimizeVertexFetch(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices);
+
+        static CacheStatistics analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = kSimulatedCacheSize);
+
+        // bit mask of the enabled steps with the overdraw threshold in thousandths in the upper 16 bits,
+        // meshes optimized with different options are different meshes
+        static uint32_t getOptionFlags(const Options& options);
+    };
+}
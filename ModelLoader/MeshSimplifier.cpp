@@ -0,0 +1,578 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <tuple>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        // border planes count this much more than triangles of the same size, so open meshes keep their outline
+        constexpr double kBorderWeight = 10.0;
+
+        // a collapse may turn the normal of a remaining triangle by at most ~75 degrees
+        constexpr float kMinNormalCosine = 0.25f;
+
+        // a pass stops at this many times the cost of the collapse that would reach the target.
+        // the neighbourhood of every collapse is locked for the rest of the pass, without a limit the pass
+        // would go on with much worse edges instead of waiting for the cheap ones to become free
+        constexpr float kPassCostSlack = 1.5f;
+
+        enum class VertexKind : uint8_t
+        {
+            Manifold,   // moves anywhere
+            Border,     // moves only along the open border it's on
+            Locked      // attribute seams, non-manifold and complex vertices
+        };
+
+        // symmetric 4x4 matrix of plane equations, (p, 1)^T Q (p, 1) is the weighted sum of squared distances from the planes
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+            double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+            double a22 = 0.0, a23 = 0.0;
+            double a33 = 0.0;
+            double weight = 0.0;
+
+            // plane n.p + d = 0, n has to be unit length
+            static Quadric fromPlane(const double nx, const double ny, const double nz, const double d, const double w)
+            {
+                Quadric q;
+                q.a00 = w * nx * nx;
+                q.a01 = w * nx * ny;
+                q.a02 = w * nx * nz;
+                q.a03 = w * nx * d;
+                q.a11 = w * ny * ny;
+                q.a12 = w * ny * nz;
+                q.a13 = w * ny * d;
+                q.a22 = w * nz * nz;
+                q.a23 = w * nz * d;
+                q.a33 = w * d * d;
+                q.weight = w;
+                return q;
+            }
+
+            Quadric& operator+=(const Quadric& other)
+            {
+                a00 += other.a00;
+                a01 += other.a01;
+                a02 += other.a02;
+                a03 += other.a03;
+                a11 += other.a11;
+                a12 += other.a12;
+                a13 += other.a13;
+                a22 += other.a22;
+                a23 += other.a23;
+                a33 += other.a33;
+                weight += other.weight;
+                return *this;
+            }
+
+            // weighted average of the squared distances of p from the planes
+            double evaluate(const float3& p) const
+            {
+                const double x = p.x;
+                const double y = p.y;
+                const double z = p.z;
+                const double error =
+                    a00 * x * x + a11 * y * y + a22 * z * z + a33 +
+                    2.0 * (a01 * x * y + a02 * x * z + a12 * y * z + a03 * x + a13 * y + a23 * z);
+
+                return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            float cost;     // squared distance
+        };
+
+        uint64_t getEdgeKey(const uint32_t a, const uint32_t b)
+        {
+            return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        }
+
+        float3 getNormal(const float3& p0, const float3& p1, const float3& p2)
+        {
+            return cross(p1 - p0, p2 - p0);
+        }
+    }
+
+    TriangleMesh::IndexList MeshSimplifier::simplify(
+        const TriangleMesh::Vertex* pVertices,
+        const size_t vertexCount,
+        const uint32_t* pIndices,
+        const size_t indexCount,
+        const size_t targetIndexCount,
+        const float targetError,
+        float* pResultError
+    )
+    {
+        if (pResultError != nullptr)
+            *pResultError = 0.f;
+
+        TriangleMesh::IndexList result(pIndices, pIndices + indexCount - indexCount % 3);
+        if (result.size() <= targetIndexCount || vertexCount == 0)
+            return result;
+
+        const auto getPosition = [&](const uint32_t v) -> const float3& { return pVertices[v].position; };
+
+        // vertices with the same position are one vertex for the topology, the first of them stands for all
+        std::vector<uint32_t> remap(vertexCount);
+        {
+            std::vector<uint32_t> order(vertexCount);
+            std::iota(order.begin(), order.end(), 0);
+
+            const auto isLess = [&](const uint32_t a, const uint32_t b)
+            {
+                const float3& pa = getPosition(a);
+                const float3& pb = getPosition(b);
+                return std::tie(pa.x, pa.y, pa.z) < std::tie(pb.x, pb.y, pb.z);
+            };
+            std::stable_sort(order.begin(), order.end(), isLess);
+
+            for (size_t i = 0; i < vertexCount; i++)
+                remap[order[i]] = i > 0 && !isLess(order[i - 1], order[i]) ? remap[order[i - 1]] : order[i];
+        }
+
+        // triangles that are degenerate already don't take part in anything
+        const auto compact = [&](TriangleMesh::IndexList& indices)
+        {
+            size_t writeIndex = 0;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const uint32_t c0 = remap[indices[i]];
+                const uint32_t c1 = remap[indices[i + 1]];
+                const uint32_t c2 = remap[indices[i + 2]];
+                if (c0 == c1 || c1 == c2 || c2 == c0)
+                    continue;
+
+                indices[writeIndex++] = indices[i];
+                indices[writeIndex++] = indices[i + 1];
+                indices[writeIndex++] = indices[i + 2];
+            }
+            indices.resize(writeIndex);
+        };
+        compact(result);
+
+        // edges in sorted key order, with the number of triangles on them
+        std::vector<uint64_t> edgeKeys;
+        edgeKeys.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int corner = 0; corner < 3; corner++)
+                edgeKeys.push_back(getEdgeKey(remap[result[i + corner]], remap[result[i + (corner + 1) % 3]]));
+        }
+        std::sort(edgeKeys.begin(), edgeKeys.end());
+
+        const auto getEdgeTriangleCount = [&](const uint32_t a, const uint32_t b)
+        {
+            const auto range = std::equal_range(edgeKeys.begin(), edgeKeys.end(), getEdgeKey(a, b));
+            return static_cast<size_t>(range.second - range.first);
+        };
+
+        // classifying the vertices
+        std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+        {
+            std::vector<uint32_t> wedgeCounts(vertexCount, 0);
+            std::vector<bool> isCounted(vertexCount, false);
+            for (const uint32_t v : result)
+            {
+                if (!isCounted[v])
+                {
+                    isCounted[v] = true;
+                    wedgeCounts[remap[v]]++;
+                }
+            }
+
+            std::vector<uint32_t> borderEdgeCounts(vertexCount, 0);
+            for (size_t i = 0; i < edgeKeys.size();)
+            {
+                size_t end = i;
+                while (end < edgeKeys.size() && edgeKeys[end] == edgeKeys[i])
+                    end++;
+
+                const uint32_t a = static_cast<uint32_t>(edgeKeys[i] >> 32);
+                const uint32_t b = static_cast<uint32_t>(edgeKeys[i]);
+                if (end - i == 1)
+                {
+                    borderEdgeCounts[a]++;
+                    borderEdgeCounts[b]++;
+                }
+                else if (end - i > 2)
+                {
+                    kinds[a] = VertexKind::Locked;
+                    kinds[b] = VertexKind::Locked;
+                }
+                i = end;
+            }
+
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                // a normal or uv seam runs through the vertex, moving it would tear the seam open
+                if (wedgeCounts[v] > 1)
+                    kinds[v] = VertexKind::Locked;
+                // a simple border vertex has exactly two border edges, anything else is a pinch
+                else if (borderEdgeCounts[v] != 0 && kinds[v] == VertexKind::Manifold)
+                    kinds[v] = borderEdgeCounts[v] == 2 ? VertexKind::Border : VertexKind::Locked;
+            }
+        }
+
+        // quadrics of the triangle planes, and of planes perpendicular to the border along border edges
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const uint32_t c[3] = {remap[result[i]], remap[result[i + 1]], remap[result[i + 2]]};
+            const float3 normal = getNormal(getPosition(c[0]), getPosition(c[1]), getPosition(c[2]));
+            const float normalLength = length(normal);
+            if (normalLength <= 0.f)
+                continue;
+
+            const float3 n = normal / normalLength;
+            const Quadric plane = Quadric::fromPlane(n.x, n.y, n.z, -dot(n, getPosition(c[0])), normalLength * 0.5);
+            for (int corner = 0; corner < 3; corner++)
+                quadrics[c[corner]] += plane;
+
+            for (int corner = 0; corner < 3; corner++)
+            {
+                const uint32_t a = c[corner];
+                const uint32_t b = c[(corner + 1) % 3];
+                if (getEdgeTriangleCount(a, b) != 1)
+                    continue;
+
+                const float3 edge = getPosition(b) - getPosition(a);
+                const float3 borderNormal = cross(edge, n);
+                const float borderNormalLength = length(borderNormal);
+                if (borderNormalLength <= 0.f)
+                    continue;
+
+                const float3 bn = borderNormal / borderNormalLength;
+                const Quadric border = Quadric::fromPlane(bn.x, bn.y, bn.z, -dot(bn, getPosition(a)), dot(edge, edge) * kBorderWeight);
+                quadrics[a] += border;
+                quadrics[b] += border;
+            }
+        }
+
+        const double maxCost = double(targetError) * double(targetError);
+        double resultCost = 0.0;
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<uint64_t> passEdges;
+        std::vector<Collapse> collapses;
+        std::vector<bool> isLocked(vertexCount);
+        std::vector<uint32_t> collapseTargets(vertexCount, kInvalidIndex);
+        std::vector<uint32_t> fromNeighbours;
+        std::vector<uint32_t> toNeighbours;
+
+        const auto countSharedTriangles = [&](const uint32_t from, const uint32_t to)
+        {
+            size_t count = 0;
+            for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; a++)
+            {
+                const uint32_t* pTriangle = &result[adjacency[a] * 3];
+                if (remap[pTriangle[0]] == to || remap[pTriangle[1]] == to || remap[pTriangle[2]] == to)
+                    count++;
+            }
+            return count;
+        };
+
+        const auto canMove = [&](const uint32_t from, const uint32_t to)
+        {
+            if (kinds[from] == VertexKind::Manifold)
+                return true;
+
+            // a border vertex may only slide along its own border, onto another border vertex
+            return kinds[from] == VertexKind::Border && kinds[to] != VertexKind::Manifold && countSharedTriangles(from, to) == 1;
+        };
+
+        const auto gatherNeighbours = [&](const uint32_t v, const uint32_t excluded, std::vector<uint32_t>& neighbours)
+        {
+            neighbours.clear();
+            for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++)
+            {
+                const uint32_t* pTriangle = &result[adjacency[a] * 3];
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t c = remap[pTriangle[corner]];
+                    if (c != v && c != excluded)
+                        neighbours.push_back(c);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        };
+
+        // checks a collapse against the current mesh, returns the vertex that takes the place of from's vertex
+        const auto findCollapseTarget = [&](const uint32_t from, const uint32_t to) -> uint32_t
+        {
+            const float3& target = getPosition(to);
+            uint32_t targetVertex = kInvalidIndex;
+            size_t sharedCount = 0;
+
+            for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; a++)
+            {
+                const uint32_t* pTriangle = &result[adjacency[a] * 3];
+                const uint32_t c[3] = {remap[pTriangle[0]], remap[pTriangle[1]], remap[pTriangle[2]]};
+
+                if (c[0] == to || c[1] == to || c[2] == to)
+                {
+                    // the triangles on the edge have to agree on the attributes of the target, or there is a seam on the edge
+                    const uint32_t v = pTriangle[c[0] == to ? 0 : (c[1] == to ? 1 : 2)];
+                    if (targetVertex != kInvalidIndex && targetVertex != v)
+                        return kInvalidIndex;
+
+                    targetVertex = v;
+                    sharedCount++;
+                    continue;
+                }
+
+                const float3 oldNormal = getNormal(getPosition(c[0]), getPosition(c[1]), getPosition(c[2]));
+                const float3 newNormal = getNormal(
+                    c[0] == from ? target : getPosition(c[0]),
+                    c[1] == from ? target : getPosition(c[1]),
+                    c[2] == from ? target : getPosition(c[2])
+                );
+
+                if (dot(oldNormal, oldNormal) > 0.f && dot(oldNormal, newNormal) <= kMinNormalCosine * length(oldNormal) * length(newNormal))
+                    return kInvalidIndex;
+            }
+
+            if (sharedCount == 0)
+                return kInvalidIndex;
+
+            // link condition: the endpoints may only share the vertices opposite the edge, otherwise the collapse pinches the surface
+            gatherNeighbours(from, to, fromNeighbours);
+            gatherNeighbours(to, from, toNeighbours);
+
+            size_t commonCount = 0;
+            for (size_t i = 0, j = 0; i < fromNeighbours.size() && j < toNeighbours.size();)
+            {
+                if (fromNeighbours[i] < toNeighbours[j])
+                    i++;
+                else if (toNeighbours[j] < fromNeighbours[i])
+                    j++;
+                else
+                {
+                    commonCount++;
+                    i++;
+                    j++;
+                }
+            }
+
+            return commonCount == sharedCount ? targetVertex : kInvalidIndex;
+        };
+
+        while (result.size() > targetIndexCount)
+        {
+            const size_t triangleCount = result.size() / 3;
+
+            // position -> triangles adjacency in compressed rows
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for (const uint32_t v : result)
+                adjacencyOffsets[remap[v] + 1]++;
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+            adjacency.resize(result.size());
+            {
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); i++)
+                    adjacency[fill[remap[result[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            passEdges.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int corner = 0; corner < 3; corner++)
+                    passEdges.push_back(getEdgeKey(remap[result[i + corner]], remap[result[i + (corner + 1) % 3]]));
+            }
+            std::sort(passEdges.begin(), passEdges.end());
+            passEdges.erase(std::unique(passEdges.begin(), passEdges.end()), passEdges.end());
+
+            // every edge collapses in the cheaper of its allowed directions
+            collapses.clear();
+            for (const uint64_t key : passEdges)
+            {
+                const uint32_t a = static_cast<uint32_t>(key >> 32);
+                const uint32_t b = static_cast<uint32_t>(key);
+                const bool canMoveA = canMove(a, b);
+                const bool canMoveB = canMove(b, a);
+                if (!canMoveA && !canMoveB)
+                    continue;
+
+                Quadric quadric = quadrics[a];
+                quadric += quadrics[b];
+                const float costAToB = canMoveA ? static_cast<float>(quadric.evaluate(getPosition(b))) : std::numeric_limits<float>::max();
+                const float costBToA = canMoveB ? static_cast<float>(quadric.evaluate(getPosition(a))) : std::numeric_limits<float>::max();
+
+                collapses.push_back(costAToB <= costBToA ? Collapse{a, b, costAToB} : Collapse{b, a, costBToA});
+            }
+
+            if (collapses.empty())
+                break;
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs)
+            {
+                return std::tie(lhs.cost, lhs.from, lhs.to) < std::tie(rhs.cost, rhs.from, rhs.to);
+            });
+
+            // an interior collapse removes two triangles
+            const size_t removalGoal = triangleCount - targetIndexCount / 3;
+            const size_t collapseGoal = std::min(collapses.size(), (removalGoal + 1) / 2);
+            const float passCostLimit = collapses[collapseGoal - 1].cost * kPassCostSlack;
+
+            std::fill(isLocked.begin(), isLocked.end(), false);
+            size_t removedCount = 0;
+            size_t collapseCount = 0;
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse.cost > maxCost || (collapse.cost > passCostLimit && collapseCount > 0))
+                    break;
+
+                if (isLocked[collapse.from] || isLocked[collapse.to])
+                    continue;
+
+                const uint32_t targetVertex = findCollapseTarget(collapse.from, collapse.to);
+                if (targetVertex == kInvalidIndex)
+                    continue;
+
+                removedCount += countSharedTriangles(collapse.from, collapse.to);
+                collapseCount++;
+                collapseTargets[collapse.from] = targetVertex;
+                quadrics[collapse.to] += quadrics[collapse.from];
+                resultCost = std::max(resultCost, double(collapse.cost));
+
+                // the triangles around from change, nothing else may touch them until the adjacency is rebuilt
+                for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+                {
+                    const uint32_t* pTriangle = &result[adjacency[a] * 3];
+                    for (int corner = 0; corner < 3; corner++)
+                        isLocked[remap[pTriangle[corner]]] = true;
+                }
+
+                if (removedCount >= removalGoal)
+                    break;
+            }
+
+            if (collapseCount == 0)
+                break;
+
+            for (uint32_t& v : result)
+            {
+                const uint32_t target = collapseTargets[remap[v]];
+                if (target != kInvalidIndex)
+                    v = target;
+            }
+
+            for (const Collapse& collapse : collapses)
+                collapseTargets[collapse.from] = kInvalidIndex;
+
+            compact(result);
+        }
+
+        if (pResultError != nullptr)
+            *pResultError = static_cast<float>(std::sqrt(resultCost));
+
+        return result;
+    }
+
+    MeshSimplifier::LodChain MeshSimplifier::buildLodChain(
+        const TriangleMesh::Vertex* pVertices,
+        const size_t vertexCount,
+        const uint32_t* pIndices,
+        const size_t indexCount,
+        const Options& options
+    )
+    {
+        LodChain chain;
+        if (vertexCount == 0 || indexCount == 0)
+            return chain;
+
+        float3 minPosition = pVertices[0].position;
+        float3 maxPosition = pVertices[0].position;
+        for (size_t v = 1; v < vertexCount; v++)
+        {
+            minPosition = min(minPosition, pVertices[v].position);
+            maxPosition = max(maxPosition, pVertices[v].position);
+        }
+
+        chain.center = (minPosition + maxPosition) * 0.5f;
+        for (size_t v = 0; v < vertexCount; v++)
+            chain.radius = std::max(chain.radius, length(pVertices[v].position - chain.center));
+
+        // every lod is simplified from the full mesh, so they are independent of each other
+        const size_t lodCount = options.targetRatios.size();
+        std::vector<TriangleMesh::IndexList> lodIndices(lodCount);
+        std::vector<float> lodErrors(lodCount, 0.f);
+        const float targetError = options.maxError * chain.radius;
+
+        std::vector<std::thread> workers;
+        workers.reserve(lodCount);
+
+        for (size_t i = 0; i < lodCount; i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                const size_t targetIndexCount = static_cast<size_t>(static_cast<float>(indexCount / 3) * std::clamp(options.targetRatios[i], 0.f, 1.f)) * 3;
+                lodIndices[i] = simplify(pVertices, vertexCount, pIndices, indexCount, targetIndexCount, targetError, &lodErrors[i]);
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        chain.indices.assign(pIndices, pIndices + indexCount);
+        chain.lods.push_back({0, static_cast<uint32_t>(indexCount), 0.f});
+
+        for (size_t i = 0; i < lodCount; i++)
+        {
+            const Lod& previous = chain.lods.back();
+            if (lodIndices[i].empty() || lodIndices[i].size() >= previous.indexCount)
+                continue;
+
+            Lod lod;
+            lod.indexOffset = static_cast<uint32_t>(chain.indices.size());
+            lod.indexCount = static_cast<uint32_t>(lodIndices[i].size());
+            lod.error = std::max(lodErrors[i], previous.error);
+
+            chain.indices.insert(chain.indices.end(), lodIndices[i].begin(), lodIndices[i].end());
+            chain.lods.push_back(lod);
+        }
+
+        return chain;
+    }
+
+    uint32_t MeshSimplifier::selectLod(
+        const LodChain& chain,
+        const float distance,
+        const float scale,
+        const float fovY,
+        const float viewportHeight,
+        const float maxPixelError
+    )
+    {
+        // from inside the bounding sphere any part of the mesh can be arbitrarily close
+        const float nearestDistance = distance - chain.radius * scale;
+        if (chain.lods.empty() || nearestDistance <= 0.f || viewportHeight <= 0.f)
+            return 0;
+
+        const float pixelsPerUnit = viewportHeight / (2.f * nearestDistance * std::tan(fovY * 0.5f));
+
+        for (uint32_t i = static_cast<uint32_t>(chain.lods.size()) - 1; i > 0; i--)
+        {
+            if (chain.lods[i].error * scale * pixelsPerUnit <= maxPixelError)
+                return i;
+        }
+
+        return 0;
+    }
+}
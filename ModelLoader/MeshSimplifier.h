@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * reduces the triangle count of an indexed triangle list by collapsing edges (Garland and Heckbert: quadric error metrics).
+     * every vertex collects the planes of the triangles around it, the error of moving it somewhere is the
+     * squared distance from those planes. the cheapest edges are collapsed first, onto one of their endpoints,
+     * so a simplified mesh only has new indices, it shares the vertex buffer of the original.
+     * vertices on attribute seams (one position with several normals or uvs) and on non-manifold edges never move,
+     * vertices on open borders only move along the border.
+     */
+    class MeshSimplifier
+    {
+    public:
+        struct Options
+        {
+            // index count of every lod relative to the full mesh, from fine to coarse
+            std::vector<float> targetRatios = {0.5f, 0.25f, 0.125f, 0.0625f};
+
+            // a lod stops before its target if the error would exceed this, relative to the radius of the mesh
+            float maxError = 0.02f;
+        };
+
+        struct Lod
+        {
+            uint32_t indexOffset = 0;   // first index in LodChain::indices
+            uint32_t indexCount = 0;
+            float error = 0.f;          // estimated distance from the full mesh in object space units, never less than the finer lods'
+        };
+
+        struct LodChain
+        {
+            std::vector<Lod> lods;              // lods[0] is the full mesh, every further lod has fewer triangles
+            TriangleMesh::IndexList indices;    // indices of every lod one after the other, all of them refer to the same vertices
+
+            // bounding sphere of the mesh
+            float3 center = float3(0.f);
+            float radius = 0.f;
+        };
+
+        MeshSimplifier() = delete;
+
+        // collapses edges until at most targetIndexCount indices are left or the next collapse would move the surface
+        // farther than targetError (object space units). pResultError receives the error of the result
+        static TriangleMesh::IndexList simplify(
+            const TriangleMesh::Vertex* pVertices,
+            size_t vertexCount,
+            const uint32_t* pIndices,
+            size_t indexCount,
+            size_t targetIndexCount,
+            float targetError,
+            float* pResultError = nullptr
+        );
+
+        // simplifies the full mesh for every target ratio on its own thread, the result doesn't depend on the scheduling.
+        // lods that wouldn't have fewer triangles than the previous one are left out
+        static LodChain buildLodChain(const TriangleMesh::Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount, const Options& options);
+
+        // the coarsest lod whose error projects to at most maxPixelError pixels on the screen.
+        // distance is measured from the camera to the center of the bounding sphere, scale is the model's largest scale factor
+        static uint32_t selectLod(const LodChain& chain, float distance, float scale, float fovY, float viewportHeight, float maxPixelError);
+    };
+}
@@ -0,0 +1,369 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        // relative slack of the bounds checks, the bounds are computed in float
+        constexpr float kBoundsTolerance = 1e-4f;
+        constexpr float kConeTolerance = 1e-3f;
+
+        float3 getTriangleCentroid(const TriangleMesh::Vertex* pVertices, const uint32_t* pTriangle)
+        {
+            return (pVertices[pTriangle[0]].position + pVertices[pTriangle[1]].position + pVertices[pTriangle[2]].position) / 3.f;
+        }
+
+        // unit normal of the triangle, zero for degenerate triangles
+        float3 getTriangleNormal(const float3& p0, const float3& p1, const float3& p2)
+        {
+            const float3 normal = cross(p1 - p0, p2 - p0);
+            const float normalLength = length(normal);
+            return normalLength > 0.f ? normal / normalLength : float3(0.f);
+        }
+
+        bool fail(std::string* pError, const std::string& message)
+        {
+            if (pError != nullptr)
+                *pError = message;
+
+            return false;
+        }
+    }
+
+    MeshletBuilder::MeshletMesh MeshletBuilder::build(
+        const TriangleMesh::Vertex* pVertices,
+        const size_t vertexCount,
+        const uint32_t* pIndices,
+        const size_t indexCount,
+        const uint32_t maxVertices,
+        const uint32_t maxTriangles
+    )
+    {
+        MeshletMesh result;
+
+        // local indices are 8 bit and a triangle needs 3 distinct slots
+        if (maxVertices < 3 || maxVertices > 256 || maxTriangles == 0)
+            return result;
+
+        const size_t triangleCount = indexCount / 3;
+
+        // vertex -> triangles adjacency in compressed rows, emitted triangles are swapped out of the live range
+        std::vector<uint32_t> liveValence(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            liveValence[pIndices[i]]++;
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveValence[v];
+
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++)
+                adjacency[fill[pIndices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<uint32_t> localIndices(vertexCount, kInvalidIndex);
+        std::vector<bool> isEmitted(triangleCount, false);
+        size_t emittedCount = 0;
+        size_t seedCursor = 0;
+
+        const auto countNewVertices = [&](const uint32_t triangle)
+        {
+            const uint32_t* pTriangle = pIndices + triangle * 3;
+            uint32_t count = 0;
+            for (int corner = 0; corner < 3; corner++)
+            {
+                // a triangle may use the same vertex twice
+                const bool isDuplicate = (corner > 0 && pTriangle[corner] == pTriangle[0]) || (corner > 1 && pTriangle[corner] == pTriangle[1]);
+                if (localIndices[pTriangle[corner]] == kInvalidIndex && !isDuplicate)
+                    count++;
+            }
+            return count;
+        };
+
+        while (emittedCount < triangleCount)
+        {
+            Meshlet meshlet;
+            meshlet.vertexOffset = static_cast<uint32_t>(result.vertexIndices.size());
+            meshlet.triangleOffset = static_cast<uint32_t>(result.primitiveIndices.size() / 3);
+
+            float3 centroidSum(0.f);
+
+            while (isEmitted[seedCursor])
+                seedCursor++;
+            uint32_t nextTriangle = static_cast<uint32_t>(seedCursor);
+
+            while (nextTriangle != kInvalidIndex)
+            {
+                const uint32_t* pTriangle = pIndices + nextTriangle * 3;
+
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t v = pTriangle[corner];
+                    if (localIndices[v] == kInvalidIndex)
+                    {
+                        localIndices[v] = meshlet.vertexCount++;
+                        result.vertexIndices.push_back(v);
+                    }
+                    result.primitiveIndices.push_back(static_cast<uint8_t>(localIndices[v]));
+
+                    // a vertex used twice has the triangle twice in its adjacency, every corner removes one
+                    const uint32_t begin = adjacencyOffsets[v];
+                    const uint32_t end = begin + liveValence[v];
+                    const auto it = std::find(adjacency.begin() + begin, adjacency.begin() + end, nextTriangle);
+                    std::iter_swap(it, adjacency.begin() + end - 1);
+                    liveValence[v]--;
+                }
+
+                isEmitted[nextTriangle] = true;
+                emittedCount++;
+                meshlet.triangleCount++;
+                centroidSum += getTriangleCentroid(pVertices, pTriangle);
+
+                if (meshlet.triangleCount == maxTriangles)
+                    break;
+
+                // the neighbour that adds the fewest vertices, closer to the middle of the meshlet on a tie
+                const float3 centroid = centroidSum / static_cast<float>(meshlet.triangleCount);
+                nextTriangle = kInvalidIndex;
+                uint32_t bestNewVertices = kInvalidIndex;
+                float bestDistance = std::numeric_limits<float>::max();
+
+                for (uint32_t i = meshlet.vertexOffset; i < result.vertexIndices.size(); i++)
+                {
+                    const uint32_t v = result.vertexIndices[i];
+                    const uint32_t begin = adjacencyOffsets[v];
+
+                    for (uint32_t a = begin; a < begin + liveValence[v]; a++)
+                    {
+                        const uint32_t triangle = adjacency[a];
+                        const uint32_t newVertices = countNewVertices(triangle);
+                        if (meshlet.vertexCount + newVertices > maxVertices || newVertices > bestNewVertices)
+                            continue;
+
+                        const float3 offset = getTriangleCentroid(pVertices, pIndices + triangle * 3) - centroid;
+                        const float distance = dot(offset, offset);
+
+                        if (newVertices < bestNewVertices || distance < bestDistance || (distance == bestDistance && triangle < nextTriangle))
+                        {
+                            nextTriangle = triangle;
+                            bestNewVertices = newVertices;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+
+                // the connected part is used up, the next triangle in order is likely close by
+                if (nextTriangle == kInvalidIndex && emittedCount < triangleCount)
+                {
+                    while (isEmitted[seedCursor])
+                        seedCursor++;
+
+                    if (meshlet.vertexCount + countNewVertices(static_cast<uint32_t>(seedCursor)) <= maxVertices)
+                        nextTriangle = static_cast<uint32_t>(seedCursor);
+                }
+            }
+
+            for (uint32_t i = meshlet.vertexOffset; i < result.vertexIndices.size(); i++)
+                localIndices[result.vertexIndices[i]] = kInvalidIndex;
+
+            computeBounds(meshlet, result, pVertices);
+            result.meshlets.push_back(meshlet);
+        }
+
+        return result;
+    }
+
+    void MeshletBuilder::computeBounds(Meshlet& meshlet, const MeshletMesh& meshletMesh, const TriangleMesh::Vertex* pVertices)
+    {
+        const uint32_t* pLocalVertices = meshletMesh.vertexIndices.data() + meshlet.vertexOffset;
+        const auto getPosition = [&](const uint32_t localIndex) -> const float3& { return pVertices[pLocalVertices[localIndex]].position; };
+
+        // Ritter's bounding sphere: starts from two far apart points, then grows to contain every point
+        const auto findFarthest = [&](const float3& from)
+        {
+            uint32_t farthest = 0;
+            float farthestDistance = -1.f;
+            for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+            {
+                const float3 offset = getPosition(i) - from;
+                const float distance = dot(offset, offset);
+                if (distance > farthestDistance)
+                {
+                    farthest = i;
+                    farthestDistance = distance;
+                }
+            }
+            return farthest;
+        };
+
+        const float3 a = getPosition(findFarthest(getPosition(0)));
+        const float3 b = getPosition(findFarthest(a));
+        meshlet.center = (a + b) * 0.5f;
+        meshlet.radius = length(b - a) * 0.5f;
+
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+        {
+            const float distance = length(getPosition(i) - meshlet.center);
+            if (distance > meshlet.radius)
+            {
+                const float newRadius = (meshlet.radius + distance) * 0.5f;
+                meshlet.center += (getPosition(i) - meshlet.center) * ((newRadius - meshlet.radius) / distance);
+                meshlet.radius = newRadius;
+            }
+        }
+
+        // normal cone around the average normal, as wide as the normal farthest from it
+        const uint8_t* pPrimitives = meshletMesh.primitiveIndices.data() + meshlet.triangleOffset * 3;
+        float3 normalSum(0.f);
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+            normalSum += getTriangleNormal(getPosition(pPrimitives[t * 3]), getPosition(pPrimitives[t * 3 + 1]), getPosition(pPrimitives[t * 3 + 2]));
+
+        meshlet.coneAxis = float3(0.f, 0.f, 1.f);
+        meshlet.coneCutoff = 1.f;
+
+        const float normalSumLength = length(normalSum);
+        if (normalSumLength <= 0.f)
+            return;
+
+        const float3 axis = normalSum / normalSumLength;
+        float minDot = 1.f;
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float3 normal = getTriangleNormal(getPosition(pPrimitives[t * 3]), getPosition(pPrimitives[t * 3 + 1]), getPosition(pPrimitives[t * 3 + 2]));
+            if (dot(normal, normal) > 0.f)
+                minDot = std::min(minDot, dot(normal, axis));
+        }
+
+        meshlet.coneAxis = axis;
+
+        // wider than a hemisphere, there is no direction every triangle faces away from
+        if (minDot > 0.f)
+            meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+    }
+
+    bool MeshletBuilder::validate(
+        const MeshletMesh& meshletMesh,
+        const TriangleMesh::Vertex* pVertices,
+        const size_t vertexCount,
+        const uint32_t* pIndices,
+        const size_t indexCount,
+        std::string* pError,
+        const uint32_t maxVertices,
+        const uint32_t maxTriangles
+    )
+    {
+        using Triangle = std::array<uint32_t, 3>;
+        std::vector<Triangle> meshletTriangles;
+        meshletTriangles.reserve(indexCount / 3);
+
+        for (size_t m = 0; m < meshletMesh.meshlets.size(); m++)
+        {
+            const Meshlet& meshlet = meshletMesh.meshlets[m];
+            const std::string name = "meshlet " + std::to_string(m);
+
+            if (meshlet.vertexCount == 0 || meshlet.vertexCount > maxVertices)
+                return fail(pError, name + " has " + std::to_string(meshlet.vertexCount) + " vertices");
+            if (meshlet.triangleCount == 0 || meshlet.triangleCount > maxTriangles)
+                return fail(pError, name + " has " + std::to_string(meshlet.triangleCount) + " triangles");
+            if (size_t(meshlet.vertexOffset) + meshlet.vertexCount > meshletMesh.vertexIndices.size())
+                return fail(pError, name + " has vertices out of range");
+            if ((size_t(meshlet.triangleOffset) + meshlet.triangleCount) * 3 > meshletMesh.primitiveIndices.size())
+                return fail(pError, name + " has triangles out of range");
+
+            const uint32_t* pLocalVertices = meshletMesh.vertexIndices.data() + meshlet.vertexOffset;
+            const uint8_t* pPrimitives = meshletMesh.primitiveIndices.data() + meshlet.triangleOffset * 3;
+
+            for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+            {
+                if (pLocalVertices[i] >= vertexCount)
+                    return fail(pError, name + " refers to vertex " + std::to_string(pLocalVertices[i]) + " out of " + std::to_string(vertexCount));
+
+                const float distance = length(pVertices[pLocalVertices[i]].position - meshlet.center);
+                if (distance > meshlet.radius * (1.f + kBoundsTolerance) + kBoundsTolerance)
+                    return fail(pError, name + " doesn't contain vertex " + std::to_string(pLocalVertices[i]) + " in its bounding sphere");
+            }
+
+            const float minConeDot = std::sqrt(std::max(0.f, 1.f - meshlet.coneCutoff * meshlet.coneCutoff));
+
+            for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+            {
+                Triangle triangle;
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint8_t localIndex = pPrimitives[t * 3 + corner];
+                    if (localIndex >= meshlet.vertexCount)
+                        return fail(pError, name + " has a local index out of range");
+
+                    triangle[corner] = pLocalVertices[localIndex];
+                }
+                meshletTriangles.push_back(triangle);
+
+                if (meshlet.coneCutoff < 1.f)
+                {
+                    const float3 normal = getTriangleNormal(pVertices[triangle[0]].position, pVertices[triangle[1]].position, pVertices[triangle[2]].position);
+                    if (dot(normal, normal) > 0.f && dot(normal, meshlet.coneAxis) < minConeDot - kConeTolerance)
+                        return fail(pError, name + " has a triangle outside of its normal cone");
+                }
+            }
+        }
+
+        // the meshlets have to contain every triangle of the mesh exactly once, with the same winding
+        std::vector<Triangle> meshTriangles(indexCount / 3);
+        for (size_t t = 0; t < meshTriangles.size(); t++)
+            meshTriangles[t] = {pIndices[t * 3], pIndices[t * 3 + 1], pIndices[t * 3 + 2]};
+
+        std::sort(meshTriangles.begin(), meshTriangles.end());
+        std::sort(meshletTriangles.begin(), meshletTriangles.end());
+
+        if (meshTriangles != meshletTriangles)
+            return fail(pError, "the meshlets don't contain the same triangles as the mesh");
+
+        return true;
+    }
+
+    MeshletBuilder::Statistics MeshletBuilder::getStatistics(const MeshletMesh& meshletMesh, const size_t vertexCount, const uint32_t maxVertices, const uint32_t maxTriangles)
+    {
+        Statistics statistics;
+        statistics.meshletCount = meshletMesh.meshlets.size();
+        if (statistics.meshletCount == 0)
+            return statistics;
+
+        size_t localVertexCount = 0;
+        size_t triangleCount = 0;
+        for (const Meshlet& meshlet : meshletMesh.meshlets)
+        {
+            localVertexCount += meshlet.vertexCount;
+            triangleCount += meshlet.triangleCount;
+            if (meshlet.coneCutoff < 1.f)
+                statistics.cullableConeCount++;
+        }
+
+        std::vector<bool> isUsed(vertexCount, false);
+        size_t usedVertexCount = 0;
+        for (const uint32_t v : meshletMesh.vertexIndices)
+        {
+            if (v < vertexCount && !isUsed[v])
+            {
+                isUsed[v] = true;
+                usedVertexCount++;
+            }
+        }
+
+        const float meshletCount = static_cast<float>(statistics.meshletCount);
+        statistics.averageVertexCount = static_cast<float>(localVertexCount) / meshletCount;
+        statistics.averageTriangleCount = static_cast<float>(triangleCount) / meshletCount;
+        statistics.vertexUtilization = statistics.averageVertexCount / static_cast<float>(maxVertices);
+        statistics.triangleUtilization = statistics.averageTriangleCount / static_cast<float>(maxTriangles);
+        statistics.vertexDuplication = usedVertexCount > 0 ? static_cast<float>(localVertexCount) / static_cast<float>(usedVertexCount) : 0.f;
+        return statistics;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Scene/TriangleMesh.h"
+
+#include <string>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * splits an indexed triangle list into meshlets: small clusters of triangles with a bounded number of vertices
+     * and triangles, the unit of work of mesh shaders and cluster culling.
+     * a meshlet refers to its vertices through a local vertex list (indices into the mesh's vertex buffer),
+     * and its triangles are 8 bit indices into that local list.
+     * meshlets are grown greedily from neighbouring triangles, preferring the ones that add the fewest new vertices,
+     * so the triangle order of the input (e.g. vertex cache optimized) is mostly kept.
+     */
+    class MeshletBuilder
+    {
+    public:
+        // 64 vertices and 124 triangles fit the output limits of mesh shaders on every vendor
+        static constexpr uint32_t kMaxVertices = 64;
+        static constexpr uint32_t kMaxTriangles = 124;
+
+        struct Meshlet
+        {
+            uint32_t vertexOffset = 0;      // first element in MeshletMesh::vertexIndices
+            uint32_t vertexCount = 0;
+            uint32_t triangleOffset = 0;    // first triangle in MeshletMesh::primitiveIndices (3 indices each)
+            uint32_t triangleCount = 0;
+
+            // bounding sphere of the vertices
+            float3 center = float3(0.f);
+            float radius = 0.f;
+
+            // normal cone, every triangle is backfacing for a camera if
+            // dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius.
+            // coneCutoff is the sine of the widest angle between coneAxis and a triangle normal, 1 if the cone is useless
+            float3 coneAxis = float3(0.f, 0.f, 1.f);
+            float coneCutoff = 1.f;
+        };
+
+        struct MeshletMesh
+        {
+            std::vector<Meshlet> meshlets;
+            std::vector<uint32_t> vertexIndices;    // local vertex -> mesh vertex, per meshlet
+            std::vector<uint8_t> primitiveIndices;  // triangle corner -> local vertex, per meshlet
+        };
+
+        struct Statistics
+        {
+            size_t meshletCount = 0;
+            float averageVertexCount = 0.f;
+            float averageTriangleCount = 0.f;
+            float vertexUtilization = 0.f;      // average fraction of kMaxVertices used
+            float triangleUtilization = 0.f;    // average fraction of kMaxTriangles used
+            float vertexDuplication = 0.f;      // local vertices per mesh vertex, vertices on meshlet borders are in multiple meshlets
+            size_t cullableConeCount = 0;       // meshlets with a normal cone that can actually cull
+        };
+
+        MeshletBuilder() = delete;
+
+        static MeshletMesh build(
+            const TriangleMesh::Vertex* pVertices,
+            size_t vertexCount,
+            const uint32_t* pIndices,
+            size_t indexCount,
+            uint32_t maxVertices = kMaxVertices,
+            uint32_t maxTriangles = kMaxTriangles
+        );
+
+        // checks the limits, every index, the bounds, and that the meshlets contain exactly the triangles of the mesh.
+        // returns false and describes the first problem in pError if something is wrong
+        static bool validate(
+            const MeshletMesh& meshletMesh,
+            const TriangleMesh::Vertex* pVertices,
+            size_t vertexCount,
+            const uint32_t* pIndices,
+            size_t indexCount,
+            std::string* pError = nullptr,
+            uint32_t maxVertices = kMaxVertices,
+            uint32_t maxTriangles = kMaxTriangles
+        );
+
+        static Statistics getStatistics(const MeshletMesh& meshletMesh, size_t vertexCount, uint32_t maxVertices = kMaxVertices, uint32_t maxTriangles = kMaxTriangles);
+
+    private:
+        static void computeBounds(Meshlet& meshlet, const MeshletMesh& meshletMesh, const TriangleMesh::Vertex* pVertices);
+    };
+}
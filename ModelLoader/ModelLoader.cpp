@@ -1,7 +1,6 @@
 #include "ModelLoader.h"
 
 #include "Utils/UI/TextRenderer.h"
-#include "MeshLoader.h"
 
 
 namespace Falcor::Tutorial
@@ -44,6 +43,9 @@ namespace Falcor::Tutorial
 
     void ModelLoader::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
     {
+        // swapping models only at the start of a frame, so a frame never mixes the old and the new one
+        swapInLoadedModel();
+
         mpCameraController->update();
         pRenderContext->clearFbo(pTargetFbo.get(), {0, 0.25, 0, 1}, 1.0f, 0, FboAttachmentType::All);
 
@@ -51,6 +53,11 @@ namespace Falcor::Tutorial
         mpVars["VSCBuffer"]["model"] = mSettings.modelSettings.transform.getMatrix();
         mpVars["VSCBuffer"]["modelIT"] = rmcv::inverse(rmcv::transpose(mSettings.modelSettings.transform.getMatrix()));
         mpVars["VSCBuffer"]["viewProjection"] = mpCamera->getViewProjMatrix();
+        mpVars["VSCBuffer"]["positionScale"] = mModelInfo.positionScale;
+        mpVars["VSCBuffer"]["positionOffset"] = mModelInfo.positionOffset;
+        mpVars["VSCBuffer"]["texCoordScale"] = mModelInfo.texCoordScale;
+        mpVars["VSCBuffer"]["texCoordOffset"] = mModelInfo.texCoordOffset;
+        mpVars["VSCBuffer"]["hasOctahedralNormals"] = mModelInfo.hasOctahedralNormals;
 
         // pixel shader cbuffer variables
         mpVars["PSCBuffer"]["lightAmbient"] = mSettings.lightSettings.ambient;
@@ -71,7 +78,11 @@ namespace Falcor::Tutorial
         mpGraphicsState->setFbo(pTargetFbo);
 
         if (mReadyToDraw)
-            pRenderContext->drawIndexed(mpGraphicsState.get(), mpVars.get(), mpModel->getIndices().size(), 0, 0);
+        {
+            mModelInfo.drawnLod = selectLod(pTargetFbo);
+            const MeshSimplifier::Lod& lod = mModelInfo.lodChain.lods[mModelInfo.drawnLod];
+            pRenderContext->drawIndexed(mpGraphicsState.get(), mpVars.get(), lod.indexCount, lod.indexOffset, 0);
+        }
 
         mFrameRate.newFrame();
         if (mSettings.showFPS)
@@ -122,15 +133,139 @@ namespace Falcor::Tutorial
         if (window.dropdown("Fill mode", fillModeList, reinterpret_cast<uint32_t&>(mSettings.fillMode)))
             applyRasterStateSettings();
 
-        if (window.button("Load model"))
+        if (isLoadingModel())
+        {
+            if (mSettings.useCustomLoader)
+                window.text("Loading model... " + std::to_string(static_cast<int>(mLoadProgress * 100.f)) + "%");
+            else
+                window.text("Loading model...");
+        }
+        else if (window.button("Load model"))
+        {
             loadModel();
+        }
 
         if (window.button("Load texture"))
             loadTexture();
 
         window.checkbox("Use custom model loader", mSettings.useCustomLoader);
+
+        if (mSettings.useCustomLoader)
+        {
+            static const Gui::DropdownList parseModeList = {
+                {static_cast<uint32_t>(MeshLoader::ParseMode::Stream), "String stream"},
+                {static_cast<uint32_t>(MeshLoader::ParseMode::Mapped), "Memory mapped"},
+                {static_cast<uint32_t>(MeshLoader::ParseMode::Parallel), "Memory mapped, multi-threaded"}
+            };
+
+            window.dropdown("Obj parser", parseModeList, reinterpret_cast<uint32_t&>(mSettings.parseMode));
+        }
+
         window.checkbox("Show fps", mSettings.showFPS);
 
+        if (auto optimizerGroup = window.group("Mesh optimization (applied on load)"))
+        {
+            MeshOptimizer::Options& options = mSettings.optimizerOptions;
+            window.checkbox("Vertex cache order", options.optimizeVertexCache);
+            window.checkbox("Overdraw order", options.optimizeOverdraw);
+            if (options.optimizeOverdraw)
+                window.var("Max ACMR increase", options.overdrawThreshold, 1.f, 2.f, 0.01f);
+            window.checkbox("Vertex fetch order", options.optimizeVertexFetch);
+
+            if (mReadyToDraw)
+            {
+                const auto toString = [](const MeshOptimizer::CacheStatistics& statistics)
+                {
+                    return "ACMR " + std::to_string(statistics.acmr) + ", ATVR " + std::to_string(statistics.atvr);
+                };
+
+                const MeshOptimizer::Report& report = mModelInfo.optimizationReport;
+                window.text("simulated fifo cache of " + std::to_string(MeshOptimizer::kSimulatedCacheSize) + " vertices");
+                window.text("before: " + (report.before.vertexTransforms != 0 ? toString(report.before) : std::string("n/a, loaded from cache")));
+                window.text("after: " + toString(report.after));
+            }
+        }
+
+        if (auto meshletGroup = window.group("Meshlets (built on load)"))
+        {
+            window.checkbox("Build meshlets", mSettings.buildMeshlets);
+            window.text("at most " + std::to_string(MeshletBuilder::kMaxVertices) + " vertices and " + std::to_string(MeshletBuilder::kMaxTriangles) + " triangles each");
+
+            if (mReadyToDraw && mModelInfo.hasMeshlets)
+            {
+                const MeshletBuilder::Statistics& statistics = mModelInfo.meshletStatistics;
+                window.text(std::to_string(statistics.meshletCount) + " meshlets");
+                window.text("average vertices: " + std::to_string(statistics.averageVertexCount) + " (" + std::to_string(statistics.vertexUtilization * 100.f) + "%)");
+                window.text("average triangles: " + std::to_string(statistics.averageTriangleCount) + " (" + std::to_string(statistics.triangleUtilization * 100.f) + "%)");
+                window.text("vertex duplication: " + std::to_string(statistics.vertexDuplication));
+                window.text("meshlets with a usable normal cone: " + std::to_string(statistics.cullableConeCount));
+                window.text(mModelInfo.meshletValidationError.empty() ? std::string("validation passed") : "validation failed: " + mModelInfo.meshletValidationError);
+            }
+        }
+
+        if (auto lodGroup = window.group("Level of detail"))
+        {
+            MeshSimplifier::Options& options = mSettings.simplifierOptions;
+            window.checkbox("Build lods (on load)", mSettings.buildLods);
+            window.var("Max simplification error (relative to the model's size)", options.maxError, 0.f, 1.f, 0.001f);
+            window.checkbox("Select lod by screen size", mSettings.autoSelectLod);
+            if (mSettings.autoSelectLod)
+                window.var("Max error in pixels", mSettings.maxLodPixelError, 0.f, 100.f, 0.1f);
+            else
+                window.var("Lod", mSettings.forcedLod, 0u, 16u);
+
+            if (mReadyToDraw)
+            {
+                const std::vector<MeshSimplifier::Lod>& lods = mModelInfo.lodChain.lods;
+                for (size_t i = 0; i < lods.size(); i++)
+                {
+                    const MeshSimplifier::Lod& lod = lods[i];
+                    window.text(
+                        (i == mModelInfo.drawnLod ? "> lod " : "  lod ") + std::to_string(i) + ": " + std::to_string(lod.indexCount / 3) +
+                        " triangles, error " + std::to_string(lod.error)
+                    );
+                }
+            }
+        }
+
+        if (auto packingGroup = window.group("Vertex packing (applied on load)"))
+        {
+            static const Gui::DropdownList positionFormatList = {
+                {static_cast<uint32_t>(VertexPacker::PositionFormat::Float), "float32"},
+                {static_cast<uint32_t>(VertexPacker::PositionFormat::Unorm16), "unorm16 (bounding box)"}
+            };
+
+            static const Gui::DropdownList normalFormatList = {
+                {static_cast<uint32_t>(VertexPacker::NormalFormat::Float), "float32"},
+                {static_cast<uint32_t>(VertexPacker::NormalFormat::Snorm16), "snorm16"},
+                {static_cast<uint32_t>(VertexPacker::NormalFormat::Octahedral), "octahedral snorm16"}
+            };
+
+            static const Gui::DropdownList texCoordFormatList = {
+                {static_cast<uint32_t>(VertexPacker::TexCoordFormat::Float), "float32"},
+                {static_cast<uint32_t>(VertexPacker::TexCoordFormat::Half), "float16"},
+                {static_cast<uint32_t>(VertexPacker::TexCoordFormat::Unorm16), "unorm16 (uv bounding box)"}
+            };
+
+            VertexPacker::Options& options = mSettings.packingOptions;
+            window.checkbox("16 bit indices if possible", options.allow16BitIndices);
+            window.dropdown("Position format", positionFormatList, reinterpret_cast<uint32_t&>(options.positionFormat));
+            window.dropdown("Normal format", normalFormatList, reinterpret_cast<uint32_t&>(options.normalFormat));
+            window.dropdown("Texture coordinate format", texCoordFormatList, reinterpret_cast<uint32_t&>(options.texCoordFormat));
+
+            if (mReadyToDraw)
+            {
+                const VertexPacker::RoundTripError& error = mModelInfo.packingError;
+                window.text(
+                    std::to_string(mModelInfo.vertexCount) + " vertices, " + std::to_string(mModelInfo.vertexStride) + " bytes each, " +
+                    (mModelInfo.indexFormat == ResourceFormat::R16Uint ? "16" : "32") + " bit indices"
+                );
+                window.text("max position error: " + std::to_string(error.maxPositionError));
+                window.text("max normal error: " + std::to_string(error.maxNormalErrorDegrees) + " degrees");
+                window.text("max texture coordinate error: " + std::to_string(error.maxTexCoordError));
+            }
+        }
+
         if (auto lightGroup = window.group("Directional light settings"))
         {
             window.rgbColor("light ambient", mSettings.lightSettings.ambient);
@@ -166,24 +301,97 @@ namespace Falcor::Tutorial
 
     void ModelLoader::loadModel()
     {
-        mReadyToDraw = false;
         std::filesystem::path path;
 
-        if (openFileDialog({{"obj", "obj file"}}, path))
+        if (!openFileDialog({{"obj", "obj file"}}, path))
+            return;
+
+        // parsing runs on a worker thread with a copy of the settings, the frame loop keeps going meanwhile
+        mLoadProgress = 0.f;
+        mPendingModel = std::async(std::launch::async, [this, path, settings = mSettings]()
         {
-            if (mSettings.useCustomLoader)
-                loadModelFromObj(path);
-            else
-                loadModelFalcor(path);
+            LoadedModel model = settings.useCustomLoader ? loadModelFromObj(path, settings, mLoadProgress) : loadModelFalcor(path);
+            optimizeModel(model, settings.optimizerOptions);
+            if (settings.buildMeshlets)
+                buildMeshlets(model);
+            if (settings.buildLods)
+                buildLods(model, settings.simplifierOptions);
+            packModel(model, settings.packingOptions);
+            return model;
+        });
+    }
+
+    void ModelLoader::swapInLoadedModel()
+    {
+        if (!isLoadingModel() || mPendingModel.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        // whatever the parser, the optimizer or the packer threw comes out of get(), the previous model stays drawn
+        LoadedModel model;
+        try
+        {
+            model = mPendingModel.get();
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to load model: {}", e.what());
+            return;
+        }
+
+        // only the gpu upload is left for the render thread, the previous vao stays bound if it fails
+        const Vao::SharedPtr pVao = createVao(model);
+        if (pVao == nullptr)
+        {
+            logWarning("Failed to load model.");
+            return;
+        }
+
+        mModelInfo = DrawnModelInfo();
+        mModelInfo.optimizationReport = model.optimizationReport;
+        mModelInfo.packingError = model.packingError;
+        mModelInfo.hasMeshlets = model.pMeshlets != nullptr;
+        mModelInfo.meshletStatistics = model.meshletStatistics;
+        mModelInfo.meshletValidationError = model.meshletValidationError;
+
+        if (model.pPackedMesh != nullptr)
+        {
+            const VertexPacker::PackedMesh& packed = *model.pPackedMesh;
+            mModelInfo.vertexCount = packed.vertexCount;
+            mModelInfo.indexCount = packed.indexCount;
+            mModelInfo.vertexStride = packed.vertexStride;
+            mModelInfo.indexFormat = packed.indexFormat;
+            mModelInfo.positionScale = packed.positionScale;
+            mModelInfo.positionOffset = packed.positionOffset;
+            mModelInfo.texCoordScale = packed.texCoordScale;
+            mModelInfo.texCoordOffset = packed.texCoordOffset;
+            mModelInfo.hasOctahedralNormals = packed.options.normalFormat == VertexPacker::NormalFormat::Octahedral;
+        }
+        else if (model.pMeshCache != nullptr)
+        {
+            mModelInfo.vertexCount = model.pMeshCache->getVertexCount();
+            mModelInfo.indexCount = model.pMeshCache->getIndexCount();
+        }
+        else
+        {
+            mModelInfo.vertexCount = model.pMesh->getVertices().size();
+            mModelInfo.indexCount = model.pMesh->getIndices().size();
         }
 
-        const Vao::SharedPtr pVao = createVao();
-        if (pVao != nullptr)
+        if (model.pLodChain != nullptr)
+        {
+            mModelInfo.indexCount = model.pLodChain->indices.size();
+            mModelInfo.lodChain.lods = model.pLodChain->lods;
+            mModelInfo.lodChain.center = model.pLodChain->center;
+            mModelInfo.lodChain.radius = model.pLodChain->radius;
+        }
+        else
         {
-            mReadyToDraw = true;
-            mpGraphicsState->setVao(pVao);
-            mFrameRate.reset();
+            mModelInfo.lodChain.lods = {{0, static_cast<uint32_t>(mModelInfo.indexCount), 0.f}};
         }
+
+        mReadyToDraw = true;
+        mpGraphicsState->setVao(pVao);
+        mFrameRate.reset();
     }
 
     void ModelLoader::loadTexture()
@@ -195,14 +403,44 @@ namespace Falcor::Tutorial
         }
     }
 
-    void ModelLoader::loadModelFalcor(const std::filesystem::path& path)
+    ModelLoader::LoadedModel ModelLoader::loadModelFalcor(const std::filesystem::path& path)
     {
-        mpModel = TriangleMesh::createFromFile(path);
+        LoadedModel model;
+        model.pMesh = TriangleMesh::createFromFile(path);
+        return model;
     }
 
-    void ModelLoader::loadModelFromObj(const std::filesystem::path& path)
+    ModelLoader::LoadedModel ModelLoader::loadModelFromObj(const std::filesystem::path& path, const ModelLoaderSettings& settings, MeshLoader::Progress& progress)
     {
-        mpModel = MeshLoader::loadMeshFromObjFile(path);
+        LoadedModel model;
+
+        if (settings.useMeshCache)
+            model.pMeshCache = MeshLoader::loadMeshThroughCache(path, settings.parseMode, &progress, &settings.optimizerOptions, &model.optimizationReport);
+        else
+            model.pMesh = MeshLoader::loadMeshFromObjFile(path, settings.parseMode, &progress);
+
+        return model;
+    }
+
+    uint32_t ModelLoader::selectLod(const Fbo::SharedPtr& pTargetFbo) const
+    {
+        const MeshSimplifier::LodChain& chain = mModelInfo.lodChain;
+        if (!mSettings.autoSelectLod)
+            return std::min(mSettings.forcedLod, static_cast<uint32_t>(chain.lods.size()) - 1);
+
+        const float3 scale = abs(mSettings.modelSettings.scale);
+        const float4 center = mSettings.modelSettings.transform.getMatrix() * float4(chain.center, 1.f);
+        const float distance = length(float3(center.x, center.y, center.z) - mpCamera->getPosition());
+        const float fovY = focalLengthToFovY(mpCamera->getFocalLength(), mpCamera->getFrameHeight());
+
+        return MeshSimplifier::selectLod(
+            chain,
+            distance,
+            std::max(scale.x, std::max(scale.y, scale.z)),
+            fovY,
+            static_cast<float>(pTargetFbo->getHeight()),
+            mSettings.maxLodPixelError
+        );
     }
 
     void ModelLoader::applyRasterStateSettings() const
@@ -216,32 +454,117 @@ namespace Falcor::Tutorial
         mpGraphicsState->setRasterizerState(RasterizerState::create(rsDesc));
     }
 
-    Vao::SharedPtr ModelLoader::createVao() const
+    void ModelLoader::optimizeModel(LoadedModel& model, const MeshOptimizer::Options& options)
     {
-        if (mpModel == nullptr)
-            return nullptr;
+        // meshes loaded through the cache are optimized before they are written to it
+        if (model.pMesh == nullptr)
+            return;
+
+        model.optimizationReport = MeshOptimizer::optimize(model.pMesh, options);
+    }
+
+    void ModelLoader::buildMeshlets(LoadedModel& model)
+    {
+        const MeshView mesh = getMeshView(model);
+        if (mesh.vertexCount == 0 || mesh.indexCount == 0)
+            return;
+
+        // nothing draws the meshlets yet, they are only built and checked so the numbers can be compared
+        model.pMeshlets = std::make_shared<MeshletBuilder::MeshletMesh>(MeshletBuilder::build(mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount));
+        model.meshletStatistics = MeshletBuilder::getStatistics(*model.pMeshlets, mesh.vertexCount);
+        if (!MeshletBuilder::validate(*model.pMeshlets, mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount, &model.meshletValidationError))
+            logWarning("Invalid meshlets: {}", model.meshletValidationError);
+    }
+
+    void ModelLoader::buildLods(LoadedModel& model, const MeshSimplifier::Options& options)
+    {
+        const MeshView mesh = getMeshView(model);
+        if (mesh.vertexCount == 0 || mesh.indexCount == 0)
+            return;
+
+        model.pLodChain = std::make_shared<MeshSimplifier::LodChain>(
+            MeshSimplifier::buildLodChain(mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount, options)
+        );
+    }
+
+    ModelLoader::MeshView ModelLoader::getMeshView(const LoadedModel& model)
+    {
+        MeshView mesh;
+
+        if (model.pMeshCache != nullptr)
+        {
+            mesh.pVertices = model.pMeshCache->getVertices();
+            mesh.vertexCount = model.pMeshCache->getVertexCount();
+            mesh.pIndices = model.pMeshCache->getIndices();
+            mesh.indexCount = model.pMeshCache->getIndexCount();
+        }
+        else if (model.pMesh != nullptr)
+        {
+            mesh.pVertices = model.pMesh->getVertices().data();
+            mesh.vertexCount = model.pMesh->getVertices().size();
+            mesh.pIndices = model.pMesh->getIndices().data();
+            mesh.indexCount = model.pMesh->getIndices().size();
+        }
+
+        return mesh;
+    }
+
+    void ModelLoader::packModel(LoadedModel& model, const VertexPacker::Options& options)
+    {
+        MeshView mesh = getMeshView(model);
 
-        if (mpModel->getVertices().empty() || mpModel->getIndices().empty())
+        // the lods are packed together, they are drawn from the same index buffer
+        if (model.pLodChain != nullptr)
+        {
+            mesh.pIndices = model.pLodChain->indices.data();
+            mesh.indexCount = model.pLodChain->indices.size();
+        }
+
+        // nothing to gain, the original arrays are uploaded as they are
+        if (mesh.vertexCount == 0 || VertexPacker::isIdentity(options, mesh.vertexCount))
+            return;
+
+        model.pPackedMesh = std::make_shared<VertexPacker::PackedMesh>(VertexPacker::pack(mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount, options));
+        model.packingError = VertexPacker::measureRoundTripError(mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount, *model.pPackedMesh);
+    }
+
+    Vao::SharedPtr ModelLoader::createVao(const LoadedModel& model) const
+    {
+        if (model.pPackedMesh != nullptr)
+            return createVao(*model.pPackedMesh);
+
+        // a cached mesh is uploaded straight from the mapped file
+        const MeshView mesh = getMeshView(model);
+
+        if (model.pLodChain != nullptr)
+            return createVao(mesh.pVertices, mesh.vertexCount, model.pLodChain->indices.data(), model.pLodChain->indices.size());
+
+        return createVao(mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount);
+    }
+
+    Vao::SharedPtr ModelLoader::createVao(const TriangleMesh::Vertex* pVertices, const size_t vertexCount, const uint32_t* pIndices, const size_t indexCount) const
+    {
+        if (vertexCount == 0 || indexCount == 0)
             return nullptr;
 
         const ResourceBindFlags ibBindFlags = Resource::BindFlags::Index | ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         const Buffer::SharedPtr pIndexBuffer = Buffer::createStructured(
             mpDevice.get(),
             sizeof(uint32_t),
-            mpModel->getIndices().size(),
+            indexCount,
             ibBindFlags,
             Buffer::CpuAccess::None,
-            mpModel->getIndices().data()
+            pIndices
         );
 
         const ResourceBindFlags vbBindFlags = Resource::BindFlags::Vertex | ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         const Buffer::SharedPtr pVertexBuffer = Buffer::createStructured(
             mpDevice.get(),
             sizeof(TriangleMesh::Vertex),
-            mpModel->getVertices().size(),
+            vertexCount,
             vbBindFlags,
             Buffer::CpuAccess::None,
-            mpModel->getVertices().data()
+            pVertices
         );
 
         const VertexLayout::SharedPtr pLayout = VertexLayout::create();
@@ -261,6 +584,39 @@ namespace Falcor::Tutorial
 
         return pVao;
     }
+
+    Vao::SharedPtr ModelLoader::createVao(const VertexPacker::PackedMesh& mesh) const
+    {
+        if (mesh.vertexCount == 0 || mesh.indexCount == 0)
+            return nullptr;
+
+        // raw buffers, a structured buffer can't have a 2 byte stride
+        const Buffer::SharedPtr pIndexBuffer = Buffer::create(
+            mpDevice.get(),
+            mesh.indexData.size(),
+            Resource::BindFlags::Index,
+            Buffer::CpuAccess::None,
+            mesh.indexData.data()
+        );
+
+        const Buffer::SharedPtr pVertexBuffer = Buffer::create(
+            mpDevice.get(),
+            mesh.vertexData.size(),
+            Resource::BindFlags::Vertex,
+            Buffer::CpuAccess::None,
+            mesh.vertexData.data()
+        );
+
+        const VertexLayout::SharedPtr pLayout = VertexLayout::create();
+        const VertexBufferLayout::SharedPtr pBufLayout = VertexBufferLayout::create();
+        pBufLayout->addElement("POSOBJ", mesh.position.offset, mesh.position.format, 1, 0);
+        pBufLayout->addElement("NORMAL", mesh.normal.offset, mesh.normal.format, 1, 1);
+        pBufLayout->addElement("TEXCOORD", mesh.texCoord.offset, mesh.texCoord.format, 1, 2);
+        pLayout->addBufferLayout(0, pBufLayout);
+
+        const Vao::BufferVec buffers{ pVertexBuffer };
+        return Vao::create(Vao::Topology::TriangleList, pLayout, buffers, pIndexBuffer, mesh.indexFormat);
+    }
 }
 
 int main()
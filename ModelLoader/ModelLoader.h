@@ -5,6 +5,14 @@
 #include "Core/SampleApp.h"
 #include "Scene/TriangleMesh.h"
 
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "VertexPacker.h"
+
+#include <future>
+
 namespace Falcor::Tutorial
 {
     class ModelLoader final : public SampleApp
@@ -36,12 +44,77 @@ namespace Falcor::Tutorial
         {
             bool showFPS = true;
             bool useCustomLoader = true;
+            MeshLoader::ParseMode parseMode = MeshLoader::ParseMode::Parallel;
+            bool useMeshCache = true;
+            MeshOptimizer::Options optimizerOptions;
+            bool buildMeshlets = false;
+            bool buildLods = false;
+            MeshSimplifier::Options simplifierOptions;
+            bool autoSelectLod = true;
+            float maxLodPixelError = 1.f;
+            uint32_t forcedLod = 0;
+            VertexPacker::Options packingOptions;
             RasterizerState::FillMode fillMode = RasterizerState::FillMode::Solid;
             RasterizerState::CullMode cullMode = RasterizerState::CullMode::Back;
             DirectionalLightProperties lightSettings;
             ModelProperties modelSettings;
         };
 
+        // everything a background load produces, the gpu upload happens on the render thread
+        struct LoadedModel
+        {
+            TriangleMesh::SharedPtr pMesh;
+            MeshCache::SharedPtr pMeshCache;
+            MeshOptimizer::Report optimizationReport;
+
+            // set if the vertices and indices were converted into smaller formats
+            std::shared_ptr<VertexPacker::PackedMesh> pPackedMesh;
+            VertexPacker::RoundTripError packingError;
+
+            // set if meshlets were requested, built from the optimized order so they follow the vertex cache order
+            std::shared_ptr<MeshletBuilder::MeshletMesh> pMeshlets;
+            MeshletBuilder::Statistics meshletStatistics;
+            std::string meshletValidationError;
+
+            // set if lods were requested, the lods share the vertices of the mesh, their indices replace the mesh's
+            std::shared_ptr<MeshSimplifier::LodChain> pLodChain;
+        };
+
+        // the arrays of the full detail mesh, wherever the model keeps them
+        struct MeshView
+        {
+            const TriangleMesh::Vertex* pVertices = nullptr;
+            size_t vertexCount = 0;
+            const uint32_t* pIndices = nullptr;
+            size_t indexCount = 0;
+        };
+
+        // what the shaders and the gui need to know about the model that's currently drawn
+        struct DrawnModelInfo
+        {
+            size_t vertexCount = 0;
+            size_t indexCount = 0;
+            uint32_t vertexStride = sizeof(TriangleMesh::Vertex);
+            ResourceFormat indexFormat = ResourceFormat::R32Uint;
+
+            float3 positionScale = float3(1.f);
+            float3 positionOffset = float3(0.f);
+            float2 texCoordScale = float2(1.f);
+            float2 texCoordOffset = float2(0.f);
+            bool hasOctahedralNormals = false;
+
+            MeshOptimizer::Report optimizationReport;
+            VertexPacker::RoundTripError packingError;
+
+            bool hasMeshlets = false;
+            MeshletBuilder::Statistics meshletStatistics;
+            std::string meshletValidationError;
+
+            // a single lod covering the whole index buffer if no lods were built, the indices are only on the gpu
+            MeshSimplifier::LodChain lodChain;
+            uint32_t drawnLod = 0;
+        };
+
         explicit ModelLoader(const SampleAppConfig& config);
 
         // SampleApp implementation
@@ -56,18 +129,30 @@ namespace Falcor::Tutorial
         // mesh loading
         void loadModel();
         void loadTexture();
-        void loadModelFalcor(const std::filesystem::path& path);
-        void loadModelFromObj(const std::filesystem::path& path);
+        void swapInLoadedModel();
+        bool isLoadingModel() const { return mPendingModel.valid(); }
+        // these run on a worker thread
+        static LoadedModel loadModelFalcor(const std::filesystem::path& path);
+        static LoadedModel loadModelFromObj(const std::filesystem::path& path, const ModelLoaderSettings& settings, MeshLoader::Progress& progress);
+        static void optimizeModel(LoadedModel& model, const MeshOptimizer::Options& options);
+        static void buildMeshlets(LoadedModel& model);
+        static void buildLods(LoadedModel& model, const MeshSimplifier::Options& options);
+        static MeshView getMeshView(const LoadedModel& model);
+        static void packModel(LoadedModel& model, const VertexPacker::Options& options);
 
         // rendering
-        Vao::SharedPtr createVao() const;
+        Vao::SharedPtr createVao(const LoadedModel& model) const;
+        Vao::SharedPtr createVao(const TriangleMesh::Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount) const;
+        Vao::SharedPtr createVao(const VertexPacker::PackedMesh& mesh) const;
+
+        // picks the lod to draw from the size of the model on the screen
+        uint32_t selectLod(const Fbo::SharedPtr& pTargetFbo) const;
 
         // settings
         void applyRasterStateSettings() const;
 
         Camera::SharedPtr mpCamera;
         FirstPersonCameraControllerCommon<false>::SharedPtr mpCameraController;
-        TriangleMesh::SharedPtr mpModel;
         Texture::SharedPtr mpTexture;
 
         Sampler::SharedPtr mpTextureSampler;
@@ -77,6 +162,12 @@ namespace Falcor::Tutorial
         GraphicsProgram::SharedPtr mpProgram;
         bool mReadyToDraw = false;
 
+        // the worker writes the progress until it's done, so it's declared first and destroyed after the future waited for it
+        MeshLoader::Progress mLoadProgress{0.f};
+        // the model being loaded in the background, the current one is drawn until it's ready
+        std::future<LoadedModel> mPendingModel;
+        DrawnModelInfo mModelInfo;
+
         FrameRate mFrameRate;
         ModelLoaderSettings mSettings;
     };
@@ -0,0 +1,408 @@
+#include "VertexPacker.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        constexpr float kPi = 3.14159265358979323846f;
+
+        uint32_t getFormatSize(const ResourceFormat format)
+        {
+            switch (format)
+            {
+            case ResourceFormat::RGB32Float:
+                return 12;
+            case ResourceFormat::RG32Float:
+            case ResourceFormat::RGBA16Unorm:
+            case ResourceFormat::RGBA16Snorm:
+                return 8;
+            default:
+                return 4;
+            }
+        }
+
+        int16_t toSnorm16(const float v)
+        {
+            return static_cast<int16_t>(std::lround(std::clamp(v, -1.f, 1.f) * 32767.f));
+        }
+
+        // same as the d3d/vulkan conversion rules: -32768 and -32767 both map to -1
+        float fromSnorm16(const int16_t v)
+        {
+            return std::max(static_cast<float>(v) / 32767.f, -1.f);
+        }
+
+        uint16_t toUnorm16(const float v)
+        {
+            return static_cast<uint16_t>(std::lround(std::clamp(v, 0.f, 1.f) * 65535.f));
+        }
+
+        float fromUnorm16(const uint16_t v)
+        {
+            return static_cast<float>(v) / 65535.f;
+        }
+
+        // ieee 754 binary16, rounding to nearest even
+        uint16_t toHalf(const float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+            // nan and inf
+            if (absBits >= 0x7F800000u)
+                return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+
+            // overflows to inf
+            if (absBits >= 0x477FF000u)
+                return static_cast<uint16_t>(sign | 0x7C00u);
+
+            // normal halfs
+            if (absBits >= 0x38800000u)
+            {
+                const uint32_t rounded = absBits + 0xFFFu + ((absBits >> 13) & 1u);
+                return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+            }
+
+            // subnormal halfs, or zero
+            if (absBits < 0x33000000u)
+                return static_cast<uint16_t>(sign);
+
+            const uint32_t exponent = absBits >> 23;
+            const uint32_t mantissa = (absBits & 0x7FFFFFu) | 0x800000u;
+            const uint32_t shift = 126u - exponent;
+            const uint32_t halfMantissa = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            const uint32_t halfway = 1u << (shift - 1u);
+            const uint32_t roundUp = (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) ? 1u : 0u;
+            return static_cast<uint16_t>(sign | (halfMantissa + roundUp));
+        }
+
+        float fromHalf(const uint16_t value)
+        {
+            const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+            const uint32_t exponent = (value >> 10) & 0x1Fu;
+            const uint32_t mantissa = value & 0x3FFu;
+
+            float result;
+            if (exponent == 0)
+            {
+                result = std::ldexp(static_cast<float>(mantissa), -24);
+            }
+            else if (exponent == 31)
+            {
+                result = mantissa == 0 ? std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN();
+            }
+            else
+            {
+                const uint32_t bits = ((exponent + 112u) << 23) | (mantissa << 13);
+                std::memcpy(&result, &bits, sizeof(result));
+            }
+
+            return sign != 0 ? -result : result;
+        }
+
+        float signNotZero(const float v)
+        {
+            return v >= 0.f ? 1.f : -1.f;
+        }
+
+        // projects the unit sphere onto an octahedron, then unfolds the lower half onto the corners of the square
+        float2 encodeOctahedral(float3 n)
+        {
+            const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+            if (l1 == 0.f)
+                return float2(0.f);
+
+            n /= l1;
+            if (n.z < 0.f)
+                return float2((1.f - std::abs(n.y)) * signNotZero(n.x), (1.f - std::abs(n.x)) * signNotZero(n.y));
+
+            return float2(n.x, n.y);
+        }
+
+        // same as decode_octahedral in ModelLoader.vs.slang
+        float3 decodeOctahedral(const float2 e)
+        {
+            float3 n(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+            const float t = std::max(-n.z, 0.f);
+            n.x += n.x >= 0.f ? -t : t;
+            n.y += n.y >= 0.f ? -t : t;
+            return normalize(n);
+        }
+
+        float normalizeInRange(const float v, const float offset, const float scale)
+        {
+            return scale == 0.f ? 0.f : (v - offset) / scale;
+        }
+
+        template<typename T>
+        void write(std::vector<uint8_t>& data, const size_t offset, const T& value)
+        {
+            std::memcpy(data.data() + offset, &value, sizeof(T));
+        }
+
+        template<typename T>
+        T read(const std::vector<uint8_t>& data, const size_t offset)
+        {
+            T value;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            return value;
+        }
+    }
+
+    VertexPacker::PackedMesh VertexPacker::pack(const TriangleMesh::Vertex* pVertices, const size_t vertexCount, const uint32_t* pIndices, const size_t indexCount, const Options& options)
+    {
+        PackedMesh mesh;
+        mesh.options = options;
+        mesh.vertexCount = vertexCount;
+        mesh.indexCount = indexCount;
+
+        // layout
+        mesh.position.format = options.positionFormat == PositionFormat::Float ? ResourceFormat::RGB32Float : ResourceFormat::RGBA16Unorm;
+
+        switch (options.normalFormat)
+        {
+        case NormalFormat::Float: mesh.normal.format = ResourceFormat::RGB32Float; break;
+        case NormalFormat::Snorm16: mesh.normal.format = ResourceFormat::RGBA16Snorm; break;
+        case NormalFormat::Octahedral: mesh.normal.format = ResourceFormat::RG16Snorm; break;
+        }
+
+        switch (options.texCoordFormat)
+        {
+        case TexCoordFormat::Float: mesh.texCoord.format = ResourceFormat::RG32Float; break;
+        case TexCoordFormat::Half: mesh.texCoord.format = ResourceFormat::RG16Float; break;
+        case TexCoordFormat::Unorm16: mesh.texCoord.format = ResourceFormat::RG16Unorm; break;
+        }
+
+        mesh.position.offset = 0;
+        mesh.normal.offset = mesh.position.offset + getFormatSize(mesh.position.format);
+        mesh.texCoord.offset = mesh.normal.offset + getFormatSize(mesh.normal.format);
+        mesh.vertexStride = mesh.texCoord.offset + getFormatSize(mesh.texCoord.format);
+
+        // quantization ranges
+        if (vertexCount > 0 && options.positionFormat == PositionFormat::Unorm16)
+        {
+            float3 boundsMin = pVertices[0].position;
+            float3 boundsMax = pVertices[0].position;
+            for (size_t i = 1; i < vertexCount; i++)
+            {
+                boundsMin = min(boundsMin, pVertices[i].position);
+                boundsMax = max(boundsMax, pVertices[i].position);
+            }
+
+            mesh.positionOffset = boundsMin;
+            mesh.positionScale = boundsMax - boundsMin;
+        }
+
+        if (vertexCount > 0 && options.texCoordFormat == TexCoordFormat::Unorm16)
+        {
+            float2 boundsMin = pVertices[0].texCoord;
+            float2 boundsMax = pVertices[0].texCoord;
+            for (size_t i = 1; i < vertexCount; i++)
+            {
+                boundsMin = min(boundsMin, pVertices[i].texCoord);
+                boundsMax = max(boundsMax, pVertices[i].texCoord);
+            }
+
+            mesh.texCoordOffset = boundsMin;
+            mesh.texCoordScale = boundsMax - boundsMin;
+        }
+
+        // vertices
+        mesh.vertexData.resize(vertexCount * mesh.vertexStride);
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const TriangleMesh::Vertex& v = pVertices[i];
+            const size_t base = i * mesh.vertexStride;
+
+            if (options.positionFormat == PositionFormat::Float)
+            {
+                write(mesh.vertexData, base + mesh.position.offset, v.position);
+            }
+            else
+            {
+                const uint16_t packed[4] = {
+                    toUnorm16(normalizeInRange(v.position.x, mesh.positionOffset.x, mesh.positionScale.x)),
+                    toUnorm16(normalizeInRange(v.position.y, mesh.positionOffset.y, mesh.positionScale.y)),
+                    toUnorm16(normalizeInRange(v.position.z, mesh.positionOffset.z, mesh.positionScale.z)),
+                    0
+                };
+                write(mesh.vertexData, base + mesh.position.offset, packed);
+            }
+
+            if (options.normalFormat == NormalFormat::Float)
+            {
+                write(mesh.vertexData, base + mesh.normal.offset, v.normal);
+            }
+            else if (options.normalFormat == NormalFormat::Snorm16)
+            {
+                const float3 n = length(v.normal) > 0.f ? normalize(v.normal) : v.normal;
+                const int16_t packed[4] = {toSnorm16(n.x), toSnorm16(n.y), toSnorm16(n.z), 0};
+                write(mesh.vertexData, base + mesh.normal.offset, packed);
+            }
+            else
+            {
+                const float2 e = encodeOctahedral(v.normal);
+                const int16_t packed[2] = {toSnorm16(e.x), toSnorm16(e.y)};
+                write(mesh.vertexData, base + mesh.normal.offset, packed);
+            }
+
+            if (options.texCoordFormat == TexCoordFormat::Float)
+            {
+                write(mesh.vertexData, base + mesh.texCoord.offset, v.texCoord);
+            }
+            else if (options.texCoordFormat == TexCoordFormat::Half)
+            {
+                const uint16_t packed[2] = {toHalf(v.texCoord.x), toHalf(v.texCoord.y)};
+                write(mesh.vertexData, base + mesh.texCoord.offset, packed);
+            }
+            else
+            {
+                const uint16_t packed[2] = {
+                    toUnorm16(normalizeInRange(v.texCoord.x, mesh.texCoordOffset.x, mesh.texCoordScale.x)),
+                    toUnorm16(normalizeInRange(v.texCoord.y, mesh.texCoordOffset.y, mesh.texCoordScale.y))
+                };
+                write(mesh.vertexData, base + mesh.texCoord.offset, packed);
+            }
+        }
+
+        // indices
+        const bool use16BitIndices = options.allow16BitIndices && vertexCount <= std::numeric_limits<uint16_t>::max() + size_t(1);
+
+        if (use16BitIndices)
+        {
+            mesh.indexFormat = ResourceFormat::R16Uint;
+            mesh.indexData.resize(indexCount * sizeof(uint16_t));
+            for (size_t i = 0; i < indexCount; i++)
+                write(mesh.indexData, i * sizeof(uint16_t), static_cast<uint16_t>(pIndices[i]));
+        }
+        else
+        {
+            mesh.indexFormat = ResourceFormat::R32Uint;
+            mesh.indexData.resize(indexCount * sizeof(uint32_t));
+            std::memcpy(mesh.indexData.data(), pIndices, mesh.indexData.size());
+        }
+
+        return mesh;
+    }
+
+    TriangleMesh::Vertex VertexPacker::unpackVertex(const PackedMesh& mesh, const size_t vertexIndex)
+    {
+        TriangleMesh::Vertex v{};
+        const size_t base = vertexIndex * mesh.vertexStride;
+
+        if (mesh.options.positionFormat == PositionFormat::Float)
+        {
+            v.position = read<float3>(mesh.vertexData, base + mesh.position.offset);
+        }
+        else
+        {
+            const auto packed = read<std::array<uint16_t, 4>>(mesh.vertexData, base + mesh.position.offset);
+            const float3 normalized(fromUnorm16(packed[0]), fromUnorm16(packed[1]), fromUnorm16(packed[2]));
+            v.position = normalized * mesh.positionScale + mesh.positionOffset;
+        }
+
+        if (mesh.options.normalFormat == NormalFormat::Float)
+        {
+            v.normal = read<float3>(mesh.vertexData, base + mesh.normal.offset);
+        }
+        else if (mesh.options.normalFormat == NormalFormat::Snorm16)
+        {
+            const auto packed = read<std::array<int16_t, 4>>(mesh.vertexData, base + mesh.normal.offset);
+            v.normal = float3(fromSnorm16(packed[0]), fromSnorm16(packed[1]), fromSnorm16(packed[2]));
+        }
+        else
+        {
+            const auto packed = read<std::array<int16_t, 2>>(mesh.vertexData, base + mesh.normal.offset);
+            v.normal = decodeOctahedral(float2(fromSnorm16(packed[0]), fromSnorm16(packed[1])));
+        }
+
+        if (mesh.options.texCoordFormat == TexCoordFormat::Float)
+        {
+            v.texCoord = read<float2>(mesh.vertexData, base + mesh.texCoord.offset);
+        }
+        else if (mesh.options.texCoordFormat == TexCoordFormat::Half)
+        {
+            const auto packed = read<std::array<uint16_t, 2>>(mesh.vertexData, base + mesh.texCoord.offset);
+            v.texCoord = float2(fromHalf(packed[0]), fromHalf(packed[1]));
+        }
+        else
+        {
+            const auto packed = read<std::array<uint16_t, 2>>(mesh.vertexData, base + mesh.texCoord.offset);
+            const float2 normalized(fromUnorm16(packed[0]), fromUnorm16(packed[1]));
+            v.texCoord = normalized * mesh.texCoordScale + mesh.texCoordOffset;
+        }
+
+        return v;
+    }
+
+    uint32_t VertexPacker::unpackIndex(const PackedMesh& mesh, const size_t index)
+    {
+        if (mesh.indexFormat == ResourceFormat::R16Uint)
+            return read<uint16_t>(mesh.indexData, index * sizeof(uint16_t));
+
+        return read<uint32_t>(mesh.indexData, index * sizeof(uint32_t));
+    }
+
+    VertexPacker::RoundTripError VertexPacker::measureRoundTripError(
+        const TriangleMesh::Vertex* pVertices,
+        const size_t vertexCount,
+        const uint32_t* pIndices,
+        const size_t indexCount,
+        const PackedMesh& mesh
+    )
+    {
+        RoundTripError error;
+
+        if (vertexCount != mesh.vertexCount || indexCount != mesh.indexCount)
+        {
+            error.indicesMatch = false;
+            return error;
+        }
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const TriangleMesh::Vertex& original = pVertices[i];
+            const TriangleMesh::Vertex unpacked = unpackVertex(mesh, i);
+
+            error.maxPositionError = std::max(error.maxPositionError, length(unpacked.position - original.position));
+
+            // only the direction of a normal matters, the shader normalizes it anyway
+            if (length(original.normal) > 0.f && length(unpacked.normal) > 0.f)
+            {
+                // atan2 stays accurate for tiny angles, acos(dot) doesn't
+                const float3 a = normalize(original.normal);
+                const float3 b = normalize(unpacked.normal);
+                const float angle = std::atan2(length(cross(a, b)), dot(a, b));
+                error.maxNormalErrorDegrees = std::max(error.maxNormalErrorDegrees, angle * 180.f / kPi);
+            }
+
+            const float2 texCoordDiff = unpacked.texCoord - original.texCoord;
+            error.maxTexCoordError = std::max({error.maxTexCoordError, std::abs(texCoordDiff.x), std::abs(texCoordDiff.y)});
+        }
+
+        for (size_t i = 0; i < indexCount && error.indicesMatch; i++)
+            error.indicesMatch = unpackIndex(mesh, i) == pIndices[i];
+
+        return error;
+    }
+
+    bool VertexPacker::isIdentity(const Options& options, const size_t vertexCount)
+    {
+        const bool has16BitIndices = options.allow16BitIndices && vertexCount <= std::numeric_limits<uint16_t>::max() + size_t(1);
+
+        return !has16BitIndices &&
+               options.positionFormat == PositionFormat::Float &&
+               options.normalFormat == NormalFormat::Float &&
+               options.texCoordFormat == TexCoordFormat::Float;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core/API/Formats.h"
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * converts TriangleMesh::Vertex (32 bytes, full floats) into smaller gpu vertex formats:
+     *   positions: float or unorm16 relative to the bounding box of the mesh
+     *   normals:   float, snorm16 or octahedral encoded snorm16 (2 components)
+     *   texCoords: float, half or unorm16 relative to the uv bounding box
+     * indices become 16 bit whenever every vertex can be addressed with them.
+     * the shader dequantizes with positionScale/positionOffset and texCoordScale/texCoordOffset.
+     */
+    class VertexPacker
+    {
+    public:
+        enum class PositionFormat : uint32_t
+        {
+            Float,
+            Unorm16
+        };
+
+        enum class NormalFormat : uint32_t
+        {
+            Float,
+            Snorm16,
+            Octahedral
+        };
+
+        enum class TexCoordFormat : uint32_t
+        {
+            Float,
+            Half,
+            Unorm16
+        };
+
+        struct Options
+        {
+            bool allow16BitIndices = true;
+            PositionFormat positionFormat = PositionFormat::Float;
+            NormalFormat normalFormat = NormalFormat::Float;
+            TexCoordFormat texCoordFormat = TexCoordFormat::Float;
+        };
+
+        struct Element
+        {
+            uint32_t offset = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+        };
+
+        struct PackedMesh
+        {
+            Options options;
+
+            std::vector<uint8_t> vertexData;
+            uint32_t vertexStride = 0;
+            size_t vertexCount = 0;
+            Element position;
+            Element normal;
+            Element texCoord;
+
+            std::vector<uint8_t> indexData;
+            ResourceFormat indexFormat = ResourceFormat::R32Uint;
+            size_t indexCount = 0;
+
+            // original = packed * scale + offset, identity for float formats
+            float3 positionScale = float3(1.f);
+            float3 positionOffset = float3(0.f);
+            float2 texCoordScale = float2(1.f);
+            float2 texCoordOffset = float2(0.f);
+        };
+
+        // largest difference between the original and the unpacked vertices
+        struct RoundTripError
+        {
+            float maxPositionError = 0.f;       // in object space units
+            float maxNormalErrorDegrees = 0.f;
+            float maxTexCoordError = 0.f;
+            bool indicesMatch = true;
+        };
+
+        VertexPacker() = delete;
+
+        static PackedMesh pack(const TriangleMesh::Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount, const Options& options);
+
+        // decodes one vertex exactly the way the gpu does
+        static TriangleMesh::Vertex unpackVertex(const PackedMesh& mesh, size_t vertexIndex);
+        static uint32_t unpackIndex(const PackedMesh& mesh, size_t index);
+
+        // unpacks every vertex and index and compares them to the originals
+        static RoundTripError measureRoundTripError(const TriangleMesh::Vertex* pVertices, size_t vertexCount, const uint32_t* pIndices, size_t indexCount, const PackedMesh& mesh);
+
+        // true if packing would produce the same buffers as the original arrays
+        static bool isIdentity(const Options& options, size_t vertexCount);
+    };
+}
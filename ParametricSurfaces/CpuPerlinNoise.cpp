@@ -0,0 +1,455 @@
+#include "CpuPerlinNoise.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PERLIN_NOISE_X86 1
+#include <immintrin.h>
+#else
+#define PERLIN_NOISE_X86 0
+#endif
+
+// gcc and clang only emit avx instructions in functions that ask for them. fma is left out on purpose, the scalar
+// loop doesn't fuse either and the two have to round the same
+#if PERLIN_NOISE_X86 && !defined(_MSC_VER)
+#define PERLIN_NOISE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PERLIN_NOISE_TARGET_AVX2
+#endif
+
+namespace Falcor::Tutorial
+{
+    namespace
+    {
+        // 3.14159265 / ~(~0u >> 1) in random_gradient, the hash times this is an angle in [0, 2 pi]
+        constexpr float kGradientAngleScale = 3.14159265f / 2147483648.f;
+
+        // pi / 2 in three parts, the first two have few enough bits that q * part is exact for the q of [0, 2 pi]
+        constexpr float kHalfPi0 = 1.5703125f;
+        constexpr float kHalfPi1 = 4.837512969970703125e-4f;
+        constexpr float kHalfPi2 = 7.54978995489188216e-8f;
+        constexpr float kTwoOverPi = 0.636619772367581343f;
+
+        // the gradients of the two lattice rows around a row's octave, from lattice column ixBegin on
+        struct GradientRows
+        {
+            uint32_t ixBegin = 0;
+            std::vector<float> x0;
+            std::vector<float> y0;
+            std::vector<float> x1;
+            std::vector<float> y1;
+        };
+
+        // what a row's octave has in common for every sample
+        struct RowOctave
+        {
+            float resolution;
+            float scale;
+            float seed;
+            float fy;
+            float fadeY0;
+            float fadeY1;
+        };
+
+        uint32_t hashLatticePoint(uint32_t a, uint32_t b)
+        {
+            // the shader rotates by s = 128, a 32 bit shift only uses the low 5 bits of the amount, so both shifts
+            // are by 0 and the rotation is the value itself
+            a *= 3284157443u;
+            b ^= a;
+            b *= 1911520717u;
+            a ^= b;
+            a *= 2048419325u;
+            return a;
+        }
+
+        float fade(const float x)
+        {
+            const float v = 1.f - std::abs(x);
+            return ((6.f * v - 15.f) * v + 10.f) * (v * v * v);
+        }
+
+        // cephes' minimax polynomials on [-pi / 4, pi / 4], after taking out the quadrant q
+        void sinCos(const float x, float& s, float& c)
+        {
+            const float q = std::nearbyint(x * kTwoOverPi);
+            const float r = ((x - q * kHalfPi0) - q * kHalfPi1) - q * kHalfPi2;
+            const float z = r * r;
+            const float sinR = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+            const float cosR = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.f;
+
+            const int32_t quadrant = static_cast<int32_t>(q);
+            const bool isSwapped = (quadrant & 1) != 0;
+            s = isSwapped ? cosR : sinR;
+            c = isSwapped ? sinR : cosR;
+            if ((quadrant & 2) != 0)
+                s = -s;
+            if (((quadrant + 1) & 2) != 0)
+                c = -c;
+        }
+
+        float2 getGradientScalar(const uint32_t ix, const uint32_t iy)
+        {
+            const float angle = static_cast<float>(hashLatticePoint(ix, iy)) * kGradientAngleScale;
+            float2 gradient;
+            sinCos(angle, gradient.y, gradient.x);
+            return gradient;
+        }
+
+        // the four corners of noise() in the shader's order: bottom left, bottom right, top left, top right
+        float sumCorners(const float fx, const RowOctave& row, const float g00x, const float g00y, const float g10x, const float g10y, const float g01x, const float g01y, const float g11x, const float g11y)
+        {
+            const float fx1 = fx - 1.f;
+            const float fy1 = row.fy - 1.f;
+            const float fadeX0 = fade(fx);
+            const float fadeX1 = fade(fx1);
+            return (g00x * fx + g00y * row.fy) * fadeX0 * row.fadeY0 + (g10x * fx1 + g10y * row.fy) * fadeX1 * row.fadeY0 +
+                   (g01x * fx + g01y * fy1) * fadeX0 * row.fadeY1 + (g11x * fx1 + g11y * fy1) * fadeX1 * row.fadeY1;
+        }
+
+        float getLatticeCoordinate(const RowOctave& row, const uint32_t x)
+        {
+            return (static_cast<float>(x) / row.resolution) * row.scale + row.seed;
+        }
+
+        void addOctaveScalar(const RowOctave& row, const GradientRows& gradients, const float weight, const uint32_t x0, const uint32_t x1, float* pHeights)
+        {
+            for (uint32_t x = x0; x < x1; x++)
+            {
+                const float vx = getLatticeCoordinate(row, x);
+                const float cell = std::floor(vx);
+                const uint32_t i = static_cast<uint32_t>(cell) - gradients.ixBegin;
+                const float noise = sumCorners(
+                    vx - cell, row, gradients.x0[i], gradients.y0[i], gradients.x0[i + 1], gradients.y0[i + 1], gradients.x1[i], gradients.y1[i],
+                    gradients.x1[i + 1], gradients.y1[i + 1]
+                );
+                pHeights[x] += noise * weight;
+            }
+        }
+
+#if PERLIN_NOISE_X86
+        PERLIN_NOISE_TARGET_AVX2 __m256 abs256(const __m256 x)
+        {
+            return _mm256_andnot_ps(_mm256_set1_ps(-0.f), x);
+        }
+
+        PERLIN_NOISE_TARGET_AVX2 __m256 fadeAVX2(const __m256 x)
+        {
+            const __m256 v = _mm256_sub_ps(_mm256_set1_ps(1.f), abs256(x));
+            const __m256 polynomial = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(6.f), v), _mm256_set1_ps(15.f)), v), _mm256_set1_ps(10.f));
+            return _mm256_mul_ps(polynomial, _mm256_mul_ps(_mm256_mul_ps(v, v), v));
+        }
+
+        // sinCos, lane by lane
+        PERLIN_NOISE_TARGET_AVX2 void sinCosAVX2(const __m256 x, __m256& s, __m256& c)
+        {
+            const __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kTwoOverPi)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m256 r = _mm256_sub_ps(
+                _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(kHalfPi0))), _mm256_mul_ps(q, _mm256_set1_ps(kHalfPi1))),
+                _mm256_mul_ps(q, _mm256_set1_ps(kHalfPi2))
+            );
+            const __m256 z = _mm256_mul_ps(r, r);
+
+            __m256 sinR = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.9515295891e-4f), z), _mm256_set1_ps(8.3321608736e-3f));
+            sinR = _mm256_sub_ps(_mm256_mul_ps(sinR, z), _mm256_set1_ps(1.6666654611e-1f));
+            sinR = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinR, z), r), r);
+
+            __m256 cosR = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.443315711809948e-5f), z), _mm256_set1_ps(1.388731625493765e-3f));
+            cosR = _mm256_add_ps(_mm256_mul_ps(cosR, z), _mm256_set1_ps(4.166664568298827e-2f));
+            cosR = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(cosR, z), z), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_set1_ps(1.f));
+
+            const __m256i quadrant = _mm256_cvtps_epi32(q);
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i two = _mm256_set1_epi32(2);
+            const __m256 isSwapped = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+            const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+            const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+            s = _mm256_xor_ps(_mm256_blendv_ps(sinR, cosR, isSwapped), sinSign);
+            c = _mm256_xor_ps(_mm256_blendv_ps(cosR, sinR, isSwapped), cosSign);
+        }
+
+        // getGradientScalar of lattice columns ix, ix + 1, ... ix + 7 in lattice row iy
+        PERLIN_NOISE_TARGET_AVX2 void getGradientsAVX2(const uint32_t ix, const uint32_t iy, float* pX, float* pY)
+        {
+            __m256i a = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(ix)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i b = _mm256_set1_epi32(static_cast<int32_t>(iy));
+            a = _mm256_mullo_epi32(a, _mm256_set1_epi32(static_cast<int32_t>(3284157443u)));
+            b = _mm256_xor_si256(b, a);
+            b = _mm256_mullo_epi32(b, _mm256_set1_epi32(1911520717));
+            a = _mm256_xor_si256(a, b);
+            a = _mm256_mullo_epi32(a, _mm256_set1_epi32(2048419325));
+
+            // there is no unsigned conversion, the halves are exact and their sum rounds once like the scalar cast
+            const __m256 high = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(a, 16)), _mm256_set1_ps(65536.f));
+            const __m256 low = _mm256_cvtepi32_ps(_mm256_and_si256(a, _mm256_set1_epi32(0xFFFF)));
+            const __m256 angle = _mm256_mul_ps(_mm256_add_ps(high, low), _mm256_set1_ps(kGradientAngleScale));
+
+            __m256 s;
+            __m256 c;
+            sinCosAVX2(angle, s, c);
+            _mm256_storeu_ps(pX, c);
+            _mm256_storeu_ps(pY, s);
+        }
+
+        PERLIN_NOISE_TARGET_AVX2 void addOctaveAVX2(const RowOctave& row, const GradientRows& gradients, const float weight, const uint32_t width, float* pHeights)
+        {
+            const __m256 resolution = _mm256_set1_ps(row.resolution);
+            const __m256 scale = _mm256_set1_ps(row.scale);
+            const __m256 seed = _mm256_set1_ps(row.seed);
+            const __m256 fy = _mm256_set1_ps(row.fy);
+            const __m256 fy1 = _mm256_set1_ps(row.fy - 1.f);
+            const __m256 fadeY0 = _mm256_set1_ps(row.fadeY0);
+            const __m256 fadeY1 = _mm256_set1_ps(row.fadeY1);
+            const __m256 one = _mm256_set1_ps(1.f);
+            const __m256i ixBegin = _mm256_set1_epi32(static_cast<int32_t>(gradients.ixBegin));
+            const __m256i next = _mm256_set1_epi32(1);
+
+            uint32_t x = 0;
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m256 xs = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(x)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+                const __m256 vx = _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(xs, resolution), scale), seed);
+                const __m256 cell = _mm256_floor_ps(vx);
+                const __m256 fx = _mm256_sub_ps(vx, cell);
+                const __m256 fx1 = _mm256_sub_ps(fx, one);
+                const __m256i i0 = _mm256_sub_epi32(_mm256_cvttps_epi32(cell), ixBegin);
+                const __m256i i1 = _mm256_add_epi32(i0, next);
+
+                const __m256 fadeX0 = fadeAVX2(fx);
+                const __m256 fadeX1 = fadeAVX2(fx1);
+
+                const __m256 bottomLeft = _mm256_mul_ps(
+                    _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(gradients.x0.data(), i0, 4), fx), _mm256_mul_ps(_mm256_i32gather_ps(gradients.y0.data(), i0, 4), fy)), fadeX0),
+                    fadeY0
+                );
+                const __m256 bottomRight = _mm256_mul_ps(
+                    _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(gradients.x0.data(), i1, 4), fx1), _mm256_mul_ps(_mm256_i32gather_ps(gradients.y0.data(), i1, 4), fy)), fadeX1),
+                    fadeY0
+                );
+                const __m256 topLeft = _mm256_mul_ps(
+                    _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(gradients.x1.data(), i0, 4), fx), _mm256_mul_ps(_mm256_i32gather_ps(gradients.y1.data(), i0, 4), fy1)), fadeX0),
+                    fadeY1
+                );
+                const __m256 topRight = _mm256_mul_ps(
+                    _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(gradients.x1.data(), i1, 4), fx1), _mm256_mul_ps(_mm256_i32gather_ps(gradients.y1.data(), i1, 4), fy1)), fadeX1),
+                    fadeY1
+                );
+                const __m256 noise = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(bottomLeft, bottomRight), topLeft), topRight);
+
+                _mm256_storeu_ps(pHeights + x, _mm256_add_ps(_mm256_loadu_ps(pHeights + x), _mm256_mul_ps(noise, _mm256_set1_ps(weight))));
+            }
+
+            addOctaveScalar(row, gradients, weight, x, width, pHeights);
+        }
+#endif
+
+        void fillGradientRow(const CpuPerlinNoise::InstructionSet instructionSet, const uint32_t ixBegin, const uint32_t iy, const size_t count, float* pX, float* pY)
+        {
+            size_t i = 0;
+#if PERLIN_NOISE_X86
+            if (instructionSet == CpuPerlinNoise::InstructionSet::AVX2)
+            {
+                for (; i + 8 <= count; i += 8)
+                    getGradientsAVX2(ixBegin + static_cast<uint32_t>(i), iy, pX + i, pY + i);
+            }
+#endif
+            for (; i < count; i++)
+            {
+                const float2 gradient = getGradientScalar(ixBegin + static_cast<uint32_t>(i), iy);
+                pX[i] = gradient.x;
+                pY[i] = gradient.y;
+            }
+        }
+
+        void computeRow(
+            const CpuPerlinNoise::InstructionSet instructionSet,
+            const CpuPerlinNoise::Settings& settings,
+            const uint32_t y,
+            GradientRows& gradients,
+            float* pHeights
+        )
+        {
+            const uint32_t width = settings.resolution;
+            std::fill(pHeights, pHeights + width, 0.f);
+            if (width == 0)
+                return;
+
+            for (uint32_t octave = 0; octave < settings.octaves; octave++)
+            {
+                RowOctave row;
+                row.resolution = static_cast<float>(settings.resolution);
+                row.scale = std::ldexp(1.f, static_cast<int>(octave));
+                row.seed = settings.seed;
+
+                // the seed only moves x, y + 0 is y
+                const float vy = (static_cast<float>(y) / row.resolution) * row.scale;
+                const float cellY = std::floor(vy);
+                row.fy = vy - cellY;
+                row.fadeY0 = fade(row.fy);
+                row.fadeY1 = fade(row.fy - 1.f);
+                const uint32_t iy = static_cast<uint32_t>(cellY);
+
+                // the lattice coordinate grows with x, so the row starts in the first sample's cell and ends next to the last one's
+                gradients.ixBegin = static_cast<uint32_t>(std::floor(getLatticeCoordinate(row, 0)));
+                const uint32_t ixEnd = static_cast<uint32_t>(std::floor(getLatticeCoordinate(row, width - 1))) + 2;
+                const size_t count = ixEnd - gradients.ixBegin;
+                for (std::vector<float>* pArray : {&gradients.x0, &gradients.y0, &gradients.x1, &gradients.y1})
+                    pArray->resize(count);
+                fillGradientRow(instructionSet, gradients.ixBegin, iy, count, gradients.x0.data(), gradients.y0.data());
+                fillGradientRow(instructionSet, gradients.ixBegin, static_cast<uint32_t>(cellY + 1.f), count, gradients.x1.data(), gradients.y1.data());
+
+                const float weight = std::ldexp(1.f, -static_cast<int>(octave + 2));
+#if PERLIN_NOISE_X86
+                if (instructionSet == CpuPerlinNoise::InstructionSet::AVX2)
+                {
+                    addOctaveAVX2(row, gradients, weight, width, pHeights);
+                    continue;
+                }
+#endif
+                addOctaveScalar(row, gradients, weight, 0, width, pHeights);
+            }
+        }
+
+        float halfToFloat(const uint16_t half)
+        {
+            const uint32_t sign = uint32_t(half & 0x8000) << 16;
+            const uint32_t exponent = (half >> 10) & 0x1F;
+            const uint32_t mantissa = half & 0x3FF;
+
+            float magnitude;
+            if (exponent == 0)
+                magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+            else if (exponent == 0x1F)
+                magnitude = mantissa == 0 ? INFINITY : NAN;
+            else
+                magnitude = std::ldexp(static_cast<float>(mantissa | 0x400), static_cast<int>(exponent) - 25);
+
+            uint32_t bits;
+            std::memcpy(&bits, &magnitude, sizeof(bits));
+            bits |= sign;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+    }
+
+    CpuPerlinNoise::CpuPerlinNoise(const InstructionSet instructionSet, const uint32_t threadCount)
+        : mInstructionSet(isSupported(instructionSet) ? instructionSet : InstructionSet::Scalar), mpScheduler(std::make_unique<TileScheduler>(threadCount))
+    {
+    }
+
+    void CpuPerlinNoise::setInstructionSet(const InstructionSet instructionSet)
+    {
+        mInstructionSet = isSupported(instructionSet) ? instructionSet : InstructionSet::Scalar;
+    }
+
+    bool CpuPerlinNoise::isSupported(const InstructionSet instructionSet)
+    {
+        if (instructionSet == InstructionSet::AVX2)
+            return CpuFeatures::hasAVX2();
+        return true;
+    }
+
+    CpuPerlinNoise::InstructionSet CpuPerlinNoise::getBestInstructionSet()
+    {
+        return isSupported(InstructionSet::AVX2) ? InstructionSet::AVX2 : InstructionSet::Scalar;
+    }
+
+    std::string CpuPerlinNoise::getName(const InstructionSet instructionSet)
+    {
+        return instructionSet == InstructionSet::AVX2 ? "avx2" : "scalar";
+    }
+
+    CpuPerlinNoise::Statistics CpuPerlinNoise::generate(const Settings& settings, std::vector<float>& heights) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        const uint32_t resolution = settings.resolution;
+        heights.resize(size_t(resolution) * resolution);
+
+        // the gradient rows are reused by every row a thread computes
+        std::vector<GradientRows> gradients(mpScheduler->getThreadCount());
+        mpScheduler->run(resolution, [&](const uint32_t y, const uint32_t threadIndex)
+        {
+            computeRow(mInstructionSet, settings, y, gradients[threadIndex], heights.data() + size_t(y) * resolution);
+        });
+
+        Statistics statistics;
+        statistics.instructionSet = mInstructionSet;
+        statistics.threadCount = mpScheduler->getThreadCount();
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        statistics.megasamplesPerSecond = statistics.seconds > 0.0 ? double(heights.size()) / statistics.seconds / 1e6 : 0.0;
+        return statistics;
+    }
+
+    void CpuPerlinNoise::generateRow(const Settings& settings, const uint32_t y, float* pHeights) const
+    {
+        GradientRows gradients;
+        computeRow(mInstructionSet, settings, y, gradients, pHeights);
+    }
+
+    float CpuPerlinNoise::sample(const Settings& settings, const uint32_t x, const uint32_t y)
+    {
+        float height = 0.f;
+        for (uint32_t octave = 0; octave < settings.octaves; octave++)
+        {
+            RowOctave row;
+            row.resolution = static_cast<float>(settings.resolution);
+            row.scale = std::ldexp(1.f, static_cast<int>(octave));
+            row.seed = settings.seed;
+
+            const float vx = getLatticeCoordinate(row, x);
+            const float vy = (static_cast<float>(y) / row.resolution) * row.scale;
+            const float cellX = std::floor(vx);
+            const float cellY = std::floor(vy);
+            const uint32_t ix0 = static_cast<uint32_t>(cellX);
+            const uint32_t iy0 = static_cast<uint32_t>(cellY);
+            const uint32_t ix1 = static_cast<uint32_t>(cellX + 1.f);
+            const uint32_t iy1 = static_cast<uint32_t>(cellY + 1.f);
+
+            row.fy = vy - cellY;
+            row.fadeY0 = fade(row.fy);
+            row.fadeY1 = fade(row.fy - 1.f);
+
+            const float2 g00 = getGradientScalar(ix0, iy0);
+            const float2 g10 = getGradientScalar(ix1, iy0);
+            const float2 g01 = getGradientScalar(ix0, iy1);
+            const float2 g11 = getGradientScalar(ix1, iy1);
+            const float noise = sumCorners(vx - cellX, row, g00.x, g00.y, g10.x, g10.y, g01.x, g01.y, g11.x, g11.y);
+            height += noise * std::ldexp(1.f, -static_cast<int>(octave + 2));
+        }
+        return height;
+    }
+
+    float2 CpuPerlinNoise::getGradient(const uint32_t ix, const uint32_t iy)
+    {
+        return getGradientScalar(ix, iy);
+    }
+
+    CpuPerlinNoise::ParityReport CpuPerlinNoise::compare(const std::vector<float>& heights, const std::vector<uint8_t>& texels)
+    {
+        // 4 half channels per texel, the shader writes the height to all of them
+        constexpr size_t kTexelSize = 4 * sizeof(uint16_t);
+
+        ParityReport report;
+        report.texelCount = heights.size();
+        if (texels.size() != heights.size() * kTexelSize)
+        {
+            report.isSizeMatching = false;
+            return report;
+        }
+
+        for (size_t i = 0; i < heights.size(); i++)
+        {
+            uint16_t half;
+            std::memcpy(&half, texels.data() + i * kTexelSize, sizeof(half));
+            report.maxDifference = std::max(report.maxDifference, std::abs(halfToFloat(half) - heights[i]));
+        }
+        return report;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "TileScheduler.h"
+
+#include "Utils/Math/Vector.h"
+
+#include <string>
+#include <vector>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * cpu implementation of the fBm of ParametricSurfaces.cs.slang, for baking and testing height maps without a gpu.
+     * the hash, the gradients, the fade and the octave weights are the shader's, with the same float operations in the
+     * same order. only sin and cos can't be the gpu's: both instruction sets use the same polynomial, so their heights
+     * are bit identical, and they are a few 1e-7 off the gpu's before the texture rounds them to half precision.
+     * a row's octave only touches the lattice points of two lattice rows, their gradients are computed once and shared
+     * by every sample between them, 8 samples at a time with avx2. rows are spread over the cores.
+     */
+    class CpuPerlinNoise
+    {
+    public:
+        enum class InstructionSet : uint32_t
+        {
+            Scalar,
+            AVX2
+        };
+
+        // the shader's res and the seed and octaves of a NoiseLayerDesc
+        struct Settings
+        {
+            uint32_t resolution = 512;  // res, the texture is resolution x resolution texels
+            float seed = 0.f;           // moves the lattice along x, not negative like the renderer's
+            uint32_t octaves = 6;
+        };
+
+        struct Statistics
+        {
+            double seconds = 0.0;
+            double megasamplesPerSecond = 0.0;
+            InstructionSet instructionSet = InstructionSet::Scalar;
+            uint32_t threadCount = 1;
+        };
+
+        // the largest difference between the heights and a texture the shader wrote
+        struct ParityReport
+        {
+            float maxDifference = 0.f;
+            size_t texelCount = 0;
+            bool isSizeMatching = true;
+
+            // half precision keeps 11 bits of the heights, which stay below 1
+            bool isMatching(float tolerance = 1e-3f) const { return isSizeMatching && maxDifference <= tolerance; }
+        };
+
+        explicit CpuPerlinNoise(InstructionSet instructionSet = getBestInstructionSet(), uint32_t threadCount = std::thread::hardware_concurrency());
+
+        static bool isSupported(InstructionSet instructionSet);
+        static InstructionSet getBestInstructionSet();
+        static std::string getName(InstructionSet instructionSet);
+
+        InstructionSet getInstructionSet() const { return mInstructionSet; }
+        // falls back to scalar if the cpu doesn't support it
+        void setInstructionSet(InstructionSet instructionSet);
+        uint32_t getThreadCount() const { return mpScheduler->getThreadCount(); }
+
+        // the height of every texel row by row, the value the shader writes to every channel
+        Statistics generate(const Settings& settings, std::vector<float>& heights) const;
+        // heights of row y, written to pHeights[0, resolution)
+        void generateRow(const Settings& settings, uint32_t y, float* pHeights) const;
+
+        // one texel straight from the shader's formulas, without sharing the gradients
+        static float sample(const Settings& settings, uint32_t x, uint32_t y);
+        // random_gradient, the unit vector of a lattice point
+        static float2 getGradient(uint32_t ix, uint32_t iy);
+
+        // texels is a readback of the layer of the RGBA16Float texture array the shader wrote with the same settings
+        static ParityReport compare(const std::vector<float>& heights, const std::vector<uint8_t>& texels);
+
+    private:
+        InstructionSet mInstructionSet;
+        std::unique_ptr<TileScheduler> mpScheduler;
+    };
+}
@@ -0,0 +1,164 @@
+#include "GpuSurfaceTessellator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor::Tutorial
+{
+    static_assert(sizeof(SurfaceMeshes::Vertex) == kSurfaceVertexSize, "the compute shader writes the vertices byte by byte");
+
+    namespace
+    {
+        const char* kShaderFile = "Samples/ParametricSurfaces/SurfaceTessellation.cs.slang";
+
+        // past this many groups in x the dispatch wraps into y
+        constexpr uint32_t kMaxGroupsPerRow = 32768;
+
+        uint32_t divideRoundingUp(const uint32_t a, const uint32_t b)
+        {
+            return (a + b - 1) / b;
+        }
+
+        uint3 getGroupCount(const uint32_t threadCount)
+        {
+            const uint32_t groupCount = divideRoundingUp(threadCount, GpuSurfaceTessellator::kThreadGroupSize);
+            const uint32_t groupsPerRow = std::clamp(groupCount, 1u, kMaxGroupsPerRow);
+            return uint3(groupsPerRow, divideRoundingUp(groupCount, groupsPerRow), 1);
+        }
+
+        float getDistance(const float3 a, const float3 b)
+        {
+            return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+        }
+    }
+
+    GpuSurfaceTessellator::GpuSurfaceTessellator(const std::shared_ptr<Device>& pDevice) : mpDevice(pDevice)
+    {
+        Program::Desc vertexDesc;
+        vertexDesc.addShaderLibrary(kShaderFile).csEntry("writeVertices");
+        mpVertexProgram = ComputeProgram::create(mpDevice, vertexDesc);
+        mpVertexVars = ComputeVars::create(mpDevice, mpVertexProgram->getReflector());
+
+        Program::Desc indexDesc;
+        indexDesc.addShaderLibrary(kShaderFile).csEntry("writeIndices");
+        mpIndexProgram = ComputeProgram::create(mpDevice, indexDesc);
+        mpIndexVars = ComputeVars::create(mpDevice, mpIndexProgram->getReflector());
+    }
+
+    Buffer::SharedPtr GpuSurfaceTessellator::createVertexBuffer(const size_t vertexCount) const
+    {
+        const auto bindFlags = Resource::BindFlags::Vertex | Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+        return Buffer::create(mpDevice.get(), vertexCount * kSurfaceVertexSize, bindFlags, Buffer::CpuAccess::None, nullptr);
+    }
+
+    Buffer::SharedPtr GpuSurfaceTessellator::createIndexBuffer(const size_t indexCount) const
+    {
+        const auto bindFlags = Resource::BindFlags::Index | Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+        return Buffer::create(mpDevice.get(), indexCount * sizeof(uint32_t), bindFlags, Buffer::CpuAccess::None, nullptr);
+    }
+
+    void GpuSurfaceTessellator::tessellate(
+        RenderContext* pRenderContext,
+        const SurfaceDesc& desc,
+        const Target& target,
+        const Buffer::SharedPtr& pVertexBuffer,
+        const Buffer::SharedPtr& pIndexBuffer
+    ) const
+    {
+        if (target.columns < 2 || target.rows < 2)
+            return;
+
+        const uint32_t vertexCount = static_cast<uint32_t>(getVertexCount(target));
+        const uint32_t quadCount = static_cast<uint32_t>(getIndexCount(target) / 6);
+
+        for (const ComputeVars::SharedPtr& pVars : {mpVertexVars, mpIndexVars})
+        {
+            pVars["SurfaceTessellationCB"]["gSurface"]["type"] = desc.type;
+            pVars["SurfaceTessellationCB"]["gSurface"]["parameter0"] = desc.parameter0;
+            pVars["SurfaceTessellationCB"]["gSurface"]["parameter1"] = desc.parameter1;
+            pVars["SurfaceTessellationCB"]["gColumns"] = target.columns;
+            pVars["SurfaceTessellationCB"]["gRows"] = target.rows;
+            pVars["SurfaceTessellationCB"]["gBaseVertex"] = target.baseVertex;
+            pVars["SurfaceTessellationCB"]["gFirstIndex"] = target.firstIndex;
+            pVars["SurfaceTessellationCB"]["gModelIndex"] = target.modelIndex;
+        }
+
+        const uint3 vertexGroups = getGroupCount(vertexCount);
+        mpVertexVars["SurfaceTessellationCB"]["gThreadsPerRow"] = vertexGroups.x * kThreadGroupSize;
+        mpVertexVars->setBuffer("gVertices", pVertexBuffer);
+        mpVertexProgram->dispatchCompute(pRenderContext, mpVertexVars.get(), vertexGroups);
+
+        const uint3 indexGroups = getGroupCount(quadCount);
+        mpIndexVars["SurfaceTessellationCB"]["gThreadsPerRow"] = indexGroups.x * kThreadGroupSize;
+        mpIndexVars->setBuffer("gIndices", pIndexBuffer);
+        mpIndexProgram->dispatchCompute(pRenderContext, mpIndexVars.get(), indexGroups);
+    }
+
+    void GpuSurfaceTessellator::tessellateReference(const SurfaceDesc& desc, const Target& target, SurfaceMeshes::Vertex* pVertices, uint32_t* pIndices)
+    {
+        if (target.columns < 2 || target.rows < 2)
+            return;
+
+        // writeVertices, one point per thread
+        const uint32_t vertexCount = static_cast<uint32_t>(getVertexCount(target));
+        for (uint32_t point = 0; point < vertexCount; point++)
+        {
+            const float u = getGridCoordinate(point % target.columns, target.columns);
+            const float v = getGridCoordinate(point / target.columns, target.rows);
+            const SurfacePoint surfacePoint = evaluateSurface(desc, u, v);
+
+            SurfaceMeshes::Vertex& vertex = pVertices[target.baseVertex + point];
+            vertex.position = surfacePoint.position;
+            vertex.normal = surfacePoint.normal;
+            vertex.texCoord = {u, v};
+            vertex.modelIndex = target.modelIndex;
+        }
+
+        // writeIndices, one quad per thread
+        const uint32_t quadCount = static_cast<uint32_t>(getIndexCount(target) / 6);
+        for (uint32_t quad = 0; quad < quadCount; quad++)
+        {
+            const uint32_t corner = getGridQuadCorner(target.columns, target.rows, quad);
+            for (uint32_t i = 0; i < 6; i++)
+                pIndices[target.firstIndex + quad * 6 + i] = target.baseVertex + getGridQuadIndex(target.columns, corner, i);
+        }
+    }
+
+    GpuSurfaceTessellator::ParityReport GpuSurfaceTessellator::compare(
+        const SurfaceMeshes::Vertex* pVertices,
+        const uint32_t* pIndices,
+        const Target& target,
+        const TriangleMesh& cpuMesh
+    )
+    {
+        ParityReport report;
+        report.vertexCount = getVertexCount(target);
+        report.indexCount = getIndexCount(target);
+
+        const auto& cpuVertices = cpuMesh.getVertices();
+        const auto& cpuIndices = cpuMesh.getIndices();
+        if (cpuVertices.size() != report.vertexCount || cpuIndices.size() != report.indexCount)
+        {
+            report.isSizeMatching = false;
+            return report;
+        }
+
+        for (size_t i = 0; i < report.vertexCount; i++)
+        {
+            const SurfaceMeshes::Vertex& vertex = pVertices[target.baseVertex + i];
+            const TriangleMesh::Vertex& cpuVertex = cpuVertices[i];
+            report.maxPositionError = std::max(report.maxPositionError, getDistance(vertex.position, cpuVertex.position));
+            report.maxNormalError = std::max(report.maxNormalError, getDistance(vertex.normal, cpuVertex.normal));
+            report.maxTexCoordError = std::max({report.maxTexCoordError, std::abs(vertex.texCoord.x - cpuVertex.texCoord.x), std::abs(vertex.texCoord.y - cpuVertex.texCoord.y)});
+            if (vertex.modelIndex != target.modelIndex)
+                report.modelIndexMismatches++;
+        }
+
+        for (size_t i = 0; i < report.indexCount; i++)
+        {
+            if (pIndices[target.firstIndex + i] != cpuIndices[i] + target.baseVertex)
+                report.indexMismatches++;
+        }
+        return report;
+    }
+}
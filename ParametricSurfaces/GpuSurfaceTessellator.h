@@ -0,0 +1,91 @@
+#pragma once
+#include "SurfaceFunctions.slangh"
+#include "SurfaceMeshes.h"
+
+#include "Falcor.h"
+#include "Core/Program/ComputeProgram.h"
+#include "Core/Program/ProgramVars.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * tessellates the built in surfaces in a compute shader, straight into buffers that are then bound as the vertex
+     * and index buffer, so the mesh never exists on the cpu and nothing is uploaded.
+     * the vertices are SurfaceMeshes::Vertex and the indices are in the order of SurfaceMeshes::writeGridIndices, the
+     * same mesh SurfaceTessellator::createMesh makes from the same SurfaceDesc. tessellateReference runs the two
+     * kernels on the cpu, thread by thread, to check the index order and offsets without a gpu; only a read back of the
+     * buffers tessellate wrote checks the shader itself.
+     */
+    class GpuSurfaceTessellator
+    {
+    public:
+        // where the surface goes in the buffers and which model's settings its vertices use
+        struct Target
+        {
+            uint32_t columns = 2;
+            uint32_t rows = 2;
+            uint32_t baseVertex = 0;    // first vertex of the surface, the indices are offset by it
+            uint32_t firstIndex = 0;
+            uint32_t modelIndex = 0;
+        };
+
+        // the largest differences between two tessellations of the same surface
+        struct ParityReport
+        {
+            float maxPositionError = 0.f;
+            float maxNormalError = 0.f;
+            float maxTexCoordError = 0.f;
+            size_t modelIndexMismatches = 0;
+            size_t indexMismatches = 0;
+            size_t vertexCount = 0;
+            size_t indexCount = 0;
+            bool isSizeMatching = true;
+
+            // the gpu's sines and cosines are allowed to be a few ulps off the cpu's
+            bool isMatching(float tolerance = 1e-4f) const
+            {
+                return isSizeMatching && maxPositionError <= tolerance && maxNormalError <= tolerance && maxTexCoordError <= tolerance &&
+                       modelIndexMismatches == 0 && indexMismatches == 0;
+            }
+        };
+
+        static constexpr uint32_t kThreadGroupSize = 256;
+
+        explicit GpuSurfaceTessellator(const std::shared_ptr<Device>& pDevice);
+
+        static size_t getVertexCount(const Target& target) { return size_t(target.columns) * target.rows; }
+        static size_t getIndexCount(const Target& target) { return size_t(target.columns - 1) * (target.rows - 1) * 6; }
+
+        // buffers that hold a surface and can be written by the compute shader and drawn from
+        Buffer::SharedPtr createVertexBuffer(size_t vertexCount) const;
+        Buffer::SharedPtr createIndexBuffer(size_t indexCount) const;
+
+        // columns and rows are at least 2, the buffers have room for the target's vertices and indices
+        void tessellate(
+            RenderContext* pRenderContext,
+            const SurfaceDesc& desc,
+            const Target& target,
+            const Buffer::SharedPtr& pVertexBuffer,
+            const Buffer::SharedPtr& pIndexBuffer
+        ) const;
+
+        // what the compute shader writes, computed the same way, into arrays of at least the target's size
+        static void tessellateReference(const SurfaceDesc& desc, const Target& target, SurfaceMeshes::Vertex* pVertices, uint32_t* pIndices);
+
+        // compares a tessellation with the mesh of the cpu path, model index and index offsets as in target
+        static ParityReport compare(
+            const SurfaceMeshes::Vertex* pVertices,
+            const uint32_t* pIndices,
+            const Target& target,
+            const TriangleMesh& cpuMesh
+        );
+
+    private:
+        std::shared_ptr<Device> mpDevice;
+
+        ComputeProgram::SharedPtr mpVertexProgram;
+        ComputeVars::SharedPtr mpVertexVars;
+        ComputeProgram::SharedPtr mpIndexProgram;
+        ComputeVars::SharedPtr mpIndexVars;
+    };
+}
@@ -1,6 +1,8 @@
 #include "ParametricSurfaces.h"
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 
 #include "Utils/UI/TextRenderer.h"
 #include <random>
@@ -26,6 +28,9 @@ namespace Falcor::Tutorial
         mpComputeState = ComputeState::create(mpDevice);
         mpComputeState->setProgram(mpComputeProgram);
         mpComputeVars = ComputeVars::create(mpDevice, mpComputeProgram->getReflector());
+        mpNoiseLayerBuffer = Buffer::createStructured(
+            mpDevice.get(), sizeof(NoiseLayerDesc), kMaxNoiseLayers, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr
+        );
 
         applyRasterStateSettings();
 
@@ -42,6 +47,10 @@ namespace Falcor::Tutorial
         mpCamera->setDepthRange(0.1f, 1000.f);
 
         mpCameraController = FirstPersonCameraController::create(mpCamera);
+
+        mpTessellator = std::make_unique<SurfaceTessellator>();
+        mpGpuTessellator = std::make_unique<GpuSurfaceTessellator>(mpDevice);
+        mpCpuNoise = std::make_unique<CpuPerlinNoise>();
     }
 
     void ParametircSurfaceRenderer::onLoad(RenderContext* pRenderContext)
@@ -58,7 +67,16 @@ namespace Falcor::Tutorial
             executeStressTest(pRenderContext);
         }
 
+        // before drawing, so a new height map isn't drawn before it's generated
+        if (!mPendingNoiseLayers.empty())
+        {
+            dispatchNoise(pRenderContext, mPendingNoiseLayers, true);
+            mPendingNoiseLayers.clear();
+        }
+
         mpGraphicsVars["VSCBuffer"]["viewProjection"] = mpCamera->getViewProjMatrix();
+        mpGraphicsVars["VSCBuffer"]["perlinNoise"] = mpNoiseArray;
+        mpGraphicsVars["VSCBuffer"]["noiseSampler"] = mpNoiseSampler;
 
         // pixel shader cbuffer variables
         mpGraphicsVars["PSCBuffer"]["lightAmbient"] = mSettings.lightSettings.ambient;
@@ -71,15 +89,14 @@ namespace Falcor::Tutorial
         {
             mpGraphicsVars["VSCBuffer"]["settings"][i]["transform"] = mSettings.modelSettings[i].transform;
             mpGraphicsVars["VSCBuffer"]["settings"][i]["transformIT"] = inverse(transpose(mSettings.modelSettings[i].transform));
-            const bool hasPerlinNoise = mSettings.modelSettings[i].perlinNoise != nullptr &&
+            const bool hasPerlinNoise = mSettings.modelSettings[i].hasPerlinNoise &&
                                         mSettings.modelSettings[i].type == Plane;
             mpGraphicsVars["VSCBuffer"]["settings"][i]["hasPerlinNoise"] = hasPerlinNoise;
             mpGraphicsVars["VSCBuffer"]["settings"][i]["texelWidth"] = 1.f / perlinNoiseResolution;
 
             if (hasPerlinNoise)
             {
-                mpGraphicsVars["VSCBuffer"]["settings"][i]["perlinNoise"] = mSettings.modelSettings[i].perlinNoise;
-                mpGraphicsVars["VSCBuffer"]["settings"][i]["noiseSampler"] = mpNoiseSampler;
+                mpGraphicsVars["VSCBuffer"]["settings"][i]["noiseLayer"] = static_cast<uint32_t>(i);
                 mpGraphicsVars["VSCBuffer"]["settings"][i]["noiseIntensity"] = mSettings.modelSettings[i].noiseIntensity;
             }
 
@@ -101,23 +118,18 @@ namespace Falcor::Tutorial
         if (mReadyToDraw)
             pRenderContext->drawIndexed(mpGraphicsState.get(), mpGraphicsVars.get(), mpIndexBuffer->getElementCount(), 0, 0);
 
-        if (mShouldGenerateNewNoise)
+        // the gpu surfaces have buffers of their own, the joined vao is put back afterwards
+        const Vao::SharedPtr pJoinedVao = mpGraphicsState->getVao();
+        for (const ModelSettings& settings : mSettings.modelSettings)
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<> seed(0, 10000);
-
-            mpComputeVars["CSCBuffer"]["res"] = static_cast<float>(perlinNoiseResolution);
-            mpComputeVars["CSCBuffer"]["seed"] = static_cast<float>(seed(gen));
-            mpComputeVars["CSCBuffer"]["freq"] = 6;
-            mpComputeVars->setTexture("result", mSettings.modelSettings[mNewNoiseIndex].perlinNoise);
-            mpComputeProgram->dispatchCompute(
-                pRenderContext, mpComputeVars.get(), uint3(perlinNoiseResolution / 16, perlinNoiseResolution / 16, 1)
+            if (!settings.gpuSurface)
+                continue;
+            mpGraphicsState->setVao(settings.gpuSurface->pVao);
+            pRenderContext->drawIndexed(
+                mpGraphicsState.get(), mpGraphicsVars.get(), static_cast<uint32_t>(GpuSurfaceTessellator::getIndexCount(settings.gpuSurface->target)), 0, 0
             );
-
-            mShouldGenerateNewNoise = false;
-            mNewNoiseIndex = -1;
         }
+        mpGraphicsState->setVao(pJoinedVao);
 
         mFrameRate.newFrame();
         if (mSettings.renderSettings.showFPS)
@@ -173,11 +185,35 @@ namespace Falcor::Tutorial
         if (window.button("Generate sphere"))
             createSphere();
 
+        window.var("Surface resolution", mSettings.renderSettings.parametricSurfaceResolution, 2u, kMaxSurfaceResolution);
         if (window.button("Generate plane"))
             createPlane();
 
+        Gui::DropdownList surfaceList;
+        for (uint32_t i = 0; i < mpTessellator->getSurfaces().size(); i++)
+            surfaceList.push_back({i, mpTessellator->getSurfaces()[i].name});
+        window.dropdown("Surface", surfaceList, mSelectedSurface);
+        window.checkbox("Tessellate on the gpu", mSettings.renderSettings.useGpuTessellation);
+        if (window.button("Generate surface"))
+            createSurface();
+        if (window.button("Compare gpu surfaces with the cpu"))
+            checkGpuParity();
+        if (!mParityResult.empty())
+            window.text(mParityResult);
+
+        if (mTessellationReport.resolution > 0)
+        {
+            window.text(
+                mTessellationReport.name + ": " + std::to_string(mTessellationReport.resolution) + "x" + std::to_string(mTessellationReport.resolution) + ", " +
+                std::to_string(mTessellationReport.vertexCount) + " vertices (" + std::to_string(mTessellationReport.unsharedVertexCount) + " unshared), " +
+                std::to_string(mTessellationReport.triangleCount) + " triangles in " + std::to_string(mTessellationReport.milliseconds) + " ms"
+            );
+        }
+
         if (window.button("Start stress test"))
             mIsStressTesting = true;
+        if (!mNoiseParityResult.empty())
+            window.text(mNoiseParityResult);
 
         if (auto lightGroup = window.group("Directional light settings"))
         {
@@ -211,11 +247,11 @@ namespace Falcor::Tutorial
                 window.var(("Noise intensity for " + mpModels[i]->getName()).c_str(), mSettings.modelSettings[i].noiseIntensity);
 
                 if (window.button(("Generate perlin noise for " + mpModels[i]->getName()).c_str()))
-                {
-                    mShouldGenerateNewNoise = true;
-                    mNewNoiseIndex = i;
-                    generatePerlinNoiseBuffer(i);
-                }
+                    mPendingNoiseLayers.push_back(createNoiseLayer(i));
+
+                if (mSettings.modelSettings[i].hasPerlinNoise &&
+                    window.button(("Compare perlin noise of " + mpModels[i]->getName() + " with the cpu").c_str()))
+                    checkNoiseParity(i);
 
                 if (window.button(("Upload texture for " + mpModels[i]->getName()).c_str()))
                 {
@@ -251,9 +287,15 @@ namespace Falcor::Tutorial
         mReadyToDraw = false;
 
         // batching the models together, so we only need one draw call
-        const Buffer::SharedPtr vertexBuffer = generateModelVertexBuffers();
-        generateModelIndexBuffer();
+        const Buffer::SharedPtr vertexBuffer = generateModelBuffers();
+
+        Vao::SharedPtr pVao = Vao::create(Vao::Topology::TriangleList, createVertexLayout(), {vertexBuffer}, mpIndexBuffer, ResourceFormat::R32Uint);
+        mReadyToDraw = true;
+        return pVao;
+    }
 
+    VertexLayout::SharedPtr ParametircSurfaceRenderer::createVertexLayout()
+    {
         const VertexLayout::SharedPtr pLayout = VertexLayout::create();
         const VertexBufferLayout::SharedPtr pBufLayout = VertexBufferLayout::create();
         pBufLayout->addElement("POSOBJ", offsetof(Vertex, position), ResourceFormat::RGB32Float, 1, 0);
@@ -261,24 +303,85 @@ namespace Falcor::Tutorial
         pBufLayout->addElement("TEXCOORD", offsetof(Vertex, texCoord), ResourceFormat::RG32Float, 1, 2);
         pBufLayout->addElement("MODELINDEX", offsetof(Vertex, modelIndex), ResourceFormat::R32Uint, 1, 3);
         pLayout->addBufferLayout(0, pBufLayout);
+        return pLayout;
+    }
 
-        Vao::SharedPtr pVao = Vao::create(Vao::Topology::TriangleList, pLayout, {vertexBuffer}, mpIndexBuffer, ResourceFormat::R32Uint);
-        mReadyToDraw = true;
-        return pVao;
+    NoiseLayerDesc ParametircSurfaceRenderer::createNoiseLayer(const size_t modelIndex)
+    {
+        // the layers of every model at once, created with the first height map
+        if (mpNoiseArray == nullptr)
+        {
+            mpNoiseArray = Texture::create2D(
+                mpDevice.get(),
+                perlinNoiseResolution,
+                perlinNoiseResolution,
+                ResourceFormat::RGBA16Float,
+                kMaxNoiseLayers,
+                1,
+                nullptr,
+                Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess
+            );
+        }
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<> seed(0, 10000);
+
+        ModelSettings& settings = mSettings.modelSettings[modelIndex];
+        settings.hasPerlinNoise = true;
+        settings.noiseSeed = static_cast<float>(seed(gen));
+
+        NoiseLayerDesc layer;
+        layer.layer = static_cast<uint32_t>(modelIndex);
+        layer.seed = settings.noiseSeed;
+        layer.octaves = kNoiseOctaves;
+        return layer;
     }
 
-    void ParametircSurfaceRenderer::generatePerlinNoiseBuffer(const size_t modelIndex)
+    void ParametircSurfaceRenderer::dispatchNoise(RenderContext* pRenderContext, const std::vector<NoiseLayerDesc>& layers, const bool isBatched)
     {
-        mSettings.modelSettings[modelIndex].perlinNoise = Texture::create2D(
-            mpDevice.get(),
-            perlinNoiseResolution,
-            perlinNoiseResolution,
-            ResourceFormat::RGBA16Float,
-            1,
-            Resource::kMaxPossible,
-            nullptr,
-            Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess
-        );
+        if (layers.empty() || mpNoiseArray == nullptr)
+            return;
+
+        const uint32_t layerCount = std::min(static_cast<uint32_t>(layers.size()), kMaxNoiseLayers);
+        mpNoiseLayerBuffer->setBlob(layers.data(), 0, layerCount * sizeof(NoiseLayerDesc));
+
+        mpComputeVars["CSCBuffer"]["res"] = static_cast<float>(perlinNoiseResolution);
+        mpComputeVars->setTexture("result", mpNoiseArray);
+        mpComputeVars->setBuffer("gLayers", mpNoiseLayerBuffer);
+
+        const uint32_t groupCount = perlinNoiseResolution / 16;
+        if (isBatched)
+        {
+            mpComputeVars["CSCBuffer"]["firstLayer"] = 0u;
+            mpComputeProgram->dispatchCompute(pRenderContext, mpComputeVars.get(), uint3(groupCount, groupCount, layerCount));
+            return;
+        }
+
+        for (uint32_t i = 0; i < layerCount; i++)
+        {
+            mpComputeVars["CSCBuffer"]["firstLayer"] = i;
+            mpComputeProgram->dispatchCompute(pRenderContext, mpComputeVars.get(), uint3(groupCount, groupCount, 1));
+        }
+    }
+
+    void ParametircSurfaceRenderer::checkNoiseParity(const size_t modelIndex)
+    {
+        const ModelSettings& settings = mSettings.modelSettings[modelIndex];
+        const std::vector<uint8_t> texels =
+            getRenderContext()->readTextureSubresource(mpNoiseArray.get(), mpNoiseArray->getSubresourceIndex(static_cast<uint32_t>(modelIndex), 0));
+
+        CpuPerlinNoise::Settings noiseSettings;
+        noiseSettings.resolution = perlinNoiseResolution;
+        noiseSettings.seed = settings.noiseSeed;
+        noiseSettings.octaves = kNoiseOctaves;
+        std::vector<float> heights;
+        const CpuPerlinNoise::Statistics statistics = mpCpuNoise->generate(noiseSettings, heights);
+
+        const CpuPerlinNoise::ParityReport report = CpuPerlinNoise::compare(heights, texels);
+        mNoiseParityResult = mpModels[modelIndex]->getName() + (report.isMatching() ? ": the cpu noise matches" : ": the cpu noise differs") +
+                             ", largest difference " + std::to_string(report.maxDifference) + ", generated in " +
+                             std::to_string(statistics.seconds * 1000.0) + " ms with " + CpuPerlinNoise::getName(statistics.instructionSet);
     }
 
     void ParametircSurfaceRenderer::applyRasterStateSettings() const
@@ -294,14 +397,19 @@ namespace Falcor::Tutorial
 
     bool ParametircSurfaceRenderer::isEveryModelValid()
     {
-        for (const auto& pModel : mpModels)
+        for (size_t i = 0; i < mpModels.size(); i++)
         {
+            const auto& pModel = mpModels[i];
             if (pModel == nullptr)
             {
                 mReadyToDraw = false;
                 return false;
             }
 
+            // a gpu surface's mesh is empty, it only keeps the model indices of the joined vertices in step
+            if (isGpuSurface(i))
+                continue;
+
             if (pModel->getVertices().empty() || pModel->getIndices().empty())
             {
                 mReadyToDraw = false;
@@ -311,62 +419,31 @@ namespace Falcor::Tutorial
         return true;
     }
 
-    Buffer::SharedPtr ParametircSurfaceRenderer::generateModelVertexBuffers()
+    Buffer::SharedPtr ParametircSurfaceRenderer::generateModelBuffers()
     {
-        const ResourceBindFlags bindFlags = Resource::BindFlags::Vertex | ResourceBindFlags::ShaderResource;
-        Buffer::SharedPtr joinedBuffer;
-
         std::vector<Vertex> vertData;
-        for (size_t i = 0; i < mpModels.size(); i++)
-        {
-            for (const auto& vertexData : mpModels[i]->getVertices())
-            {
-                Vertex v;
-                v.position = vertexData.position;
-                v.normal = vertexData.normal;
-                v.texCoord = vertexData.texCoord;
-                v.modelIndex = i;
-                vertData.push_back(v);
-            }
-        }
+        TriangleMesh::IndexList joinedIndices;
+        SurfaceMeshes::joinModels(mpModels, vertData, joinedIndices);
 
         Buffer::SharedPtr pBuffer = Buffer::createStructured(
             mpDevice.get(),
             sizeof(Vertex),
             vertData.size(),
-            bindFlags,
+            Resource::BindFlags::Vertex | ResourceBindFlags::ShaderResource,
             Buffer::CpuAccess::None,
             vertData.data()
         );
 
-        return pBuffer;
-    }
-
-    void ParametircSurfaceRenderer::generateModelIndexBuffer()
-    {
-        const ResourceBindFlags bindFlags = Resource::BindFlags::Index | ResourceBindFlags::ShaderResource;
-        TriangleMesh::IndexList joinedIndices;
-        uint32_t vertexCount = 0;
-        for (const auto& pModel : mpModels)
-        {
-            auto indices = pModel->getIndices();
-            std::for_each(
-                indices.begin(),
-                indices.end(),
-                [&](uint32_t& index) { index += vertexCount; }
-            );
-            vertexCount += pModel->getVertices().size();
-            joinedIndices.insert(joinedIndices.end(), indices.begin(), indices.end());
-        }
-
         mpIndexBuffer = Buffer::createStructured(
             mpDevice.get(),
             sizeof(uint32_t),
             joinedIndices.size(),
-            bindFlags,
+            Resource::BindFlags::Index | ResourceBindFlags::ShaderResource,
             Buffer::CpuAccess::None,
             joinedIndices.data()
         );
+
+        return pBuffer;
     }
 
     void ParametircSurfaceRenderer::createPlane()
@@ -374,39 +451,15 @@ namespace Falcor::Tutorial
         if (mpModels.size() >= 32)
             return;
 
-        const auto& plane = TriangleMesh::create();
-        plane->setName("plane" + std::to_string(objCount[Plane]));
-
-        const auto& res = mSettings.renderSettings.parametricSurfaceResolution;
-        const float3& normal = { 0, 1, 0 };
-
-        for (size_t i = 0; i < res - 1; i++)
-        {
-            for (size_t j = 0; j < res - 1; j++)
-            {
-                const float x = static_cast<float>(j);
-                const float z = static_cast<float>(i);
-
-                // first vertex of the quad
-                float3 pos1 = {x, 0, z};
-                const uint32_t vertex1Index = plane->addVertex(pos1, normal, {x / res, z / res});
+        const uint32_t resolution = std::clamp(mSettings.renderSettings.parametricSurfaceResolution, 2u, kMaxSurfaceResolution);
 
-                // second vertex of the quad
-                float3 pos2 = {x, 0, z + 1};
-                const uint32_t vertex2Index = plane->addVertex(pos2, normal, {x / res, (z + 1) / res});
-
-                // third vertex of the quad
-                float3 pos3 = {x + 1, 0, z + 1};
-                const uint32_t vertex3Index = plane->addVertex(pos3, normal, {(x + 1) / res, (z + 1) / res});
-
-                // fourth vertex of the quad
-                float3 pos4 = {x + 1, 0, z};
-                const uint32_t vertex4Index = plane->addVertex(pos4, normal, {(x + 1) / res, z / res});
+        CpuTimer timer;
+        const CpuTimer::TimePoint startTime = CpuTimer::getCurrentTimePoint();
+        const auto& plane = SurfaceMeshes::createPlane(resolution);
+        const CpuTimer::TimePoint endTime = timer.update();
 
-                plane->addTriangle(vertex1Index, vertex2Index, vertex3Index);
-                plane->addTriangle(vertex4Index, vertex1Index, vertex3Index);
-            }
-        }
+        plane->setName("plane" + std::to_string(objCount[Plane]));
+        updateTessellationReport(plane->getName(), resolution, plane->getVertices().size(), plane->getIndices().size() / 3, CpuTimer::calcDuration(startTime, endTime));
 
         mpModels.push_back(plane);
         objCount[Plane]++;
@@ -454,50 +507,349 @@ namespace Falcor::Tutorial
         }
     }
 
-    void ParametircSurfaceRenderer::executeStressTest(RenderContext* pRenderContext)
+    void ParametircSurfaceRenderer::createSurface()
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> seed(0, 10000);
+        if (mpModels.size() >= 32 || mSelectedSurface >= mpTessellator->getSurfaces().size())
+            return;
+
+        const SurfaceTessellator::Surface& surface = mpTessellator->getSurfaces()[mSelectedSurface];
+        const uint32_t resolution = std::clamp(mSettings.renderSettings.parametricSurfaceResolution, 2u, kMaxSurfaceResolution);
+
+        if (mSettings.renderSettings.useGpuTessellation && surface.desc)
+        {
+            createGpuSurface(surface, resolution);
+            return;
+        }
+
+        CpuTimer timer;
+        const CpuTimer::TimePoint startTime = CpuTimer::getCurrentTimePoint();
+        const auto& pSurface = mpTessellator->createMesh(surface.function, resolution, resolution);
+        const CpuTimer::TimePoint endTime = timer.update();
+
+        pSurface->setName(surface.name + std::to_string(objCount[Surface]));
+        updateTessellationReport(
+            pSurface->getName(), resolution, pSurface->getVertices().size(), pSurface->getIndices().size() / 3, CpuTimer::calcDuration(startTime, endTime)
+        );
 
+        mpModels.push_back(pSurface);
+        objCount[Surface]++;
+
+        const Vao::SharedPtr pVao = createVao();
+        if (pVao != nullptr)
+        {
+            auto settings = ModelSettings();
+            settings.type = Surface;
+            mSettings.modelSettings.push_back(settings);
+            mReadyToDraw = true;
+            mpGraphicsState->setVao(pVao);
+            mFrameRate.reset();
+        }
+        else
+        {
+            mpModels.pop_back();
+            objCount[Surface]--;
+        }
+    }
+
+    void ParametircSurfaceRenderer::createGpuSurface(const SurfaceTessellator::Surface& surface, const uint32_t resolution)
+    {
+        GpuSurface gpuSurface;
+        gpuSurface.desc = *surface.desc;
+        gpuSurface.target.columns = resolution;
+        gpuSurface.target.rows = resolution;
+        gpuSurface.target.modelIndex = static_cast<uint32_t>(mpModels.size());
+        gpuSurface.pVertexBuffer = mpGpuTessellator->createVertexBuffer(GpuSurfaceTessellator::getVertexCount(gpuSurface.target));
+        gpuSurface.pIndexBuffer = mpGpuTessellator->createIndexBuffer(GpuSurfaceTessellator::getIndexCount(gpuSurface.target));
+
+        // only the recording is timed, the dispatches run on the gpu later
+        CpuTimer timer;
+        const CpuTimer::TimePoint startTime = CpuTimer::getCurrentTimePoint();
+        mpGpuTessellator->tessellate(getRenderContext(), gpuSurface.desc, gpuSurface.target, gpuSurface.pVertexBuffer, gpuSurface.pIndexBuffer);
+        const CpuTimer::TimePoint endTime = timer.update();
+
+        gpuSurface.pVao = Vao::create(
+            Vao::Topology::TriangleList, createVertexLayout(), {gpuSurface.pVertexBuffer}, gpuSurface.pIndexBuffer, ResourceFormat::R32Uint
+        );
+
+        const TriangleMesh::SharedPtr pModel = TriangleMesh::create();
+        pModel->setName(surface.name + std::to_string(objCount[Surface]) + " (gpu)");
+        updateTessellationReport(
+            pModel->getName(),
+            resolution,
+            GpuSurfaceTessellator::getVertexCount(gpuSurface.target),
+            GpuSurfaceTessellator::getIndexCount(gpuSurface.target) / 3,
+            CpuTimer::calcDuration(startTime, endTime)
+        );
+
+        mpModels.push_back(pModel);
+        objCount[Surface]++;
+
+        ModelSettings settings;
+        settings.type = Surface;
+        settings.gpuSurface = std::move(gpuSurface);
+        mSettings.modelSettings.push_back(settings);
+        mFrameRate.reset();
+    }
+
+    void ParametircSurfaceRenderer::updateTessellationReport(
+        const std::string& name,
+        const uint32_t resolution,
+        const size_t vertexCount,
+        const size_t triangleCount,
+        const double milliseconds
+    )
+    {
+        mTessellationReport.name = name;
+        mTessellationReport.resolution = resolution;
+        mTessellationReport.vertexCount = vertexCount;
+        mTessellationReport.unsharedVertexCount = size_t(resolution - 1) * (resolution - 1) * 4;
+        mTessellationReport.triangleCount = triangleCount;
+        mTessellationReport.milliseconds = milliseconds;
+    }
+
+    void ParametircSurfaceRenderer::checkGpuParity()
+    {
+        size_t surfaceCount = 0;
+        size_t mismatchCount = 0;
+        float maxError = 0.f;
+
+        for (const ModelSettings& settings : mSettings.modelSettings)
+        {
+            if (!settings.gpuSurface)
+                continue;
+
+            const GpuSurface& gpuSurface = *settings.gpuSurface;
+            const std::vector<SurfaceMeshes::Vertex> vertices = gpuSurface.pVertexBuffer->getElements<SurfaceMeshes::Vertex>();
+            const std::vector<uint32_t> indices = gpuSurface.pIndexBuffer->getElements<uint32_t>();
+            const TriangleMesh::SharedPtr pCpuMesh = mpTessellator->createMesh(
+                SurfaceTessellator::getFunction(gpuSurface.desc), gpuSurface.target.columns, gpuSurface.target.rows
+            );
+
+            const GpuSurfaceTessellator::ParityReport report =
+                GpuSurfaceTessellator::compare(vertices.data(), indices.data(), gpuSurface.target, *pCpuMesh);
+            surfaceCount++;
+            if (!report.isMatching())
+                mismatchCount++;
+            maxError = std::max({maxError, report.maxPositionError, report.maxNormalError, report.maxTexCoordError});
+        }
+
+        if (surfaceCount == 0)
+            mParityResult = "no gpu surfaces to compare";
+        else
+            mParityResult = std::to_string(surfaceCount - mismatchCount) + " of " + std::to_string(surfaceCount) +
+                            " gpu surfaces match the cpu, largest difference " + std::to_string(maxError);
+    }
+
+    bool ParametircSurfaceRenderer::isGpuSurface(const size_t modelIndex) const
+    {
+        return modelIndex < mSettings.modelSettings.size() && mSettings.modelSettings[modelIndex].gpuSurface.has_value();
+    }
+
+    /*
+     * runs GpuSurfaceTessellator::tessellateReference, a cpu transliteration of the compute shader's kernels, for every
+     * built in surface and compares it with SurfaceTessellator::createMesh.
+     * nothing runs on the gpu, so this only catches a reference that drifts from the cpu path: the index order, the
+     * vertex and index offsets and the model index. whether the shader itself matches is checked by the "Compare gpu
+     * surfaces with the cpu" button, which reads the buffers back.
+     * --resolution sets the points per side, the surfaces are placed past some other vertices and indices so the
+     * offsets are checked too.
+     */
+    int ParametircSurfaceRenderer::runReferenceCheck(const std::vector<std::string>& args)
+    {
+        uint32_t resolution = 256;
+
+        try
+        {
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                const auto next = [&]() -> const std::string&
+                {
+                    if (++i >= args.size())
+                        throw std::invalid_argument("missing value after " + args[i - 1]);
+                    return args[i];
+                };
+
+                if (args[i] == "--check-reference")
+                    continue;
+                else if (args[i] == "--resolution")
+                    resolution = static_cast<uint32_t>(std::stoul(next()));
+                else
+                    throw std::invalid_argument("unknown argument " + args[i]);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        if (resolution < 2 || resolution > kMaxSurfaceResolution)
+        {
+            std::cerr << "the resolution is between 2 and " << kMaxSurfaceResolution << std::endl;
+            return 1;
+        }
+
+        const SurfaceTessellator tessellator;
+        bool isMatching = true;
+        for (const SurfaceTessellator::Surface& surface : tessellator.getSurfaces())
+        {
+            if (!surface.desc)
+                continue;
+
+            GpuSurfaceTessellator::Target target;
+            target.columns = resolution;
+            target.rows = resolution;
+            target.baseVertex = 5;
+            target.firstIndex = 7;
+            target.modelIndex = 3;
+
+            std::vector<SurfaceMeshes::Vertex> vertices(target.baseVertex + GpuSurfaceTessellator::getVertexCount(target));
+            std::vector<uint32_t> indices(target.firstIndex + GpuSurfaceTessellator::getIndexCount(target));
+            GpuSurfaceTessellator::tessellateReference(*surface.desc, target, vertices.data(), indices.data());
+
+            const TriangleMesh::SharedPtr pCpuMesh = tessellator.createMesh(surface.function, resolution, resolution);
+            const GpuSurfaceTessellator::ParityReport report = GpuSurfaceTessellator::compare(vertices.data(), indices.data(), target, *pCpuMesh);
+
+            std::cout << surface.name << ": " << (report.isMatching() ? "matches" : "differs") << ", position " << report.maxPositionError
+                      << ", normal " << report.maxNormalError << ", texture coordinates " << report.maxTexCoordError << ", "
+                      << report.modelIndexMismatches << " model index and " << report.indexMismatches << " index mismatches" << std::endl;
+            isMatching = isMatching && report.isMatching();
+        }
+        return isMatching ? 0 : 1;
+    }
+
+    void ParametircSurfaceRenderer::executeStressTest(RenderContext* pRenderContext)
+    {
         mpModels.clear();
         mSettings.modelSettings.clear();
+        mPendingNoiseLayers.clear();
         constexpr int testSize = 32;
 
         CpuTimer timer;
         const CpuTimer::TimePoint startTime = CpuTimer::getCurrentTimePoint();
 
         for (int i = 0; i < testSize; i++)
-        {
             createPlane();
-            generatePerlinNoiseBuffer(i);
-        }
 
-        // generating noises
-        for (int i = 0; i < testSize; i++)
-        {
-            mpComputeVars["CSCBuffer"]["res"] = static_cast<float>(perlinNoiseResolution);
-            mpComputeVars["CSCBuffer"]["seed"] = static_cast<float>(seed(gen));
-            mpComputeVars["CSCBuffer"]["freq"] = 6;
+        // generating noises, every height map in one dispatch
+        std::vector<NoiseLayerDesc> layers;
+        for (size_t i = 0; i < mSettings.modelSettings.size(); i++)
+            layers.push_back(createNoiseLayer(i));
+        dispatchNoise(pRenderContext, layers, true);
 
-            mpComputeVars->setTexture("result", mSettings.modelSettings[i].perlinNoise);
-            mpComputeProgram->dispatchCompute(
-                pRenderContext, mpComputeVars.get(), uint3(perlinNoiseResolution / 16, perlinNoiseResolution / 16, 1)
-            );
-        }
         const CpuTimer::TimePoint endTime = timer.update();
+
+        // the same height maps with one dispatch per layer as before the batching, and batched. both wait for the gpu
+        // so the time includes running the dispatches, not just recording them
+        const auto timeNoise = [&](const bool isBatched)
+        {
+            pRenderContext->flush(true);
+            const CpuTimer::TimePoint noiseStartTime = CpuTimer::getCurrentTimePoint();
+            dispatchNoise(pRenderContext, layers, isBatched);
+            pRenderContext->flush(true);
+            return CpuTimer::calcDuration(noiseStartTime, timer.update());
+        };
+        const double perLayerMilliseconds = timeNoise(false);
+        const double batchedMilliseconds = timeNoise(true);
+
         std::ofstream file("perlinNoiseStressTestResult.txt");
 
         file << "It took " << CpuTimer::calcDuration(startTime, endTime) << " milliseconds, to generate " << testSize << " planes and height maps\n";
+        file << "The " << layers.size() << " height maps took " << perLayerMilliseconds << " milliseconds with one dispatch per layer and "
+             << batchedMilliseconds << " milliseconds with a single dispatch\n";
+        file << "Each plane has " << mTessellationReport.vertexCount << " vertices instead of " << mTessellationReport.unsharedVertexCount << " without shared corners, "
+             << mTessellationReport.triangleCount << " triangles, the last one was tessellated in " << mTessellationReport.milliseconds << " milliseconds\n";
 
         file.close();
 
         mIsStressTesting = false;
     }
+
+    /*
+     * generates the noise of ParametricSurfaces.cs.slang with CpuPerlinNoise and saves it as an exr with the height in
+     * every channel, like the shader's texture. prints the throughput.
+     * --resolution is the shader's res, --seed and --octaves those of a NoiseLayerDesc, --isa is scalar or avx2.
+     */
+    int ParametircSurfaceRenderer::runNoiseBake(const std::vector<std::string>& args)
+    {
+        std::filesystem::path outputPath;
+        CpuPerlinNoise::Settings settings;
+        settings.octaves = kNoiseOctaves;
+        CpuPerlinNoise::InstructionSet instructionSet = CpuPerlinNoise::getBestInstructionSet();
+
+        try
+        {
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                const auto next = [&]() -> const std::string&
+                {
+                    if (++i >= args.size())
+                        throw std::invalid_argument("missing value after " + args[i - 1]);
+                    return args[i];
+                };
+
+                if (args[i] == "--bake-noise")
+                    outputPath = next();
+                else if (args[i] == "--resolution")
+                    settings.resolution = static_cast<uint32_t>(std::stoul(next()));
+                else if (args[i] == "--seed")
+                    settings.seed = std::stof(next());
+                else if (args[i] == "--octaves")
+                    settings.octaves = static_cast<uint32_t>(std::stoul(next()));
+                else if (args[i] == "--isa")
+                {
+                    const std::string& name = next();
+                    if (name == "scalar")
+                        instructionSet = CpuPerlinNoise::InstructionSet::Scalar;
+                    else if (name == "avx2")
+                        instructionSet = CpuPerlinNoise::InstructionSet::AVX2;
+                    else
+                        throw std::invalid_argument("unknown instruction set " + name);
+                }
+                else
+                    throw std::invalid_argument("unknown argument " + args[i]);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        if (outputPath.empty() || settings.resolution == 0 || settings.seed < 0.f)
+        {
+            std::cerr << "an output path, a non-empty resolution and a seed that isn't negative are needed" << std::endl;
+            return 1;
+        }
+
+        const CpuPerlinNoise noise(instructionSet);
+        std::vector<float> heights;
+        const CpuPerlinNoise::Statistics statistics = noise.generate(settings, heights);
+
+        std::vector<float4> texels(heights.size());
+        std::transform(heights.begin(), heights.end(), texels.begin(), [](const float height) { return float4(height); });
+        Bitmap::saveImage(
+            outputPath, settings.resolution, settings.resolution, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA32Float, true,
+            texels.data()
+        );
+
+        std::cout << settings.resolution << "x" << settings.resolution << " texels, " << settings.octaves << " octaves in " << statistics.seconds * 1000.0
+                  << " ms, " << statistics.megasamplesPerSecond << " million texels per second on " << statistics.threadCount << " threads with "
+                  << CpuPerlinNoise::getName(statistics.instructionSet) << std::endl;
+        return 0;
+    }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // the cpu reference of the compute shader's tessellation can be checked without creating a window
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (std::find(args.begin(), args.end(), "--check-reference") != args.end())
+        return Falcor::Tutorial::ParametircSurfaceRenderer::runReferenceCheck(args);
+    // and the noise baked on the cpu
+    if (std::find(args.begin(), args.end(), "--bake-noise") != args.end())
+        return Falcor::Tutorial::ParametircSurfaceRenderer::runNoiseBake(args);
+
     Falcor::SampleAppConfig config;
     config.windowDesc.width = 1280;
     config.windowDesc.height = 720;
@@ -1,4 +1,10 @@
 #pragma once
+#include "CpuPerlinNoise.h"
+#include "GpuSurfaceTessellator.h"
+#include "NoiseLayer.slangh"
+#include "SurfaceMeshes.h"
+#include "SurfaceTessellator.h"
+
 #include "Core/SampleApp.h"
 #include "Core/API/VAO.h"
 #include "Core/Program/ComputeProgram.h"
@@ -18,17 +24,11 @@ namespace Falcor::Tutorial
         enum ObjectType
         {
             Sphere,
-            Plane
+            Plane,
+            Surface     // one of the tessellator's surfaces
         };
 
-        struct Vertex
-        {
-            float3 position;
-            float3 normal;
-            float2 texCoord;
-
-            uint32_t modelIndex;
-        };
+        using Vertex = SurfaceMeshes::Vertex;
 
         struct RenderSettings
         {
@@ -36,9 +36,35 @@ namespace Falcor::Tutorial
             RasterizerState::FillMode fillMode = RasterizerState::FillMode::Solid;
             RasterizerState::CullMode cullMode = RasterizerState::CullMode::Back;
             float aspectRatio = 1280.f/720.f;
-            size_t parametricSurfaceResolution = 100;
+            uint32_t parametricSurfaceResolution = 100;     // points per side of a new plane or surface
+            bool useGpuTessellation = false;                // built in surfaces are tessellated by the compute shader
+        };
+
+        // a surface the compute shader tessellated into buffers of its own, it's drawn with its own call and its mesh
+        // in mpModels stays empty
+        struct GpuSurface
+        {
+            SurfaceDesc desc;
+            GpuSurfaceTessellator::Target target;
+            Buffer::SharedPtr pVertexBuffer;
+            Buffer::SharedPtr pIndexBuffer;
+            Vao::SharedPtr pVao;
         };
 
+        // the last tessellated plane or surface, shown in the gui
+        struct TessellationReport
+        {
+            std::string name;
+            uint32_t resolution = 0;
+            size_t vertexCount = 0;
+            size_t unsharedVertexCount = 0;     // the same quads with four vertices each
+            size_t triangleCount = 0;
+            double milliseconds = 0.0;
+        };
+
+        // past this a surface has millions of vertices
+        static constexpr uint32_t kMaxSurfaceResolution = 2048;
+
         struct DirectionalLightSettings
         {
             float3 ambient = {0.2f, 0.3f, 0.5f};
@@ -61,11 +87,15 @@ namespace Falcor::Tutorial
             float3 rotation = float3(0, 0, 0);
 
             Texture::SharedPtr texture = nullptr;
-            Texture::SharedPtr perlinNoise = nullptr;
+            // the height map is the layer of mpNoiseArray at the model's index
+            bool hasPerlinNoise = false;
 
             float noiseIntensity = 100.f;
+            float noiseSeed = 0.f;  // of the noise last dispatched, so the cpu can generate the same
 
             ObjectType type = Plane;
+
+            std::optional<GpuSurface> gpuSurface;
         };
 
         struct Settings
@@ -85,22 +115,40 @@ namespace Falcor::Tutorial
         bool onMouseEvent(const MouseEvent& mouseEvent) override;
         void onGuiRender(Gui* pGui) override;
 
+        // compares the cpu reference of the compute shader's tessellation with SurfaceTessellator, without a window or
+        // gpu, so it checks the index order and offsets, not the shader. returns the process exit code
+        static int runReferenceCheck(const std::vector<std::string>& args);
+        // the height map of the noise shader generated on the cpu and saved, returns the process exit code
+        static int runNoiseBake(const std::vector<std::string>& args);
+
     private:
         // rendering
         Vao::SharedPtr createVao();
-        void generatePerlinNoiseBuffer(size_t modelIndex);
+        static VertexLayout::SharedPtr createVertexLayout();
+        // picks a seed for a model's height map, the layer is generated by the next dispatchNoise
+        NoiseLayerDesc createNoiseLayer(size_t modelIndex);
+        // one dispatch for all the layers, or one per layer like before they were batched
+        void dispatchNoise(RenderContext* pRenderContext, const std::vector<NoiseLayerDesc>& layers, bool isBatched);
+        // reads a model's noise back and compares it with CpuPerlinNoise
+        void checkNoiseParity(size_t modelIndex);
 
         // settings
         void applyRasterStateSettings() const;
 
         // models
         bool isEveryModelValid();
-        Buffer::SharedPtr generateModelVertexBuffers();
-        void generateModelIndexBuffer();
+        // joins the models into one vertex buffer, which is returned, and mpIndexBuffer
+        Buffer::SharedPtr generateModelBuffers();
 
         // parametric surfaces
         void createPlane();
         void createSphere();
+        void createSurface();
+        void createGpuSurface(const SurfaceTessellator::Surface& surface, uint32_t resolution);
+        void updateTessellationReport(const std::string& name, uint32_t resolution, size_t vertexCount, size_t triangleCount, double milliseconds);
+        // reads the gpu surfaces back and compares them with the cpu tessellation
+        void checkGpuParity();
+        bool isGpuSurface(size_t modelIndex) const;
 
         void executeStressTest(RenderContext*);
 
@@ -123,15 +171,28 @@ namespace Falcor::Tutorial
         ComputeVars::SharedPtr mpComputeVars;
 
         bool mReadyToDraw = false;
-        bool mShouldGenerateNewNoise = false;
-        int mNewNoiseIndex = -1;
+        // layers asked for in the gui, generated together in the next frame
+        std::vector<NoiseLayerDesc> mPendingNoiseLayers;
 
         std::unordered_map<ObjectType, uint64_t> objCount;
 
         FrameRate mFrameRate;
 
         const uint32_t perlinNoiseResolution = 512;
+        static constexpr uint32_t kNoiseOctaves = 6;
+        // one layer per model, the vertex shader has the settings of 32
+        static constexpr uint32_t kMaxNoiseLayers = 32;
+        Texture::SharedPtr mpNoiseArray;
+        Buffer::SharedPtr mpNoiseLayerBuffer;
+        std::unique_ptr<CpuPerlinNoise> mpCpuNoise;
+        std::string mNoiseParityResult;
 
         bool mIsStressTesting = false;
+        TessellationReport mTessellationReport;
+
+        std::unique_ptr<SurfaceTessellator> mpTessellator;
+        std::unique_ptr<GpuSurfaceTessellator> mpGpuTessellator;
+        uint32_t mSelectedSurface = 0;
+        std::string mParityResult;
     };
 }
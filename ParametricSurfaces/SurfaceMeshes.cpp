@@ -0,0 +1,109 @@
+#include "SurfaceMeshes.h"
+
+#include <algorithm>
+
+namespace Falcor::Tutorial
+{
+    TriangleMesh::SharedPtr SurfaceMeshes::createPlane(const uint32_t resolution)
+    {
+        if (resolution < 2)
+            return TriangleMesh::create();
+
+        TriangleMesh::VertexList vertices(getPlaneVertexCount(resolution));
+        TriangleMesh::IndexList indices(getPlaneIndexCount(resolution));
+        tessellatePlane(resolution, vertices.data(), indices.data());
+        return TriangleMesh::create(vertices, indices);
+    }
+
+    size_t SurfaceMeshes::getPlaneVertexCount(const uint32_t resolution)
+    {
+        return resolution < 2 ? 0 : size_t(resolution) * resolution;
+    }
+
+    size_t SurfaceMeshes::getPlaneIndexCount(const uint32_t resolution)
+    {
+        return resolution < 2 ? 0 : size_t(resolution - 1) * (resolution - 1) * 6;
+    }
+
+    void SurfaceMeshes::tessellatePlane(const uint32_t resolution, TriangleMesh::Vertex* pVertices, uint32_t* pIndices)
+    {
+        if (resolution < 2)
+            return;
+
+        const float3 normal = {0, 1, 0};
+        // the texture coordinates reach 1 at the last point, so the noise covers the whole plane
+        const float texCoordScale = 1.f / static_cast<float>(resolution - 1);
+
+        for (uint32_t i = 0; i < resolution; i++)
+        {
+            const float z = static_cast<float>(i);
+            for (uint32_t j = 0; j < resolution; j++)
+            {
+                const float x = static_cast<float>(j);
+                pVertices[size_t(i) * resolution + j] = {{x, 0, z}, normal, {x * texCoordScale, z * texCoordScale}};
+            }
+        }
+
+        writeGridIndices(resolution, resolution, pIndices);
+    }
+
+    void SurfaceMeshes::writeGridIndices(const uint32_t columns, const uint32_t rows, uint32_t* pIndices)
+    {
+        if (columns < 2 || rows < 2)
+            return;
+
+        for (uint32_t bandBegin = 0; bandBegin < columns - 1; bandBegin += kGridBandWidth)
+        {
+            const uint32_t bandEnd = std::min(bandBegin + kGridBandWidth, columns - 1);
+            for (uint32_t row = 0; row < rows - 1; row++)
+            {
+                for (uint32_t column = bandBegin; column < bandEnd; column++)
+                {
+                    const uint32_t corner = row * columns + column;
+                    const uint32_t below = corner + columns;
+
+                    pIndices[0] = corner;
+                    pIndices[1] = below;
+                    pIndices[2] = below + 1;
+                    pIndices[3] = corner + 1;
+                    pIndices[4] = corner;
+                    pIndices[5] = below + 1;
+                    pIndices += 6;
+                }
+            }
+        }
+    }
+
+    void SurfaceMeshes::joinModels(const std::vector<TriangleMesh::SharedPtr>& models, std::vector<Vertex>& vertices, TriangleMesh::IndexList& indices)
+    {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for (const auto& pModel : models)
+        {
+            vertexCount += pModel->getVertices().size();
+            indexCount += pModel->getIndices().size();
+        }
+
+        vertices.resize(vertexCount);
+        indices.resize(indexCount);
+
+        Vertex* pVertex = vertices.data();
+        uint32_t* pIndex = indices.data();
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            const uint32_t vertexOffset = static_cast<uint32_t>(pVertex - vertices.data());
+
+            for (const auto& vertexData : models[i]->getVertices())
+            {
+                pVertex->position = vertexData.position;
+                pVertex->normal = vertexData.normal;
+                pVertex->texCoord = vertexData.texCoord;
+                pVertex->modelIndex = static_cast<uint32_t>(i);
+                pVertex++;
+            }
+
+            for (const uint32_t index : models[i]->getIndices())
+                *pIndex++ = index + vertexOffset;
+        }
+    }
+}
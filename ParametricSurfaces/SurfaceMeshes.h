@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SurfaceFunctions.slangh"
+
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor::Tutorial
+{
+    /*
+     * cpu side of the parametric surfaces: tessellating them and joining every model into the one vertex and index
+     * buffer the renderer draws with a single call. nothing here touches the gpu, so it can be measured headless.
+     */
+    class SurfaceMeshes
+    {
+    public:
+        // the vertex of the joined buffer, the model index selects the model's settings in the shaders
+        struct Vertex
+        {
+            float3 position;
+            float3 normal;
+            float2 texCoord;
+
+            uint32_t modelIndex;
+        };
+
+        // quads per band of a grid's index order, the order the compute shader writes too
+        static constexpr uint32_t kGridBandWidth = kSurfaceGridBandWidth;
+
+        SurfaceMeshes() = delete;
+
+        // a flat grid of resolution x resolution points on the xz plane, one unit apart, the quads share their corners.
+        // empty below 2 points per side
+        static TriangleMesh::SharedPtr createPlane(uint32_t resolution);
+
+        static size_t getPlaneVertexCount(uint32_t resolution);
+        static size_t getPlaneIndexCount(uint32_t resolution);
+        // writes the plane into arrays of getPlaneVertexCount and getPlaneIndexCount entries
+        static void tessellatePlane(uint32_t resolution, TriangleMesh::Vertex* pVertices, uint32_t* pIndices);
+
+        // the triangles of a grid of columns x rows vertices stored row by row, 6 (columns - 1) (rows - 1) indices.
+        // they go down bands of kGridBandWidth quads, so a row of a band reuses the vertices of the row before it.
+        // a quad's corners (column, row), (column, row + 1), (column + 1, row + 1) and (column + 1, row) make two triangles
+        // that face along cross(next row - vertex, next column - vertex)
+        static void writeGridIndices(uint32_t columns, uint32_t rows, uint32_t* pIndices);
+
+        // every model's vertices one after the other, the indices are offset to match
+        static void joinModels(const std::vector<TriangleMesh::SharedPtr>& models, std::vector<Vertex>& vertices, TriangleMesh::IndexList& indices);
+    };
+}
@@ -0,0 +1,168 @@
+#include "SurfaceTessellator.h"
+#include "SurfaceMeshes.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Falcor::Tutorial
+{
+    SurfaceTessellator::SurfaceTessellator(const uint32_t threadCount) : mpScheduler(std::make_unique<TileScheduler>(threadCount))
+    {
+        registerSurface("torus", torus(1.f, 0.4f));
+        registerSurface("klein bottle", kleinBottle(2.f));
+        registerSurface("superquadric", superquadric(0.3f, 0.3f));
+        registerSurface("sphere", superquadric(1.f, 1.f));
+    }
+
+    void SurfaceTessellator::registerSurface(const std::string& name, Function function)
+    {
+        for (Surface& surface : mSurfaces)
+        {
+            if (surface.name == name)
+            {
+                surface.function = std::move(function);
+                surface.desc.reset();
+                return;
+            }
+        }
+        mSurfaces.push_back({name, std::move(function), std::nullopt});
+    }
+
+    void SurfaceTessellator::registerSurface(const std::string& name, const SurfaceDesc& desc)
+    {
+        registerSurface(name, getFunction(desc));
+        for (Surface& surface : mSurfaces)
+        {
+            if (surface.name == name)
+                surface.desc = desc;
+        }
+    }
+
+    const SurfaceTessellator::Surface* SurfaceTessellator::findSurface(const std::string& name) const
+    {
+        for (const Surface& surface : mSurfaces)
+        {
+            if (surface.name == name)
+                return &surface;
+        }
+        return nullptr;
+    }
+
+    SurfaceTessellator::Statistics SurfaceTessellator::tessellate(
+        const Function& function,
+        uint32_t columns,
+        uint32_t rows,
+        Tessellation& tessellation
+    ) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        columns = std::max(columns, 2u);
+        rows = std::max(rows, 2u);
+        tessellation.columns = columns;
+        tessellation.rows = rows;
+
+        // a tessellation of the same size is overwritten without allocating
+        const size_t pointCount = tessellation.getPointCount();
+        for (std::vector<float>* pArray : {&tessellation.positionX, &tessellation.positionY, &tessellation.positionZ, &tessellation.normalX,
+                                           &tessellation.normalY, &tessellation.normalZ, &tessellation.texCoordU, &tessellation.texCoordV})
+            pArray->resize(pointCount);
+
+        mpScheduler->run(rows, [&](const uint32_t row, uint32_t)
+        {
+            const float v = getGridCoordinate(row, rows);
+            const size_t offset = size_t(row) * columns;
+
+            for (uint32_t column = 0; column < columns; column++)
+            {
+                const float u = getGridCoordinate(column, columns);
+                const Point point = function(u, v);
+
+                const size_t i = offset + column;
+                tessellation.positionX[i] = point.position.x;
+                tessellation.positionY[i] = point.position.y;
+                tessellation.positionZ[i] = point.position.z;
+                tessellation.normalX[i] = point.normal.x;
+                tessellation.normalY[i] = point.normal.y;
+                tessellation.normalZ[i] = point.normal.z;
+                tessellation.texCoordU[i] = u;
+                tessellation.texCoordV[i] = v;
+            }
+        });
+
+        Statistics statistics;
+        statistics.threadCount = mpScheduler->getThreadCount();
+        statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return statistics;
+    }
+
+    TriangleMesh::SharedPtr SurfaceTessellator::createMesh(
+        const Function& function,
+        const uint32_t columns,
+        const uint32_t rows,
+        Statistics* pStatistics
+    ) const
+    {
+        Tessellation tessellation;
+        const Statistics statistics = tessellate(function, columns, rows, tessellation);
+        if (pStatistics != nullptr)
+            *pStatistics = statistics;
+
+        TriangleMesh::VertexList vertices(tessellation.getPointCount());
+        mpScheduler->run(tessellation.rows, [&](const uint32_t row, uint32_t)
+        {
+            const size_t begin = size_t(row) * tessellation.columns;
+            for (size_t i = begin; i < begin + tessellation.columns; i++)
+            {
+                vertices[i].position = {tessellation.positionX[i], tessellation.positionY[i], tessellation.positionZ[i]};
+                vertices[i].normal = {tessellation.normalX[i], tessellation.normalY[i], tessellation.normalZ[i]};
+                vertices[i].texCoord = {tessellation.texCoordU[i], tessellation.texCoordV[i]};
+            }
+        });
+
+        TriangleMesh::IndexList indices(size_t(tessellation.columns - 1) * (tessellation.rows - 1) * 6);
+        SurfaceMeshes::writeGridIndices(tessellation.columns, tessellation.rows, indices.data());
+        return TriangleMesh::create(vertices, indices);
+    }
+
+    SurfaceDesc SurfaceTessellator::torus(const float majorRadius, const float minorRadius)
+    {
+        return {uint32_t(SurfaceType::Torus), majorRadius, minorRadius};
+    }
+
+    SurfaceDesc SurfaceTessellator::kleinBottle(const float radius)
+    {
+        return {uint32_t(SurfaceType::KleinBottle), radius, 0.f};
+    }
+
+    SurfaceDesc SurfaceTessellator::superquadric(const float latitudeExponent, const float longitudeExponent)
+    {
+        return {uint32_t(SurfaceType::Superquadric), latitudeExponent, longitudeExponent};
+    }
+
+    SurfaceTessellator::Function SurfaceTessellator::getFunction(const SurfaceDesc& desc)
+    {
+        return [desc](const float u, const float v) { return evaluateSurface(desc, u, v); };
+    }
+
+    SurfaceTessellator::Function SurfaceTessellator::fromPosition(std::function<float3(float u, float v)> position)
+    {
+        return [position = std::move(position)](const float u, const float v)
+        {
+            // one sided at the edges, the grid doesn't go past [0, 1]
+            constexpr float kStep = 1e-3f;
+            const float u0 = std::max(u - kStep, 0.f);
+            const float u1 = std::min(u + kStep, 1.f);
+            const float v0 = std::max(v - kStep, 0.f);
+            const float v1 = std::min(v + kStep, 1.f);
+
+            const float3 dPdu = (position(u1, v) - position(u0, v)) / (u1 - u0);
+            const float3 dPdv = (position(u, v1) - position(u, v0)) / (v1 - v0);
+
+            Point point;
+            point.position = position(u, v);
+            point.normal = surfaceNormalizeOr(cross(dPdv, dPdu), {0, 1, 0});
+            return point;
+        };
+    }
+}
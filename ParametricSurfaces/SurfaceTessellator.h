@@ -0,0 +1,92 @@
+#pragma once
+
+#include "SurfaceFunctions.slangh"
+#include "TileScheduler.h"
+
+#include "Scene/TriangleMesh.h"
+#include "Utils/Math/Vector.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace Falcor::Tutorial
+{
+    /*
+     * tessellates any surface given as a function of (u, v) in [0, 1]^2 into a grid of columns x rows points,
+     * u along the columns and v along the rows. the functions return the position and the normal at a point,
+     * the built in ones are the formulas of SurfaceFunctions.slangh, which the compute shader evaluates too,
+     * with normals from their partial derivatives. fromPosition approximates the normal for any other function.
+     * the rows are independent, so they are evaluated in parallel on a thread pool, into one array per component
+     * (structure of arrays), every thread writes whole rows of every array and nothing is shared between them.
+     * a normal faces along cross(dP/dv, dP/du), which is the front of the triangles of SurfaceMeshes::writeGridIndices.
+     */
+    class SurfaceTessellator
+    {
+    public:
+        using Point = SurfacePoint;
+        using Function = std::function<Point(float u, float v)>;
+
+        struct Surface
+        {
+            std::string name;
+            Function function;
+            // set for the built in surfaces, which GpuSurfaceTessellator can tessellate too
+            std::optional<SurfaceDesc> desc;
+        };
+
+        // the grid, point (column, row) is at index row * columns + column of every array
+        struct Tessellation
+        {
+            uint32_t columns = 0;
+            uint32_t rows = 0;
+
+            std::vector<float> positionX;
+            std::vector<float> positionY;
+            std::vector<float> positionZ;
+            std::vector<float> normalX;
+            std::vector<float> normalY;
+            std::vector<float> normalZ;
+            std::vector<float> texCoordU;
+            std::vector<float> texCoordV;
+
+            size_t getPointCount() const { return size_t(columns) * rows; }
+        };
+
+        struct Statistics
+        {
+            double seconds = 0.0;
+            uint32_t threadCount = 0;
+        };
+
+        // the torus, klein bottle, superquadric and sphere are registered from the start
+        explicit SurfaceTessellator(uint32_t threadCount = std::thread::hardware_concurrency());
+
+        // replaces a surface of the same name
+        void registerSurface(const std::string& name, Function function);
+        void registerSurface(const std::string& name, const SurfaceDesc& desc);
+        const std::vector<Surface>& getSurfaces() const { return mSurfaces; }
+        // null if there is no surface of that name
+        const Surface* findSurface(const std::string& name) const;
+
+        // columns and rows are at least 2, a single point doesn't make a triangle
+        Statistics tessellate(const Function& function, uint32_t columns, uint32_t rows, Tessellation& tessellation) const;
+        // the tessellation interleaved into vertices, with the indices of SurfaceMeshes::writeGridIndices
+        TriangleMesh::SharedPtr createMesh(const Function& function, uint32_t columns, uint32_t rows, Statistics* pStatistics = nullptr) const;
+
+        // ring of radius majorRadius around the y axis, with a tube of radius minorRadius
+        static SurfaceDesc torus(float majorRadius, float minorRadius);
+        // the figure 8 immersion, a circle of figure 8 tubes around the y axis that turns half around on its way
+        static SurfaceDesc kleinBottle(float radius);
+        // superellipsoid of radius 1, exponent 1 is a sphere, towards 0 it becomes a cube, 2 an octahedron.
+        // latitudeExponent shapes it along the y axis, longitudeExponent around it
+        static SurfaceDesc superquadric(float latitudeExponent, float longitudeExponent);
+        static Function getFunction(const SurfaceDesc& desc);
+        // normals from central differences, for functions without known derivatives
+        static Function fromPosition(std::function<float3(float u, float v)> position);
+
+    private:
+        std::vector<Surface> mSurfaces;
+        std::unique_ptr<TileScheduler> mpScheduler;
+    };
+}